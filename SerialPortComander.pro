@@ -1,49 +1,20 @@
 #-------------------------------------------------
 #
-# Project created by QtCreator 2019-04-12T11:39:56
+# core      port I/O, capture, replay, formatting (static library)
+# app       Qt Widgets front end
+# headless  command line front end for scripts and CI
+# benchmarks
 #
 #-------------------------------------------------
 
-QT       += core gui serialport
+TEMPLATE = subdirs
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+SUBDIRS += \
+    core \
+    app \
+    headless \
+    benchmarks
 
-TARGET = SerialPortComander
-TEMPLATE = app
-
-# The following define makes your compiler emit warnings if you use
-# any feature of Qt which has been marked as deprecated (the exact warnings
-# depend on your compiler). Please consult the documentation of the
-# deprecated API in order to know how to port your code away from it.
-DEFINES += QT_DEPRECATED_WARNINGS
-
-# You can also make your code fail to compile if you use deprecated APIs.
-# In order to do so, uncomment the following line.
-# You can also select to disable deprecated APIs only up to a certain version of Qt.
-#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
-
-CONFIG += c++17
-
-SOURCES += \
-        main.cpp \
-        mainwindow.cpp \
-    comportconsole.cpp \
-    commandlistitem.cpp
-
-HEADERS += \
-        mainwindow.hpp \
-    comportconsole.hpp \
-    commandlistitem.hpp
-
-FORMS += \
-        mainwindow.ui \
-    comportconsole.ui \
-    commandlistitem.ui
-
-# Default rules for deployment.
-qnx: target.path = /tmp/$${TARGET}/bin
-else: unix:!android: target.path = /opt/$${TARGET}/bin
-!isEmpty(target.path): INSTALLS += target
-
-RESOURCES += \
-    res/res.qrc
+app.depends = core
+headless.depends = core
+benchmarks.depends = core
@@ -0,0 +1,102 @@
+#include "commanddelegate.hpp"
+
+#include <QApplication>
+#include <QMouseEvent>
+#include <QPainter>
+
+#include <algorithm>
+
+#include "commandmodel.hpp"
+
+namespace
+{
+    const int row_height = 44;
+    const int margin = 6;
+    const int button_size = 32;
+    const int icon_size = 24;
+}
+
+CommandDelegate::CommandDelegate(QObject *parent) :
+    QStyledItemDelegate(parent),
+    _send_icon(":/icons/icon/send.png"), _delete_icon(":/icons/icon/delete.png")
+{
+
+}
+
+void CommandDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    painter->save();
+    if(option.state & QStyle::State_Selected)
+    {
+        painter->fillRect(option.rect, option.palette.highlight());
+    }
+
+    const QRect buttons[] = {delete_rect(option.rect), send_rect(option.rect)};
+    const QIcon* icons[] = {&_delete_icon, &_send_icon};
+    for(int i = 0; i < 2; ++i)
+    {
+        QStyleOptionButton button;
+        button.rect = buttons[i];
+        button.state = QStyle::State_Enabled | QStyle::State_Raised;
+        button.icon = *icons[i];
+        button.iconSize = QSize(icon_size, icon_size);
+        const QWidget* widget = option.widget;
+        QStyle* style = widget ? widget->style() : QApplication::style();
+        style->drawControl(QStyle::CE_PushButton, &button, painter, widget);
+    }
+
+    const QRect label = label_rect(option.rect);
+    painter->fillRect(label, QColor(0, 128, 128, 64));
+    painter->setPen(option.palette.color(option.state & QStyle::State_Selected ? QPalette::HighlightedText : QPalette::Text));
+    const QString text = option.fontMetrics.elidedText(index.data(Qt::DisplayRole).toString(), Qt::ElideRight, label.width());
+    painter->drawText(label, Qt::AlignCenter, text);
+    painter->restore();
+}
+
+QSize CommandDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex&) const
+{
+    return QSize(option.rect.width(), row_height);
+}
+
+bool CommandDelegate::editorEvent(QEvent* event, QAbstractItemModel*, const QStyleOptionViewItem& option, const QModelIndex& index)
+{
+    if(event->type() != QEvent::MouseButtonRelease)
+    {
+        return false;
+    }
+    const QMouseEvent* mouse = static_cast<QMouseEvent*>(event);
+    if(mouse->button() != Qt::LeftButton)
+    {
+        return false;
+    }
+
+    const std::uint64_t id = index.data(CommandModel::ID_ROLE).toULongLong();
+    if(send_rect(option.rect).contains(mouse->pos()))
+    {
+        emit send_command(id);
+        return true;
+    }
+    if(delete_rect(option.rect).contains(mouse->pos()))
+    {
+        emit delete_command(id);
+        return true;
+    }
+    return false;
+}
+
+QRect CommandDelegate::delete_rect(const QRect& item) const
+{
+    return QRect(item.left() + margin, item.top() + (item.height() - button_size) / 2, button_size, button_size);
+}
+
+QRect CommandDelegate::send_rect(const QRect& item) const
+{
+    return QRect(item.right() - margin - button_size + 1, item.top() + (item.height() - button_size) / 2, button_size, button_size);
+}
+
+QRect CommandDelegate::label_rect(const QRect& item) const
+{
+    const int left = item.left() + 2 * margin + button_size;
+    const int right = item.right() - 2 * margin - button_size;
+    return QRect(left, item.top() + margin, std::max(0, right - left + 1), item.height() - 2 * margin);
+}
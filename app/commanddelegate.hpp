@@ -0,0 +1,45 @@
+#ifndef COMMANDDELEGATE_HPP
+#define COMMANDDELEGATE_HPP
+
+/*
+Paints a saved command as delete button, command and send button, the way
+the old per-row widgets looked, without creating any widget per row. Clicks
+on the buttons are reported with the command id.
+*/
+
+#include <cstdint>
+
+#include <QIcon>
+#include <QStyledItemDelegate>
+
+class CommandDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+signals:
+
+    void send_command(std::uint64_t id);
+    void delete_command(std::uint64_t id);
+
+public:
+
+    explicit CommandDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+
+protected:
+
+    bool editorEvent(QEvent* event, QAbstractItemModel* model, const QStyleOptionViewItem& option, const QModelIndex& index) override;
+
+private:
+
+    QRect delete_rect(const QRect& item) const;
+    QRect send_rect(const QRect& item) const;
+    QRect label_rect(const QRect& item) const;
+
+    QIcon _send_icon;
+    QIcon _delete_icon;
+};
+
+#endif
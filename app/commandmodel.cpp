@@ -0,0 +1,131 @@
+#include "commandmodel.hpp"
+
+#include <algorithm>
+
+#include "messageformat.hpp"
+
+CommandModel::CommandModel(QObject *parent) :
+    QAbstractListModel(parent), _entries(), _next_id(1)
+{
+
+}
+
+int CommandModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(_entries.size());
+}
+
+QVariant CommandModel::data(const QModelIndex& index, int role) const
+{
+    if(!index.isValid() || index.row() < 0 || index.row() >= static_cast<int>(_entries.size()))
+    {
+        return QVariant();
+    }
+    const Entry& entry = _entries[static_cast<std::size_t>(index.row())];
+    switch(role)
+    {
+    case Qt::DisplayRole:
+    case Qt::ToolTipRole:
+        // control characters shown the way they are typed
+        return MessageFormat::escape(entry.command);
+    case ID_ROLE:
+        return static_cast<qulonglong>(entry.id);
+    default:
+        return QVariant();
+    }
+}
+
+std::uint64_t CommandModel::add(const QString& command)
+{
+    const int row = static_cast<int>(_entries.size());
+    beginInsertRows(QModelIndex(), row, row);
+    _entries.push_back(Entry{_next_id++, command});
+    endInsertRows();
+    return _entries.back().id;
+}
+
+void CommandModel::set_commands(const QStringList& commands)
+{
+    beginResetModel();
+    _entries.clear();
+    _entries.reserve(static_cast<std::size_t>(commands.size()));
+    for(const QString& command : commands)
+    {
+        _entries.push_back(Entry{_next_id++, command});
+    }
+    endResetModel();
+}
+
+void CommandModel::append(const QStringList& commands)
+{
+    if(commands.isEmpty())
+    {
+        return;
+    }
+    const int row = static_cast<int>(_entries.size());
+    beginInsertRows(QModelIndex(), row, row + commands.size() - 1);
+    for(const QString& command : commands)
+    {
+        _entries.push_back(Entry{_next_id++, command});
+    }
+    endInsertRows();
+}
+
+bool CommandModel::remove(std::uint64_t id)
+{
+    const int index = row(id);
+    if(index < 0)
+    {
+        return false;
+    }
+    beginRemoveRows(QModelIndex(), index, index);
+    _entries.erase(_entries.begin() + index);
+    endRemoveRows();
+    return true;
+}
+
+void CommandModel::clear()
+{
+    beginResetModel();
+    _entries.clear();
+    endResetModel();
+}
+
+int CommandModel::row(std::uint64_t id) const
+{
+    const auto it = std::lower_bound(_entries.begin(), _entries.end(), id, [](const Entry& entry, std::uint64_t value)
+    {
+        return entry.id < value;
+    });
+    if(it == _entries.end() || it->id != id)
+    {
+        return -1;
+    }
+    return static_cast<int>(std::distance(_entries.begin(), it));
+}
+
+std::uint64_t CommandModel::find(const QString& command) const
+{
+    const auto it = std::find_if(_entries.begin(), _entries.end(), [&command](const Entry& entry)
+    {
+        return entry.command == command;
+    });
+    return it == _entries.end() ? 0 : it->id;
+}
+
+QString CommandModel::command(std::uint64_t id) const
+{
+    const int index = row(id);
+    return index < 0 ? QString() : _entries[static_cast<std::size_t>(index)].command;
+}
+
+QStringList CommandModel::commands() const
+{
+    QStringList result;
+    result.reserve(static_cast<int>(_entries.size()));
+    for(const Entry& entry : _entries)
+    {
+        result.append(entry.command);
+    }
+    return result;
+}
@@ -0,0 +1,60 @@
+#ifndef COMMANDMODEL_HPP
+#define COMMANDMODEL_HPP
+
+/*
+Saved commands as a flat list model. Every command gets an id that stays
+with it for the whole session, so actions refer to one entry even when the
+same text is saved twice. Ids only grow and entries are never reordered,
+which keeps the list sorted by id and lookups a binary search.
+*/
+
+#include <cstdint>
+#include <vector>
+
+#include <QAbstractListModel>
+#include <QStringList>
+
+class CommandModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+
+    enum ROLE
+    {
+        ID_ROLE = Qt::UserRole
+    };
+
+    explicit CommandModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    std::uint64_t add(const QString& command);
+    // replaces everything in one reset, used for loading
+    void set_commands(const QStringList& commands);
+    // one insert for all of them, used while a library streams in
+    void append(const QStringList& commands);
+    bool remove(std::uint64_t id);
+    void clear();
+
+    // -1 when there is no such id
+    int row(std::uint64_t id) const;
+    // id of the first entry holding command, 0 when there is none
+    std::uint64_t find(const QString& command) const;
+    QString command(std::uint64_t id) const;
+    QStringList commands() const;
+
+private:
+
+    struct Entry
+    {
+        std::uint64_t id;
+        QString command;
+    };
+
+    std::vector<Entry> _entries;
+    std::uint64_t _next_id;
+};
+
+#endif
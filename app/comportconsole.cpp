@@ -0,0 +1,1451 @@
+#include "comportconsole.hpp"
+#include "ui_comportconsole.h"
+
+#include <QIntValidator>
+#include <QCompleter>
+#include <QStringListModel>
+#include <QKeyEvent>
+#include <QSettings>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QAbstractItemView>
+#include <QSignalBlocker>
+#include <QFile>
+#include <QTextStream>
+#include <QMessageBox>
+#include <QShortcut>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+
+namespace
+{
+    const char framing_hint[] = "Delimiter, e.g. \\r\\n, or length field as: offset size be|le adjustment";
+
+    // sent messages wait for their TX stamp, checked once a frame
+    const int written_interval = 16;
+    const std::int64_t written_timeout = 1000000000;
+}
+
+#include "monotonicclock.hpp"
+
+ComPortConsole::ComPortConsole(QWidget *parent) :
+    QWidget(parent), _port(nullptr), _render(), _history(nullptr), _history_idx(-1),
+    _completions(nullptr), _completer(nullptr), _reverse_search(false), _reverse_query(), _reverse_original(), _reverse_index(-1),
+    _format(), _frames(), _framer(), _stats(), _flush_stats(), _stats_timer(),
+    _scheduler(), _scheduler_timer(),
+    _search(), _search_valid(false), _search_has_match(false), _search_match{0, 0},
+    _search_counted(false), _search_counted_begin(0), _search_counted_end(0), _search_count(0),
+    _latency(), _latency_timer(), _written(), _written_timer(),
+    _triggers(), _trigger_matches(), _trigger_send_pending(), _trigger_generation(0), _trigger_timer(),
+    _telemetry(), _extractor(), _plot_timer(), _decoder(),
+    ui(new Ui::ComPortConsole)
+{
+    ui->setupUi(this);
+
+    _render.set_view(ui->message_history);
+    connect(&_render, &RenderPipeline::flushed, this, &ComPortConsole::render_flushed);
+
+    QSettings settings;
+    ui->scrollback_spin->setValue(settings.value("ComPortConsole/scrollback", 16).toInt());
+    ui->message_history->set_capacity(static_cast<std::size_t>(ui->scrollback_spin->value()) * 1024 * 1024);
+    ui->frame_rate_spin->setValue(settings.value("ComPortConsole/frame_rate", 60).toInt());
+    _render.set_frame_rate(ui->frame_rate_spin->value());
+    ui->capture_limit_spin->setValue(settings.value("ComPortConsole/capture_limit", 1024).toInt());
+    ui->capture_pause_button->setEnabled(false);
+    ui->tx_limit_spin->setValue(settings.value("ComPortConsole/tx_limit", 1024).toInt());
+    ui->stats_toggle->setChecked(settings.value("ComPortConsole/stats_visible", false).toBool());
+    ui->stats_panel->setVisible(ui->stats_toggle->isChecked());
+    ui->stats_toggle->setArrowType(ui->stats_toggle->isChecked() ? Qt::DownArrow : Qt::RightArrow);
+
+    connect(&_stats_timer, &QTimer::timeout, this, &ComPortConsole::update_stats);
+    _stats_timer.start(1000);
+
+    ui->scheduler_toggle->setChecked(settings.value("ComPortConsole/scheduler_visible", false).toBool());
+    ui->scheduler_panel->setVisible(ui->scheduler_toggle->isChecked());
+    ui->scheduler_toggle->setArrowType(ui->scheduler_toggle->isChecked() ? Qt::DownArrow : Qt::RightArrow);
+    ui->scheduler_sequence_edit->setPlainText(settings.value("ComPortConsole/scheduler_sequence").toString());
+    ui->scheduler_period_spin->setValue(settings.value("ComPortConsole/scheduler_period", 100.0).toDouble());
+    ui->scheduler_burst_spin->setValue(settings.value("ComPortConsole/scheduler_burst", 1).toInt());
+    ui->scheduler_repeat_spin->setValue(settings.value("ComPortConsole/scheduler_repeat", 0).toInt());
+    ui->scheduler_spin_checkbox->setChecked(settings.value("ComPortConsole/scheduler_spin", true).toBool());
+    connect(&_scheduler_timer, &QTimer::timeout, this, &ComPortConsole::update_scheduler);
+
+    ui->search_frame->hide();
+    ui->search_mode_combo->setCurrentIndex(settings.value("ComPortConsole/search_mode", 0).toInt());
+    ui->search_case_checkbox->setChecked(settings.value("ComPortConsole/search_case", false).toBool());
+    ui->search_edit->installEventFilter(this);
+    connect(new QShortcut(QKeySequence::Find, this), &QShortcut::activated, this, &ComPortConsole::show_search);
+    connect(ui->search_edit, &QLineEdit::textChanged, this, &ComPortConsole::update_search);
+    connect(ui->search_mode_combo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &ComPortConsole::update_search);
+    connect(ui->search_case_checkbox, &QCheckBox::toggled, this, &ComPortConsole::update_search);
+
+    ui->timestamps_combo->setCurrentIndex(settings.value("ComPortConsole/timestamps", 0).toInt());
+    ui->message_history->set_timestamps(static_cast<ConsoleView::TIMESTAMPS>(ui->timestamps_combo->currentIndex()));
+
+    ui->encoding_combo->setCurrentIndex(settings.value("ComPortConsole/encoding", static_cast<int>(TextDecoder::ENCODING::UTF8)).toInt());
+    ui->message_history->set_encoding(static_cast<TextDecoder::ENCODING>(ui->encoding_combo->currentIndex()));
+
+    ui->latency_toggle->setChecked(settings.value("ComPortConsole/latency_visible", false).toBool());
+    ui->latency_panel->setVisible(ui->latency_toggle->isChecked());
+    ui->latency_toggle->setArrowType(ui->latency_toggle->isChecked() ? Qt::DownArrow : Qt::RightArrow);
+    ui->latency_pattern_edit->setText(settings.value("ComPortConsole/latency_pattern").toString());
+    ui->latency_timeout_spin->setValue(settings.value("ComPortConsole/latency_timeout", 1000).toInt());
+    _latency.set_pattern(ui->latency_pattern_edit->text());
+    _latency.set_timeout(static_cast<std::int64_t>(ui->latency_timeout_spin->value()) * 1000000);
+    connect(&_latency_timer, &QTimer::timeout, this, &ComPortConsole::update_latency);
+    _written_timer.setSingleShot(true);
+    connect(&_written_timer, &QTimer::timeout, this, &ComPortConsole::show_written);
+
+    ui->triggers_toggle->setChecked(settings.value("ComPortConsole/triggers_visible", false).toBool());
+    ui->triggers_panel->setVisible(ui->triggers_toggle->isChecked());
+    ui->triggers_toggle->setArrowType(ui->triggers_toggle->isChecked() ? Qt::DownArrow : Qt::RightArrow);
+    ui->triggers_edit->setPlainText(settings.value("ComPortConsole/triggers").toString());
+    apply_triggers(ui->triggers_edit->toPlainText());
+    ui->message_history->set_highlighter(&_triggers);
+    connect(&_trigger_timer, &QTimer::timeout, this, &ComPortConsole::update_triggers);
+
+    ui->plot_toggle->setChecked(settings.value("ComPortConsole/plot_visible", false).toBool());
+    ui->plot_panel->setVisible(ui->plot_toggle->isChecked());
+    ui->plot_toggle->setArrowType(ui->plot_toggle->isChecked() ? Qt::DownArrow : Qt::RightArrow);
+    ui->plot_fields_edit->setText(settings.value("ComPortConsole/plot_fields").toString());
+    ui->plot_delimiters_edit->setText(settings.value("ComPortConsole/plot_delimiters",
+                                                     MessageFormat::escape(QString::fromLatin1(FieldExtractor::Settings().delimiters))).toString());
+    ui->plot_prefix_edit->setText(settings.value("ComPortConsole/plot_prefix").toString());
+    ui->plot_window_spin->setValue(settings.value("ComPortConsole/plot_window", 0).toInt());
+    ui->plot_view->set_buffer(&_telemetry);
+    ui->plot_view->set_window(static_cast<std::uint64_t>(ui->plot_window_spin->value()));
+    ui->plot_view->hide();
+    connect(ui->plot_fields_edit, &QLineEdit::editingFinished, this, &ComPortConsole::update_plot_settings);
+    connect(ui->plot_delimiters_edit, &QLineEdit::editingFinished, this, &ComPortConsole::update_plot_settings);
+    connect(ui->plot_prefix_edit, &QLineEdit::editingFinished, this, &ComPortConsole::update_plot_settings);
+    connect(&_plot_timer, &QTimer::timeout, this, &ComPortConsole::update_plot);
+    update_plot_settings();
+
+    ui->decoder_toggle->setChecked(settings.value("ComPortConsole/decoder_visible", false).toBool());
+    ui->decoder_panel->setVisible(ui->decoder_toggle->isChecked());
+    ui->decoder_toggle->setArrowType(ui->decoder_toggle->isChecked() ? Qt::DownArrow : Qt::RightArrow);
+    const QString schema = settings.value("ComPortConsole/decoder_schema").toString();
+    if(!schema.isEmpty())
+    {
+        load_schema(schema);
+    }
+    ui->decoder_checkbox->setChecked(settings.value("ComPortConsole/decoder_enabled", false).toBool());
+
+    ui->checksum_combo->addItems(Checksum::names());
+    connect(ui->checksum_combo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &ComPortConsole::update_format);
+    connect(ui->add_dollar_checkbox, &QCheckBox::toggled, this, &ComPortConsole::update_format);
+    connect(ui->line_ending_none, &QRadioButton::toggled, this, &ComPortConsole::update_format);
+    connect(ui->line_ending_n, &QRadioButton::toggled, this, &ComPortConsole::update_format);
+    connect(ui->line_ending_rn, &QRadioButton::toggled, this, &ComPortConsole::update_format);
+    update_format();
+
+    ui->frame_checksum_combo->addItems(Checksum::names());
+    Framer::Settings framing;
+    if(Framer::Settings::from_string(settings.value("ComPortConsole/framing", "none").toString(), framing))
+    {
+        ui->framing_combo->setCurrentIndex(static_cast<int>(framing.mode));
+        const QStringList parts = framing.to_string().split(' ');
+        if(framing.mode == Framer::MODE::DELIMITER)
+        {
+            ui->framing_edit->setText(parts.value(1));
+        }
+        else if(framing.mode == Framer::MODE::LENGTH)
+        {
+            ui->framing_edit->setText(parts.mid(1, 4).join(' '));
+        }
+        ui->frame_checksum_combo->setCurrentIndex(static_cast<int>(framing.checksum));
+        _framer.set_settings(framing);
+    }
+    connect(ui->framing_combo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &ComPortConsole::update_framing);
+    connect(ui->frame_checksum_combo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &ComPortConsole::update_framing);
+    connect(ui->framing_edit, &QLineEdit::editingFinished, this, &ComPortConsole::update_framing);
+    update_framing();
+
+    ui->message_edit->installEventFilter(this);
+    ui->history_search_label->hide();
+    // candidates come from the history's prefix index, the completer only shows them
+    _completer = new QCompleter(this);
+    _completions = new QStringListModel(_completer);
+    _completer->setModel(_completions);
+    _completer->setWidget(ui->message_edit);
+    _completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    _completer->setModelSorting(QCompleter::UnsortedModel);
+    _completer->setMaxVisibleItems(12);
+    connect(_completer, QOverload<const QString&>::of(&QCompleter::activated), ui->message_edit, &QLineEdit::setText);
+    connect(ui->message_edit, &QLineEdit::textEdited, this, &ComPortConsole::update_completion);
+    ui->baud_rate_combo->setValidator(new QIntValidator(0, 999999, this));
+
+    QStringList standard_baud;
+    standard_baud.append("110");
+    standard_baud.append("300");
+    standard_baud.append("600");
+    standard_baud.append("1200");
+    standard_baud.append("2400");
+    standard_baud.append("4800");
+    standard_baud.append("9600");
+    standard_baud.append("14400");
+    standard_baud.append("19200");
+    standard_baud.append("38400");
+    standard_baud.append("57600");
+    standard_baud.append("115200");
+    standard_baud.append("128000");
+    standard_baud.append("256000");
+    ui->baud_rate_combo->addItems(standard_baud);
+}
+
+ComPortConsole::~ComPortConsole()
+{
+    _scheduler.reset();
+    delete ui;
+}
+
+void ComPortConsole::set_port(PortWorker* port)
+{
+    _port = port;
+
+    ui->baud_rate_combo->setCurrentText(QString::number(baud_rate()));
+    ui->rts_button->setChecked(rts());
+    ui->dtr_button->setChecked(dtr());
+
+    if(!_port->set_flow_control(QSerialPort::NoFlowControl))
+    {
+        //qDebug() << "flow not set!";
+    }
+
+    QObject::connect(_port, &PortWorker::received, this, &ComPortConsole::new_message);
+
+    _port->set_tx_high_water(static_cast<std::size_t>(ui->tx_limit_spin->value()) * 1024);
+    _scheduler = std::make_unique<CommandScheduler>(_port);
+}
+
+void ComPortConsole::set_history(CommandHistory* history)
+{
+    _history = history;
+    _history_idx = -1;
+}
+
+void ComPortConsole::set_baud_rate(const int& val)
+{
+    if(_port)
+    {
+        _port->set_baud_rate(val);
+    }
+}
+int ComPortConsole::baud_rate() const
+{
+    if(_port)
+    {
+        return _port->baud_rate();
+    }
+    return 0;
+}
+
+void ComPortConsole::set_rts(const bool& b)
+{
+    if(_port)
+    {
+        _port->set_rts(b);
+    }
+}
+bool ComPortConsole::rts() const
+{
+    if(_port)
+    {
+        return _port->rts();
+    }
+    return false;
+}
+
+void ComPortConsole::set_dtr(const bool& b)
+{
+    if(_port)
+    {
+        _port->set_dtr(b);
+    }
+}
+bool ComPortConsole::dtr() const
+{
+    if(_port)
+    {
+        return _port->dtr();
+    }
+    return false;
+}
+
+void ComPortConsole::new_message()
+{
+    // stamps of everything written before the response are in the queue by now
+    drain_tx_stamps();
+    const bool latency = ui->latency_checkbox->isChecked();
+    const bool plot = ui->plot_checkbox->isChecked();
+
+    PortWorker::Chunk chunk;
+    Framer::Frame frame;
+    while(_port->pop(chunk))
+    {
+        if(latency)
+        {
+            _latency.received(chunk.data, chunk.timestamp);
+        }
+        if(!_triggers.empty())
+        {
+            _trigger_matches.clear();
+            _triggers.scan(chunk.data.constData(), static_cast<std::size_t>(chunk.data.size()), _trigger_matches);
+            for(const TriggerEngine::Match& match : _trigger_matches)
+            {
+                fire_trigger(match.rule);
+            }
+        }
+        if(plot && _extractor.push(chunk.data.constData(), static_cast<std::size_t>(chunk.data.size()), _telemetry) > 0)
+        {
+            ui->plot_view->data_changed();
+        }
+        if(!_framer.enabled())
+        {
+            _render.push(chunk.data, SENDER::DEVICE, chunk.timestamp);
+            continue;
+        }
+
+        _framer.push(chunk.data.constData(), static_cast<std::size_t>(chunk.data.size()));
+        while(_framer.next(frame))
+        {
+            const std::uint8_t flags = frame.status == Framer::STATUS::BAD_CHECKSUM || frame.status == Framer::STATUS::MALFORMED ?
+                        ScrollbackBuffer::BAD_FRAME : 0;
+            _render.push_frame(frame.data, frame.size, SENDER::DEVICE, chunk.timestamp, flags);
+        }
+    }
+}
+
+bool ComPortConsole::send_message(QString message)
+{
+    _history_idx = -1;
+    stop_reverse_search();
+
+    // only what reached the TX queue is recorded
+    if(!write_message(message))
+    {
+        return false;
+    }
+    if(_history)
+    {
+        _history->add(message);
+    }
+    return true;
+}
+
+bool ComPortConsole::write_message(const QString& message)
+{
+    auto frame = _frames.constFind(message);
+    if(frame == _frames.constEnd())
+    {
+        if(_frames.size() >= 4096)
+        {
+            _frames.clear();
+        }
+        frame = _frames.insert(message, _format.frame(message));
+    }
+    const QByteArray data = frame.value();
+    std::uint64_t end = 0;
+    if(!_port->write(data, &end))
+    {
+        ui->message_edit->setToolTip(QString("TX queue is above %1 KB, message not sent").arg(_port->tx_high_water() / 1024));
+        return false;
+    }
+    ui->message_edit->setToolTip(QString());
+    if(ui->latency_checkbox->isChecked())
+    {
+        _latency.sent(message, end, monotonic_ns());
+    }
+    _written.push_back(Written{end, data, monotonic_ns()});
+    if(!_written_timer.isActive())
+    {
+        _written_timer.start(written_interval);
+    }
+    return true;
+}
+
+void ComPortConsole::on_send_button_clicked()
+{
+    // a message the TX queue refused stays in the edit
+    if(ui->message_edit->text().isEmpty() || send_message(ui->message_edit->text()))
+    {
+        ui->message_edit->clear();
+    }
+}
+
+void ComPortConsole::on_message_edit_returnPressed()
+{
+    if(ui->message_edit->text().isEmpty() || send_message(ui->message_edit->text()))
+    {
+        ui->message_edit->clear();
+    }
+}
+
+bool ComPortConsole::eventFilter(QObject *obj, QEvent *event)
+{
+    if (obj == ui->message_edit)
+    {
+        if (event->type() == QEvent::KeyPress)
+        {
+            QKeyEvent* keyEvent = static_cast<QKeyEvent*>(event);
+            if(keyEvent->key() == Qt::Key_R && keyEvent->modifiers() == Qt::ControlModifier)
+            {
+                if(!_history)
+                {
+                    return true;
+                }
+                if(!_reverse_search)
+                {
+                    _reverse_search = true;
+                    _reverse_query.clear();
+                    _reverse_original = ui->message_edit->text();
+                    _reverse_index = -1;
+                    _completer->popup()->hide();
+                    reverse_search(0);
+                }
+                else
+                {
+                    reverse_search(_reverse_index + 1);
+                }
+                return true;
+            }
+            if(_reverse_search)
+            {
+                if(keyEvent->key() == Qt::Key_Escape)
+                {
+                    ui->message_edit->setText(_reverse_original);
+                    stop_reverse_search();
+                    return true;
+                }
+                if(keyEvent->key() == Qt::Key_Backspace)
+                {
+                    _reverse_query.chop(1);
+                    reverse_search(0);
+                    return true;
+                }
+                const QString text = keyEvent->text();
+                if(!text.isEmpty() && text.at(0).isPrint() && !(keyEvent->modifiers() & (Qt::ControlModifier | Qt::AltModifier)))
+                {
+                    // the current match stays while it still contains the longer query
+                    _reverse_query.append(text);
+                    reverse_search(std::max(_reverse_index, 0));
+                    return true;
+                }
+                // anything else takes the match and acts on it, Enter sends it
+                stop_reverse_search();
+            }
+            if (keyEvent->key() == Qt::Key_Up)
+            {
+                if(!_history || _history->empty())
+                {
+                    return true;
+                }
+                ++_history_idx;
+                if(_history_idx > _history->size() - 1)
+                {
+                    _history_idx = _history->size() - 1;
+                }
+                ui->message_edit->setText(_history->recent(_history_idx));
+                return true;
+            }
+            else if(keyEvent->key() == Qt::Key_Down)
+            {
+                if(!_history || _history->empty())
+                {
+                    return true;
+                }
+                --_history_idx;
+                if(_history_idx <= -1)
+                {
+                    _history_idx = -1;
+                    ui->message_edit->clear();
+                }
+                else
+                {
+                    ui->message_edit->setText(_history->recent(_history_idx));
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+    if(obj == ui->search_edit && event->type() == QEvent::KeyPress)
+    {
+        QKeyEvent* keyEvent = static_cast<QKeyEvent*>(event);
+        if(keyEvent->key() == Qt::Key_Return || keyEvent->key() == Qt::Key_Enter)
+        {
+            search(!(keyEvent->modifiers() & Qt::ShiftModifier));
+            return true;
+        }
+        if(keyEvent->key() == Qt::Key_Escape)
+        {
+            ui->search_frame->hide();
+            ui->message_history->setFocus();
+            return true;
+        }
+        return false;
+    }
+    return QWidget::eventFilter(obj, event);
+}
+
+void ComPortConsole::on_save_message_button_clicked()
+{
+    if(!ui->message_edit->text().isEmpty())
+    {
+        emit save_message(ui->message_edit->text());
+    }
+    ui->message_edit->clear();
+}
+
+void ComPortConsole::on_dtr_button_toggled(bool checked)
+{
+    set_dtr(checked);
+}
+
+void ComPortConsole::on_rts_button_toggled(bool checked)
+{
+    set_rts(checked);
+}
+
+void ComPortConsole::on_control_no_control_radio_toggled(bool checked)
+{
+    if(checked)
+    {
+        if(!_port->set_flow_control(QSerialPort::NoFlowControl))
+        {
+            //qDebug() << "flow not set!";
+        }
+    }
+}
+
+void ComPortConsole::on_control_hardware_radio_toggled(bool checked)
+{
+    if(checked)
+    {
+        if(!_port->set_flow_control(QSerialPort::HardwareControl))
+        {
+            //qDebug() << "flow not set!";
+        }
+    }
+}
+
+void ComPortConsole::on_control_software_radio_toggled(bool checked)
+{
+    if(checked)
+    {
+        if(!_port->set_flow_control(QSerialPort::SoftwareControl))
+        {
+            //qDebug() << "flow not set!";
+        }
+    }
+}
+
+void ComPortConsole::flow_control_changed(QSerialPort::FlowControl flow)
+{
+    switch (flow)
+    {
+    case QSerialPort::NoFlowControl:
+        ui->control_no_control_radio->setChecked(true);
+        break;
+    case QSerialPort::HardwareControl:
+        ui->control_hardware_radio->setChecked(true);
+        break;
+    case QSerialPort::SoftwareControl:
+        ui->control_software_radio->setChecked(true);
+        break;
+    default:
+        break;
+    }
+}
+
+void ComPortConsole::on_clear_button_clicked()
+{
+    _render.clear();
+    ui->message_history->clear();
+}
+
+void ComPortConsole::on_baud_rate_combo_currentTextChanged(const QString &arg1)
+{
+    set_baud_rate(arg1.toInt());
+}
+
+void ComPortConsole::on_communication_hex_mode_toggled(bool checked)
+{
+    ui->message_history->set_hex_mode(checked);
+}
+
+void ComPortConsole::on_communication_protect_alphanumeric_toggled(bool checked)
+{
+    ui->message_history->set_protect_alphanumeric(checked);
+}
+
+void ComPortConsole::on_communication_protect_extended_toggled(bool checked)
+{
+    ui->message_history->set_protect_extended(checked);
+}
+
+void ComPortConsole::on_scrollback_spin_valueChanged(int megabytes)
+{
+    ui->message_history->set_capacity(static_cast<std::size_t>(megabytes) * 1024 * 1024);
+
+    QSettings settings;
+    settings.setValue("ComPortConsole/scrollback", megabytes);
+}
+
+void ComPortConsole::on_frame_rate_spin_valueChanged(int fps)
+{
+    _render.set_frame_rate(fps);
+
+    QSettings settings;
+    settings.setValue("ComPortConsole/frame_rate", fps);
+}
+
+void ComPortConsole::on_tx_limit_spin_valueChanged(int kilobytes)
+{
+    if(_port)
+    {
+        _port->set_tx_high_water(static_cast<std::size_t>(kilobytes) * 1024);
+    }
+
+    QSettings settings;
+    settings.setValue("ComPortConsole/tx_limit", kilobytes);
+}
+
+void ComPortConsole::render_flushed(const RenderPipeline::FlushStats& stats)
+{
+    ++_flush_stats.flushes;
+    _flush_stats.flush_time += stats.duration;
+    _flush_stats.flush_max = std::max(_flush_stats.flush_max, stats.duration);
+
+    if(_port)
+    {
+        const PortWorker::CaptureStats capture = _port->capture_stats();
+        if(capture.active)
+        {
+            ui->capture_label->setText(QString("%1 bytes in %2 files%3").arg(capture.bytes).arg(capture.files)
+                                       .arg(capture.paused ? ", paused" : ""));
+        }
+        else if(ui->capture_checkbox->isChecked())
+        {
+            // writer gave up, e.g. disk full
+            QSignalBlocker blocker(ui->capture_checkbox);
+            ui->capture_checkbox->setChecked(false);
+            ui->capture_pause_button->setChecked(false);
+            ui->capture_pause_button->setEnabled(false);
+            ui->capture_label->setText("Capture stopped");
+        }
+    }
+}
+
+void ComPortConsole::on_capture_checkbox_toggled(bool checked)
+{
+    if(!_port)
+    {
+        return;
+    }
+    if(!checked)
+    {
+        _port->stop_capture();
+        ui->capture_pause_button->setChecked(false);
+        ui->capture_pause_button->setEnabled(false);
+        return;
+    }
+
+    QSettings settings;
+    QString path = QFileDialog::getSaveFileName(this, "Capture traffic",
+                                                settings.value("ComPortConsole/capture_directory").toString(),
+                                                "Capture (*.spcap)");
+    if(path.endsWith(".spcap"))
+    {
+        path.chop(6);
+    }
+
+    QString error;
+    if(path.isEmpty() || !_port->start_capture(path, static_cast<qint64>(ui->capture_limit_spin->value()) * 1024 * 1024, &error))
+    {
+        QSignalBlocker blocker(ui->capture_checkbox);
+        ui->capture_checkbox->setChecked(false);
+        ui->capture_label->setText(error);
+        return;
+    }
+    settings.setValue("ComPortConsole/capture_directory", QFileInfo(path).path());
+    ui->capture_label->setText(QFileInfo(path).fileName());
+    ui->capture_pause_button->setEnabled(true);
+}
+
+void ComPortConsole::on_capture_pause_button_toggled(bool checked)
+{
+    if(_port)
+    {
+        _port->set_capture_paused(checked);
+    }
+}
+
+void ComPortConsole::on_capture_limit_spin_valueChanged(int megabytes)
+{
+    QSettings settings;
+    settings.setValue("ComPortConsole/capture_limit", megabytes);
+}
+
+void ComPortConsole::on_stats_toggle_toggled(bool checked)
+{
+    ui->stats_panel->setVisible(checked);
+    ui->stats_toggle->setArrowType(checked ? Qt::DownArrow : Qt::RightArrow);
+    if(checked && _stats.size() >= 2)
+    {
+        ui->stats_label->setText(_stats.back().text(_stats[_stats.size() - 2]));
+    }
+
+    QSettings settings;
+    settings.setValue("ComPortConsole/stats_visible", checked);
+}
+
+void ComPortConsole::update_stats()
+{
+    if(!_port)
+    {
+        return;
+    }
+
+    PortStats stats = _flush_stats;
+    stats.timestamp = monotonic_ns();
+    _port->traffic_stats(stats);
+    const ConsoleView::PaintStats paint = ui->message_history->paint_stats();
+    stats.paints = paint.paints;
+    stats.paint_time = paint.time;
+    stats.paint_max = paint.max;
+    const Framer::Stats framing = _framer.stats();
+    stats.frames = framing.frames;
+    stats.bad_frames = framing.bad_checksum;
+    stats.malformed_frames = framing.malformed;
+    stats.skipped_bytes = framing.skipped_bytes;
+
+    _stats.push_back(stats);
+    if(_stats.size() > 3600)
+    {
+        _stats.pop_front();
+    }
+
+    if(ui->stats_panel->isVisible() && _stats.size() >= 2)
+    {
+        ui->stats_label->setText(stats.text(_stats[_stats.size() - 2]));
+    }
+}
+
+void ComPortConsole::on_stats_export_button_clicked()
+{
+    QSettings settings;
+    QString filter;
+    const QString path = QFileDialog::getSaveFileName(this, "Export statistics",
+                                                      settings.value("ComPortConsole/stats_directory").toString(),
+                                                      "CSV (*.csv);;JSON (*.json)", &filter);
+    if(path.isEmpty())
+    {
+        return;
+    }
+    settings.setValue("ComPortConsole/stats_directory", QFileInfo(path).path());
+
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        QMessageBox::warning(this, "Export statistics", file.errorString());
+        return;
+    }
+
+    // first snapshot only serves as base for the rates of the second
+    if(path.endsWith(".json") || (filter.startsWith("JSON") && !path.endsWith(".csv")))
+    {
+        QJsonArray snapshots;
+        for(std::size_t i = 1; i < _stats.size(); ++i)
+        {
+            snapshots.append(_stats[i].json(_stats[i - 1]));
+        }
+        QJsonObject root;
+        root["port"] = _port ? _port->port_name() : QString();
+        root["snapshots"] = snapshots;
+        file.write(QJsonDocument(root).toJson());
+    }
+    else
+    {
+        QTextStream out(&file);
+        out << PortStats::csv_header() << "\n";
+        for(std::size_t i = 1; i < _stats.size(); ++i)
+        {
+            out << _stats[i].csv(_stats[i - 1]) << "\n";
+        }
+    }
+}
+
+void ComPortConsole::update_format()
+{
+    _format.set_checksum(static_cast<Checksum::TYPE>(ui->checksum_combo->currentIndex()));
+    _format.set_dollar(ui->add_dollar_checkbox->isChecked());
+    if(ui->line_ending_n->isChecked())
+    {
+        _format.set_line_ending(MessageFormat::LINE_ENDING::N);
+    }
+    else if(ui->line_ending_rn->isChecked())
+    {
+        _format.set_line_ending(MessageFormat::LINE_ENDING::RN);
+    }
+    else
+    {
+        _format.set_line_ending(MessageFormat::LINE_ENDING::NONE);
+    }
+    _frames.clear();
+}
+
+void ComPortConsole::update_framing()
+{
+    // NMEA, SLIP and COBS need no parameters
+    const Framer::MODE mode = static_cast<Framer::MODE>(ui->framing_combo->currentIndex());
+    ui->framing_edit->setEnabled(mode == Framer::MODE::DELIMITER || mode == Framer::MODE::LENGTH);
+    ui->frame_checksum_combo->setEnabled(mode != Framer::MODE::NONE && mode != Framer::MODE::NMEA);
+    if(ui->framing_edit->text().isEmpty())
+    {
+        if(mode == Framer::MODE::DELIMITER)
+        {
+            ui->framing_edit->setText("\\r\\n");
+        }
+        else if(mode == Framer::MODE::LENGTH)
+        {
+            ui->framing_edit->setText("0 1 be 0");
+        }
+    }
+
+    QStringList parts(Framer::name(mode));
+    if(ui->framing_edit->isEnabled())
+    {
+        parts << ui->framing_edit->text().trimmed();
+    }
+    if(ui->frame_checksum_combo->isEnabled() && ui->frame_checksum_combo->currentIndex() > 0)
+    {
+        parts << ui->frame_checksum_combo->currentText();
+    }
+
+    Framer::Settings framing;
+    QString error;
+    if(!Framer::Settings::from_string(parts.join(' '), framing, &error))
+    {
+        ui->framing_edit->setToolTip(error);
+        ui->framing_edit->setStyleSheet("color: rgb(220, 50, 47);");
+        return;
+    }
+    ui->framing_edit->setToolTip(framing_hint);
+    ui->framing_edit->setStyleSheet(QString());
+
+    if(framing.to_string() != _framer.settings().to_string())
+    {
+        _framer.set_settings(framing);
+        QSettings settings;
+        settings.setValue("ComPortConsole/framing", framing.to_string());
+    }
+}
+
+void ComPortConsole::set_schedule(const QStringList& commands)
+{
+    ui->scheduler_sequence_edit->setPlainText(commands.join('\n'));
+    ui->scheduler_toggle->setChecked(true);
+}
+
+void ComPortConsole::on_scheduler_toggle_toggled(bool checked)
+{
+    ui->scheduler_panel->setVisible(checked);
+    ui->scheduler_toggle->setArrowType(checked ? Qt::DownArrow : Qt::RightArrow);
+
+    QSettings settings;
+    settings.setValue("ComPortConsole/scheduler_visible", checked);
+}
+
+void ComPortConsole::on_scheduler_start_button_toggled(bool checked)
+{
+    if(!checked)
+    {
+        _scheduler->stop();
+        update_scheduler();
+        return;
+    }
+
+    QSettings settings;
+    settings.setValue("ComPortConsole/scheduler_sequence", ui->scheduler_sequence_edit->toPlainText());
+    settings.setValue("ComPortConsole/scheduler_period", ui->scheduler_period_spin->value());
+    settings.setValue("ComPortConsole/scheduler_burst", ui->scheduler_burst_spin->value());
+    settings.setValue("ComPortConsole/scheduler_repeat", ui->scheduler_repeat_spin->value());
+    settings.setValue("ComPortConsole/scheduler_spin", ui->scheduler_spin_checkbox->isChecked());
+
+    // framed once up front, the timing thread only hands out buffers
+    CommandScheduler::Settings schedule;
+    for(const QString& line : ui->scheduler_sequence_edit->toPlainText().split('\n'))
+    {
+        if(!line.isEmpty())
+        {
+            schedule.frames.push_back(_format.frame(line));
+        }
+    }
+    schedule.period = static_cast<std::int64_t>(ui->scheduler_period_spin->value() * 1000000.0);
+    schedule.burst = ui->scheduler_burst_spin->value();
+    schedule.repetitions = static_cast<std::uint64_t>(ui->scheduler_repeat_spin->value());
+    schedule.spin = ui->scheduler_spin_checkbox->isChecked() ? 50000 : 0;
+
+    if(!_scheduler->start(schedule))
+    {
+        const QSignalBlocker blocker(ui->scheduler_start_button);
+        ui->scheduler_start_button->setChecked(false);
+        ui->scheduler_stats_label->setText("Nothing to send");
+        return;
+    }
+    ui->scheduler_start_button->setText("Stop");
+    ui->scheduler_sequence_edit->setReadOnly(true);
+    _scheduler_timer.start(250);
+}
+
+void ComPortConsole::update_scheduler()
+{
+    const CommandScheduler::Stats stats = _scheduler->stats();
+    ui->scheduler_stats_label->setText(stats.text());
+    if(!stats.running)
+    {
+        _scheduler_timer.stop();
+        const QSignalBlocker blocker(ui->scheduler_start_button);
+        ui->scheduler_start_button->setChecked(false);
+        ui->scheduler_start_button->setText("Start");
+        ui->scheduler_sequence_edit->setReadOnly(false);
+    }
+}
+
+void ComPortConsole::show_search()
+{
+    ui->search_frame->show();
+    ui->search_edit->setFocus();
+    ui->search_edit->selectAll();
+}
+
+void ComPortConsole::on_search_next_button_clicked()
+{
+    search(true);
+}
+
+void ComPortConsole::on_search_previous_button_clicked()
+{
+    search(false);
+}
+
+void ComPortConsole::update_search()
+{
+    QString error;
+    _search_valid = _search.set_pattern(static_cast<SessionSearch::MODE>(ui->search_mode_combo->currentIndex()),
+                                        ui->search_edit->text(), ui->search_case_checkbox->isChecked(), &error);
+    _search_has_match = false;
+    _search_counted = false;
+    ui->search_status_label->setText(error);
+    ui->search_edit->setStyleSheet(error.isEmpty() ? QString() : QString("color: rgb(220,50,47);"));
+
+    QSettings settings;
+    settings.setValue("ComPortConsole/search_mode", ui->search_mode_combo->currentIndex());
+    settings.setValue("ComPortConsole/search_case", ui->search_case_checkbox->isChecked());
+}
+
+void ComPortConsole::search(bool forward)
+{
+    if(!_search_valid)
+    {
+        return;
+    }
+    const std::int64_t start = monotonic_ns();
+    const ScrollbackBuffer& buffer = ui->message_history->buffer();
+
+    // continue from the current match, or from the top and bottom, and wrap around once
+    bool wrapped = false;
+    SessionSearch::Match match{0, 0};
+    bool found = false;
+    if(forward)
+    {
+        found = _search.find_next(buffer, _search_has_match ? _search_match.offset + 1 : buffer.begin_offset(), match);
+        if(!found && _search_has_match)
+        {
+            found = _search.find_next(buffer, buffer.begin_offset(), match);
+            wrapped = found;
+        }
+    }
+    else
+    {
+        found = _search.find_previous(buffer, _search_has_match ? _search_match.offset : buffer.end_offset(), match);
+        if(!found && _search_has_match)
+        {
+            found = _search.find_previous(buffer, buffer.end_offset(), match);
+            wrapped = found;
+        }
+    }
+
+    _search_has_match = found;
+    if(!found)
+    {
+        ui->search_status_label->setText(QString("No match in %1 KB").arg(buffer.size() / 1024));
+        return;
+    }
+    _search_match = match;
+    ui->message_history->reveal(match.offset, match.length);
+
+    // the same offsets hold the same bytes, so the count holds until the buffer changes
+    const std::size_t limit = 10000;
+    if(!_search_counted || _search_counted_begin != buffer.begin_offset() || _search_counted_end != buffer.end_offset())
+    {
+        _search_count = _search.count(buffer, limit);
+        _search_counted = true;
+        _search_counted_begin = buffer.begin_offset();
+        _search_counted_end = buffer.end_offset();
+    }
+    const std::size_t total = _search_count;
+    const double milliseconds = static_cast<double>(monotonic_ns() - start) / 1e6;
+    ui->search_status_label->setText(QString("%1%2 matches, at byte %3%4, %5 ms")
+                                     .arg(total).arg(total >= limit ? "+" : "")
+                                     .arg(match.offset - buffer.begin_offset())
+                                     .arg(wrapped ? ", wrapped" : "")
+                                     .arg(milliseconds, 0, 'f', 1));
+}
+
+void ComPortConsole::update_completion(const QString& text)
+{
+    _history_idx = -1;
+    const QStringList candidates = _history ? _history->complete(text, 50) : QStringList();
+    if(candidates.isEmpty() || (candidates.size() == 1 && candidates.front() == text))
+    {
+        _completer->popup()->hide();
+        return;
+    }
+    _completions->setStringList(candidates);
+    _completer->complete();
+}
+
+void ComPortConsole::reverse_search(int from)
+{
+    const int index = _history->search(_reverse_query, from);
+    if(index >= 0)
+    {
+        _reverse_index = index;
+        const QString command = _history->recent(index);
+        ui->message_edit->setText(command);
+        ui->message_edit->setSelection(command.indexOf(_reverse_query), _reverse_query.size());
+    }
+    // like a shell, a query without a match keeps showing the last one that had it
+    ui->history_search_label->setText(QString(index >= 0 || _reverse_query.isEmpty() ? "reverse search '%1':" :
+                                                                                       "failing reverse search '%1':")
+                                      .arg(_reverse_query));
+    ui->history_search_label->show();
+}
+
+void ComPortConsole::stop_reverse_search()
+{
+    _reverse_search = false;
+    _reverse_query.clear();
+    _reverse_original.clear();
+    _reverse_index = -1;
+    ui->history_search_label->hide();
+}
+
+void ComPortConsole::on_timestamps_combo_currentIndexChanged(int index)
+{
+    ui->message_history->set_timestamps(static_cast<ConsoleView::TIMESTAMPS>(index));
+
+    QSettings settings;
+    settings.setValue("ComPortConsole/timestamps", index);
+}
+
+void ComPortConsole::on_encoding_combo_currentIndexChanged(int index)
+{
+    ui->message_history->set_encoding(static_cast<TextDecoder::ENCODING>(index));
+
+    QSettings settings;
+    settings.setValue("ComPortConsole/encoding", index);
+}
+
+void ComPortConsole::on_latency_toggle_toggled(bool checked)
+{
+    ui->latency_panel->setVisible(checked);
+    ui->latency_toggle->setArrowType(checked ? Qt::DownArrow : Qt::RightArrow);
+
+    QSettings settings;
+    settings.setValue("ComPortConsole/latency_visible", checked);
+}
+
+void ComPortConsole::on_latency_checkbox_toggled(bool checked)
+{
+    if(checked)
+    {
+        // stamps from before were written with nothing waiting for them
+        drain_tx_stamps();
+        _latency_timer.start(250);
+    }
+    else
+    {
+        _latency_timer.stop();
+        _latency.cancel();
+    }
+    update_latency();
+}
+
+void ComPortConsole::on_latency_pattern_edit_editingFinished()
+{
+    QString error;
+    const bool valid = _latency.set_pattern(ui->latency_pattern_edit->text(), &error);
+    ui->latency_pattern_edit->setToolTip(error);
+    ui->latency_pattern_edit->setStyleSheet(valid ? QString() : QString("color: rgb(220,50,47);"));
+    if(valid)
+    {
+        QSettings settings;
+        settings.setValue("ComPortConsole/latency_pattern", ui->latency_pattern_edit->text());
+    }
+}
+
+void ComPortConsole::on_latency_timeout_spin_valueChanged(int milliseconds)
+{
+    _latency.set_timeout(static_cast<std::int64_t>(milliseconds) * 1000000);
+
+    QSettings settings;
+    settings.setValue("ComPortConsole/latency_timeout", milliseconds);
+}
+
+void ComPortConsole::on_latency_reset_button_clicked()
+{
+    _latency.clear();
+    update_latency();
+}
+
+void ComPortConsole::on_latency_export_button_clicked()
+{
+    QSettings settings;
+    QString filter;
+    const QString path = QFileDialog::getSaveFileName(this, "Export latency",
+                                                      settings.value("ComPortConsole/stats_directory").toString(),
+                                                      "CSV (*.csv);;JSON (*.json)", &filter);
+    if(path.isEmpty())
+    {
+        return;
+    }
+    settings.setValue("ComPortConsole/stats_directory", QFileInfo(path).path());
+
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        QMessageBox::warning(this, "Export latency", file.errorString());
+        return;
+    }
+    if(path.endsWith(".json") || (filter.startsWith("JSON") && !path.endsWith(".csv")))
+    {
+        file.write(_latency.json());
+    }
+    else
+    {
+        file.write(_latency.csv().toUtf8());
+    }
+}
+
+void ComPortConsole::update_latency()
+{
+    if(ui->latency_checkbox->isChecked())
+    {
+        drain_tx_stamps();
+        _latency.expire(monotonic_ns());
+    }
+    ui->latency_stats_label->setText(_latency.text());
+}
+
+void ComPortConsole::drain_tx_stamps()
+{
+    if(!_port)
+    {
+        return;
+    }
+    const bool latency = ui->latency_checkbox->isChecked();
+    PortWorker::TxStamp stamp;
+    while(_port->pop_tx_stamp(stamp))
+    {
+        if(latency)
+        {
+            _latency.written(stamp.end, stamp.timestamp);
+        }
+        while(!_written.empty() && _written.front().end <= stamp.end)
+        {
+            _render.push(_written.front().data, SENDER::USER, stamp.timestamp);
+            _written.pop_front();
+        }
+    }
+}
+
+void ComPortConsole::show_written()
+{
+    drain_tx_stamps();
+
+    // a stamp the full stamp queue dropped, or data that never left the
+    // queue, must not keep the message off the console
+    const std::int64_t now = monotonic_ns();
+    while(!_written.empty() && now - _written.front().queued > written_timeout)
+    {
+        _render.push(_written.front().data, SENDER::USER, _written.front().queued);
+        _written.pop_front();
+    }
+    if(!_written.empty())
+    {
+        _written_timer.start(written_interval);
+    }
+}
+
+void ComPortConsole::on_triggers_toggle_toggled(bool checked)
+{
+    ui->triggers_panel->setVisible(checked);
+    ui->triggers_toggle->setArrowType(checked ? Qt::DownArrow : Qt::RightArrow);
+
+    QSettings settings;
+    settings.setValue("ComPortConsole/triggers_visible", checked);
+}
+
+void ComPortConsole::on_triggers_apply_button_clicked()
+{
+    if(apply_triggers(ui->triggers_edit->toPlainText()))
+    {
+        QSettings settings;
+        settings.setValue("ComPortConsole/triggers", ui->triggers_edit->toPlainText());
+    }
+}
+
+void ComPortConsole::update_triggers()
+{
+    const std::vector<TriggerEngine::Rule>& rules = _triggers.rules();
+    const std::vector<std::uint64_t>& counts = _triggers.counts();
+    QStringList lines;
+    for(std::size_t i = 0; i < rules.size(); ++i)
+    {
+        if(rules[i].actions & TriggerEngine::COUNT)
+        {
+            lines << QString("%1: %2").arg(rules[i].name()).arg(counts[i]);
+        }
+    }
+    ui->triggers_status_label->setStyleSheet(QString());
+    ui->triggers_status_label->setText(lines.isEmpty() ? QString("%1 rules").arg(rules.size()) : lines.join('\n'));
+}
+
+bool ComPortConsole::apply_triggers(const QString& rules)
+{
+    std::vector<TriggerEngine::Rule> parsed;
+    QString error;
+    if(!TriggerEngine::parse(rules.split('\n'), parsed, &error))
+    {
+        ui->triggers_status_label->setStyleSheet("color: rgb(220,50,47);");
+        ui->triggers_status_label->setText(error);
+        return false;
+    }
+
+    _triggers.set_rules(parsed);
+    _trigger_send_pending.assign(parsed.size(), false);
+    ++_trigger_generation;
+    if(_triggers.empty())
+    {
+        _trigger_timer.stop();
+    }
+    else
+    {
+        _trigger_timer.start(250);
+    }
+    update_triggers();
+    ui->message_history->viewport()->update();
+    return true;
+}
+
+void ComPortConsole::fire_trigger(int rule)
+{
+    const std::size_t index = static_cast<std::size_t>(rule);
+    const TriggerEngine::Rule& trigger = _triggers.rules()[index];
+    if((trigger.actions & TriggerEngine::PAUSE_CAPTURE) && ui->capture_checkbox->isChecked())
+    {
+        ui->capture_pause_button->setChecked(true);
+    }
+    if(!(trigger.actions & TriggerEngine::SEND) || _trigger_send_pending[index])
+    {
+        return;
+    }
+    if(trigger.delay == 0)
+    {
+        write_message(trigger.command);
+        return;
+    }
+
+    // matches while the send is pending do not queue more of them
+    _trigger_send_pending[index] = true;
+    const int generation = _trigger_generation;
+    const QString command = trigger.command;
+    QTimer::singleShot(trigger.delay, Qt::PreciseTimer, this, [this, index, generation, command]()
+    {
+        if(generation != _trigger_generation)
+        {
+            return;
+        }
+        _trigger_send_pending[index] = false;
+        write_message(command);
+    });
+}
+
+void ComPortConsole::on_plot_toggle_toggled(bool checked)
+{
+    ui->plot_panel->setVisible(checked);
+    ui->plot_toggle->setArrowType(checked ? Qt::DownArrow : Qt::RightArrow);
+
+    QSettings settings;
+    settings.setValue("ComPortConsole/plot_visible", checked);
+}
+
+void ComPortConsole::on_plot_checkbox_toggled(bool checked)
+{
+    ui->plot_view->setVisible(checked);
+    // a line cut off while the plot was off would start mid-way
+    _extractor.reset();
+    if(checked)
+    {
+        _plot_timer.start(500);
+    }
+    else
+    {
+        _plot_timer.stop();
+    }
+    update_plot();
+}
+
+void ComPortConsole::on_plot_window_spin_valueChanged(int samples)
+{
+    ui->plot_view->set_window(static_cast<std::uint64_t>(samples));
+
+    QSettings settings;
+    settings.setValue("ComPortConsole/plot_window", samples);
+}
+
+void ComPortConsole::on_plot_clear_button_clicked()
+{
+    _telemetry.clear();
+    _extractor.reset();
+    ui->plot_view->update();
+    update_plot();
+}
+
+void ComPortConsole::update_plot_settings()
+{
+    FieldExtractor::Settings extraction;
+    QString error;
+    if(!FieldExtractor::Settings::parse_fields(ui->plot_fields_edit->text(), extraction.fields, &error))
+    {
+        ui->plot_stats_label->setStyleSheet("color: rgb(220,50,47);");
+        ui->plot_stats_label->setText(error);
+        return;
+    }
+    extraction.delimiters = MessageFormat::unescape(ui->plot_delimiters_edit->text()).toLatin1();
+    extraction.prefix = MessageFormat::unescape(ui->plot_prefix_edit->text()).toUtf8();
+
+    const FieldExtractor::Settings& current = _extractor.settings();
+    if(extraction.fields != current.fields || extraction.delimiters != current.delimiters || extraction.prefix != current.prefix
+            || _telemetry.channels() == 0)
+    {
+        // channels are decided again by the next line with numbers
+        _extractor.set_settings(extraction);
+        _telemetry.set_channels(0);
+
+        QStringList labels;
+        for(const int field : extraction.fields)
+        {
+            labels << QString("#%1").arg(field + 1);
+        }
+        ui->plot_view->set_labels(labels);
+    }
+
+    QSettings settings;
+    settings.setValue("ComPortConsole/plot_fields", ui->plot_fields_edit->text());
+    settings.setValue("ComPortConsole/plot_delimiters", ui->plot_delimiters_edit->text());
+    settings.setValue("ComPortConsole/plot_prefix", ui->plot_prefix_edit->text());
+    update_plot();
+}
+
+void ComPortConsole::update_plot()
+{
+    const PlotView::PaintStats paint = ui->plot_view->paint_stats();
+    const double average = paint.paints > 0 ? static_cast<double>(paint.time) / paint.paints / 1e6 : 0.0;
+    ui->plot_stats_label->setStyleSheet(QString());
+    ui->plot_stats_label->setText(QString("%1 samples in %2 channels, capacity %3\npaint %4 ms avg, %5 ms max")
+                                  .arg(_telemetry.size())
+                                  .arg(_telemetry.channels())
+                                  .arg(_telemetry.capacity())
+                                  .arg(average, 0, 'f', 2)
+                                  .arg(paint.max / 1e6, 0, 'f', 2));
+}
+
+void ComPortConsole::on_decoder_toggle_toggled(bool checked)
+{
+    ui->decoder_panel->setVisible(checked);
+    ui->decoder_toggle->setArrowType(checked ? Qt::DownArrow : Qt::RightArrow);
+
+    QSettings settings;
+    settings.setValue("ComPortConsole/decoder_visible", checked);
+}
+
+void ComPortConsole::on_decoder_checkbox_toggled(bool checked)
+{
+    ui->message_history->set_decoder(checked ? &_decoder : nullptr);
+
+    QSettings settings;
+    settings.setValue("ComPortConsole/decoder_enabled", checked);
+}
+
+void ComPortConsole::on_decoder_open_button_clicked()
+{
+    QSettings settings;
+    const QString path = QFileDialog::getOpenFileName(this, "Packet schema",
+                                                      settings.value("ComPortConsole/schema_directory").toString(),
+                                                      "Schema (*.schema *.txt);;All files (*)");
+    if(path.isEmpty())
+    {
+        return;
+    }
+    settings.setValue("ComPortConsole/schema_directory", QFileInfo(path).path());
+    load_schema(path);
+}
+
+void ComPortConsole::on_decoder_reload_button_clicked()
+{
+    load_schema(ui->decoder_path_edit->text());
+}
+
+bool ComPortConsole::load_schema(const QString& path)
+{
+    // shown even when it fails, so it can be fixed and reloaded
+    ui->decoder_path_edit->setText(path);
+
+    QFile file(path);
+    std::vector<PacketDecoder::Packet> packets;
+    QString error;
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        error = QString("%1: %2").arg(path, file.errorString());
+    }
+    else if(!PacketDecoder::parse(QString::fromUtf8(file.readAll()).split('\n'), packets, &error))
+    {
+        error = QString("%1: %2").arg(QFileInfo(path).fileName(), error);
+    }
+    if(!error.isEmpty())
+    {
+        ui->decoder_status_label->setStyleSheet("color: rgb(220,50,47);");
+        ui->decoder_status_label->setText(error);
+        return false;
+    }
+
+    _decoder.set_packets(packets);
+    ui->decoder_status_label->setStyleSheet(QString());
+    ui->decoder_status_label->setText(QString("%1 packets").arg(packets.size()));
+    if(ui->decoder_checkbox->isChecked())
+    {
+        // frames indexed with the old packets are matched again
+        ui->message_history->set_decoder(&_decoder);
+    }
+
+    QSettings settings;
+    settings.setValue("ComPortConsole/decoder_schema", path);
+    return true;
+}
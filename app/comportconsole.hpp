@@ -0,0 +1,282 @@
+#ifndef COMPORTCONSOLE_HPP
+#define COMPORTCONSOLE_HPP
+
+/*
+Widget controling single connection to serial port
+*/
+
+#include <deque>
+#include <memory>
+
+#include <QWidget>
+#include <QSerialPort>
+#include <QTimer>
+#include <QHash>
+
+class QCompleter;
+class QStringListModel;
+
+#include "sender.hpp"
+#include "renderpipeline.hpp"
+#include "portworker.hpp"
+#include "portstats.hpp"
+#include "messageformat.hpp"
+#include "framer.hpp"
+#include "commandscheduler.hpp"
+#include "sessionsearch.hpp"
+#include "commandhistory.hpp"
+#include "latencytracker.hpp"
+#include "triggerengine.hpp"
+#include "telemetrybuffer.hpp"
+#include "fieldextractor.hpp"
+#include "packetdecoder.hpp"
+
+namespace Ui {
+class ComPortConsole;
+}
+
+class ComPortConsole : public QWidget
+{
+    Q_OBJECT
+
+signals:
+
+    void save_message(const QString&);
+
+public:
+
+    explicit ComPortConsole(QWidget *parent = nullptr);
+    ~ComPortConsole() override;
+
+    void set_port(PortWorker* port);
+
+    // shared by every console, owned by the caller
+    void set_history(CommandHistory* history);
+
+    void set_baud_rate(const int& val);
+    int baud_rate() const;
+
+    void set_rts(const bool& b);
+    bool rts() const;
+
+    void set_dtr(const bool& b);
+    bool dtr() const;
+
+    // false when the port's TX queue refused it
+    bool send_message(QString message);
+
+    // replaces the scheduler sequence, one command per entry
+    void set_schedule(const QStringList& commands);
+
+private slots:
+
+    void new_message();
+
+    void on_send_button_clicked();
+
+    void on_message_edit_returnPressed();
+
+    bool eventFilter(QObject *obj, QEvent *event) override;
+
+    void on_save_message_button_clicked();
+
+    void on_dtr_button_toggled(bool checked);
+
+    void on_rts_button_toggled(bool checked);
+
+    void on_control_no_control_radio_toggled(bool checked);
+
+    void on_control_hardware_radio_toggled(bool checked);
+
+    void on_control_software_radio_toggled(bool checked);
+
+    void flow_control_changed(QSerialPort::FlowControl flow);
+
+    void on_clear_button_clicked();
+
+    void on_baud_rate_combo_currentTextChanged(const QString &arg1);
+
+    void on_communication_hex_mode_toggled(bool checked);
+
+    void on_communication_protect_alphanumeric_toggled(bool checked);
+
+    void on_communication_protect_extended_toggled(bool checked);
+
+    void on_scrollback_spin_valueChanged(int megabytes);
+
+    void on_frame_rate_spin_valueChanged(int fps);
+
+    void on_tx_limit_spin_valueChanged(int kilobytes);
+
+    void render_flushed(const RenderPipeline::FlushStats& stats);
+
+    void on_capture_checkbox_toggled(bool checked);
+
+    void on_capture_pause_button_toggled(bool checked);
+
+    void on_capture_limit_spin_valueChanged(int megabytes);
+
+    void on_stats_toggle_toggled(bool checked);
+
+    void on_stats_export_button_clicked();
+
+    void update_stats();
+
+    void update_format();
+
+    void update_framing();
+
+    void on_scheduler_toggle_toggled(bool checked);
+
+    void on_scheduler_start_button_toggled(bool checked);
+
+    void update_scheduler();
+
+    void show_search();
+
+    void on_search_next_button_clicked();
+
+    void on_search_previous_button_clicked();
+
+    void update_search();
+
+    void update_completion(const QString& text);
+
+    void on_timestamps_combo_currentIndexChanged(int index);
+
+    void on_encoding_combo_currentIndexChanged(int index);
+
+    void on_latency_toggle_toggled(bool checked);
+
+    void on_latency_checkbox_toggled(bool checked);
+
+    void on_latency_pattern_edit_editingFinished();
+
+    void on_latency_timeout_spin_valueChanged(int milliseconds);
+
+    void on_latency_reset_button_clicked();
+
+    void on_latency_export_button_clicked();
+
+    void update_latency();
+
+    void show_written();
+
+    void on_triggers_toggle_toggled(bool checked);
+
+    void on_triggers_apply_button_clicked();
+
+    void update_triggers();
+
+    void on_plot_toggle_toggled(bool checked);
+
+    void on_plot_checkbox_toggled(bool checked);
+
+    void on_plot_window_spin_valueChanged(int samples);
+
+    void on_plot_clear_button_clicked();
+
+    void update_plot_settings();
+
+    void update_plot();
+
+    void on_decoder_toggle_toggled(bool checked);
+
+    void on_decoder_checkbox_toggled(bool checked);
+
+    void on_decoder_open_button_clicked();
+
+    void on_decoder_reload_button_clicked();
+
+private:
+
+    void search(bool forward);
+
+    // Ctrl+R, newest match at or after from, searching older the more it is pressed
+    void reverse_search(int from);
+    void stop_reverse_search();
+
+    // hands TX stamps from the worker to the latency tracker and the sent
+    // messages waiting for them to the view, drained even when latency is off
+    void drain_tx_stamps();
+
+    // frames and writes a command without recording it in the history
+    bool write_message(const QString& message);
+
+    bool apply_triggers(const QString& rules);
+    void fire_trigger(int rule);
+
+    // keeps the packets loaded before when the file cannot be used
+    bool load_schema(const QString& path);
+
+    PortWorker* _port;
+    RenderPipeline _render;
+    CommandHistory* _history;
+    int _history_idx;
+    QStringListModel* _completions;
+    QCompleter* _completer;
+    bool _reverse_search;
+    QString _reverse_query;
+    QString _reverse_original;
+    int _reverse_index;
+
+    // framed commands ready to write, rebuilt when the format changes
+    MessageFormat _format;
+    QHash<QString, QByteArray> _frames;
+
+    Framer _framer;
+
+    // one snapshot per second, oldest dropped after an hour
+    std::deque<PortStats> _stats;
+    PortStats _flush_stats;
+    QTimer _stats_timer;
+
+    // created with the port, stopped before the console lets go of it
+    std::unique_ptr<CommandScheduler> _scheduler;
+    QTimer _scheduler_timer;
+
+    // bytes the view holds, current match is remembered by offset
+    SessionSearch _search;
+    bool _search_valid;
+    bool _search_has_match;
+    SessionSearch::Match _search_match;
+    // match count of the pattern over buffer bytes [begin, end)
+    bool _search_counted;
+    std::uint64_t _search_counted_begin;
+    std::uint64_t _search_counted_end;
+    std::size_t _search_count;
+
+    // fed with worker timestamps only while latency_checkbox is checked
+    LatencyTracker _latency;
+    QTimer _latency_timer;
+
+    // sent messages are shown stamped with the time they were handed to the port
+    struct Written
+    {
+        std::uint64_t end;      // position in the TX stream
+        QByteArray data;
+        std::int64_t queued;
+    };
+    std::deque<Written> _written;
+    QTimer _written_timer;
+
+    // runs over every received byte before framing, the view highlights with it too
+    TriggerEngine _triggers;
+    std::vector<TriggerEngine::Match> _trigger_matches;
+    // one delayed send per rule at a time, generation drops sends of replaced rules
+    std::vector<bool> _trigger_send_pending;
+    int _trigger_generation;
+    QTimer _trigger_timer;
+
+    // numbers from received lines, extracted only while plot_checkbox is checked
+    TelemetryBuffer _telemetry;
+    FieldExtractor _extractor;
+    QTimer _plot_timer;
+
+    // the view decodes with it while decoder_checkbox is checked
+    PacketDecoder _decoder;
+
+    Ui::ComPortConsole *ui;
+};
+
+#endif
@@ -0,0 +1,704 @@
+#include "consoleview.hpp"
+
+#include <QAction>
+#include <QApplication>
+#include <QClipboard>
+#include <QContextMenuEvent>
+#include <QDateTime>
+#include <QFontDatabase>
+#include <QFontInfo>
+#include <QKeyEvent>
+#include <QMenu>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QColor>
+#include <QScrollBar>
+#include <QStringList>
+
+#include <algorithm>
+#include <limits>
+
+#include "monotonicclock.hpp"
+
+namespace
+{
+    // text lines longer than this are wrapped
+    const std::uint32_t max_text_line = 4096;
+    const std::uint32_t hex_line = 16;
+    const int margin = 4;
+
+    const QColor bad_frame_color(220, 50, 47);
+    const QColor trigger_color(181, 137, 0, 96);
+}
+
+ConsoleView::ConsoleView(QWidget *parent) :
+    QAbstractScrollArea(parent), _buffer(), _lines(), _first_line(0),
+    _indexed(0), _indexed_sender(SENDER::NONE), _line_open(false),
+    _hex_mode(false), _hex(), _encoding(TextDecoder::ENCODING::UTF8), _triggers(nullptr), _decoder(nullptr), _packet_head(),
+    _timestamps(TIMESTAMPS::NONE), _wall_offset(QDateTime::currentMSecsSinceEpoch() * 1000000 - monotonic_ns()),
+    _start(monotonic_ns()),
+    _selection_anchor(-1), _selection_end(-1), _max_width(0), _paint_stats{0, 0, 0}
+{
+    QFont fixed = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+    fixed.setPointSize(font().pointSize());
+    setFont(fixed);
+
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setCursor(Qt::IBeamCursor);
+}
+
+void ConsoleView::append_pieces(const QByteArray& data, const std::vector<Piece>& pieces, const SENDER& sender)
+{
+    std::uint32_t begin = 0;
+    for(const Piece& piece : pieces)
+    {
+        _buffer.append(data.constData() + begin, piece.end - begin, sender, piece.timestamp, piece.flags);
+        begin = piece.end;
+    }
+    drop_trimmed();
+    index();
+    update_scrollbars();
+    viewport()->update();
+}
+
+void ConsoleView::clear()
+{
+    _buffer.clear();
+    _lines.clear();
+    _first_line = 0;
+    _indexed = _buffer.end_offset();
+    _indexed_sender = SENDER::NONE;
+    _line_open = false;
+    _selection_anchor = -1;
+    _selection_end = -1;
+    _max_width = 0;
+    _start = monotonic_ns();
+    update_scrollbars();
+    viewport()->update();
+}
+
+void ConsoleView::set_capacity(std::size_t capacity)
+{
+    _buffer.set_capacity(capacity);
+    drop_trimmed();
+    update_scrollbars();
+    viewport()->update();
+}
+
+std::size_t ConsoleView::capacity() const
+{
+    return _buffer.capacity();
+}
+
+void ConsoleView::set_hex_mode(bool hex)
+{
+    if(_hex_mode != hex)
+    {
+        _hex_mode = hex;
+        reindex();
+    }
+}
+
+bool ConsoleView::hex_mode() const
+{
+    return _hex_mode;
+}
+
+void ConsoleView::set_timestamps(TIMESTAMPS timestamps)
+{
+    _timestamps = timestamps;
+    _max_width = 0;
+    viewport()->update();
+}
+
+ConsoleView::TIMESTAMPS ConsoleView::timestamps() const
+{
+    return _timestamps;
+}
+
+void ConsoleView::set_encoding(TextDecoder::ENCODING encoding)
+{
+    if(_encoding != encoding)
+    {
+        _encoding = encoding;
+        // wraps depend on where characters end
+        reindex();
+    }
+}
+
+TextDecoder::ENCODING ConsoleView::encoding() const
+{
+    return _encoding;
+}
+
+void ConsoleView::set_highlighter(const TriggerEngine* triggers)
+{
+    _triggers = triggers;
+    viewport()->update();
+}
+
+void ConsoleView::set_decoder(const PacketDecoder* decoder)
+{
+    _decoder = decoder;
+    if(_hex_mode)
+    {
+        reindex();
+    }
+}
+
+void ConsoleView::set_protect_alphanumeric(bool protect)
+{
+    _hex.set_protect_alphanumeric(protect);
+    _max_width = 0;
+    viewport()->update();
+}
+
+void ConsoleView::set_protect_extended(bool protect)
+{
+    _hex.set_protect_extended(protect);
+    _max_width = 0;
+    viewport()->update();
+}
+
+const ScrollbackBuffer& ConsoleView::buffer() const
+{
+    return _buffer;
+}
+
+ConsoleView::PaintStats ConsoleView::paint_stats() const
+{
+    return _paint_stats;
+}
+
+void ConsoleView::copy_selection() const
+{
+    if(_selection_anchor < 0)
+    {
+        return;
+    }
+    const std::int64_t first = std::max(std::min(_selection_anchor, _selection_end), _first_line);
+    const std::int64_t last = std::min(std::max(_selection_anchor, _selection_end),
+                                       _first_line + static_cast<std::int64_t>(_lines.size()) - 1);
+    QStringList text;
+    for(std::int64_t i = first; i <= last; ++i)
+    {
+        text.append(render_line(_lines[static_cast<std::size_t>(i - _first_line)]));
+    }
+    QApplication::clipboard()->setText(text.join('\n'));
+}
+
+void ConsoleView::select_all()
+{
+    if(_lines.empty())
+    {
+        return;
+    }
+    _selection_anchor = _first_line;
+    _selection_end = _first_line + static_cast<std::int64_t>(_lines.size()) - 1;
+    viewport()->update();
+}
+
+void ConsoleView::reveal(std::uint64_t offset, std::uint64_t length)
+{
+    // first line ending past a byte holds it, empty marker lines end where they start
+    const auto holding = [this](std::uint64_t byte)
+    {
+        return std::partition_point(_lines.begin(), _lines.end(), [byte](const Line& line)
+        {
+            return line.offset + line.length <= byte;
+        });
+    };
+    const auto first = holding(offset);
+    if(first == _lines.end())
+    {
+        return;
+    }
+    auto last = holding(offset + std::max<std::uint64_t>(length, 1) - 1);
+    if(last == _lines.end())
+    {
+        --last;
+    }
+
+    const std::int64_t first_index = std::distance(_lines.begin(), first);
+    _selection_anchor = _first_line + first_index;
+    _selection_end = _first_line + std::distance(_lines.begin(), last);
+
+    // match lands in the middle of the page
+    const int page = verticalScrollBar()->pageStep();
+    verticalScrollBar()->setValue(static_cast<int>(std::min<std::int64_t>(first_index, std::numeric_limits<int>::max())) - page / 2);
+    viewport()->update();
+}
+
+void ConsoleView::paintEvent(QPaintEvent *)
+{
+    const std::int64_t start = monotonic_ns();
+
+    QPainter painter(viewport());
+    const QFontMetrics metrics = fontMetrics();
+    const int line_height = metrics.lineSpacing();
+    const int x = margin - horizontalScrollBar()->value();
+
+    const std::size_t first = static_cast<std::size_t>(verticalScrollBar()->value());
+    const std::size_t last = std::min(_lines.size(), first + static_cast<std::size_t>(viewport()->height() / line_height + 2));
+
+    int y = 0;
+    int widest = 0;
+    for(std::size_t i = first; i < last; ++i)
+    {
+        const QString text = render_line(_lines[i]);
+        if(is_selected(_first_line + static_cast<std::int64_t>(i)))
+        {
+            painter.fillRect(0, y, viewport()->width(), line_height, palette().highlight());
+            painter.setPen(palette().color(QPalette::HighlightedText));
+        }
+        else if(_lines[i].flags & BAD)
+        {
+            painter.setPen(bad_frame_color);
+        }
+        else
+        {
+            painter.setPen(palette().color(QPalette::Text));
+        }
+        paint_highlights(painter, _lines[i], text, x, y);
+        painter.drawText(x, y + metrics.ascent(), text);
+        widest = std::max(widest, metrics.horizontalAdvance(text));
+        y += line_height;
+    }
+
+    if(widest + 2 * margin > _max_width)
+    {
+        _max_width = widest + 2 * margin;
+        horizontalScrollBar()->setRange(0, std::max(0, _max_width - viewport()->width()));
+    }
+
+    const std::int64_t duration = monotonic_ns() - start;
+    ++_paint_stats.paints;
+    _paint_stats.time += duration;
+    _paint_stats.max = std::max(_paint_stats.max, duration);
+}
+
+void ConsoleView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    update_scrollbars();
+}
+
+void ConsoleView::changeEvent(QEvent *event)
+{
+    if(event->type() == QEvent::FontChange && !QFontInfo(font()).fixedPitch())
+    {
+        // forms only set point size, keep rendering monospaced
+        QFont fixed = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+        fixed.setPointSize(font().pointSize());
+        setFont(fixed);
+    }
+    if(event->type() == QEvent::FontChange)
+    {
+        _max_width = 0;
+        update_scrollbars();
+    }
+    QAbstractScrollArea::changeEvent(event);
+}
+
+void ConsoleView::keyPressEvent(QKeyEvent *event)
+{
+    if(event->matches(QKeySequence::Copy))
+    {
+        copy_selection();
+    }
+    else if(event->matches(QKeySequence::SelectAll))
+    {
+        select_all();
+    }
+    else if(event->key() == Qt::Key_PageUp)
+    {
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderPageStepSub);
+    }
+    else if(event->key() == Qt::Key_PageDown)
+    {
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderPageStepAdd);
+    }
+    else if(event->key() == Qt::Key_Home)
+    {
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderToMinimum);
+    }
+    else if(event->key() == Qt::Key_End)
+    {
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderToMaximum);
+    }
+    else
+    {
+        QAbstractScrollArea::keyPressEvent(event);
+    }
+}
+
+void ConsoleView::mousePressEvent(QMouseEvent *event)
+{
+    if(event->button() == Qt::LeftButton)
+    {
+        _selection_anchor = line_at(event->pos());
+        _selection_end = _selection_anchor;
+        viewport()->update();
+    }
+    QAbstractScrollArea::mousePressEvent(event);
+}
+
+void ConsoleView::mouseMoveEvent(QMouseEvent *event)
+{
+    if(event->buttons() & Qt::LeftButton && _selection_anchor >= 0)
+    {
+        _selection_end = line_at(event->pos());
+        viewport()->update();
+    }
+    QAbstractScrollArea::mouseMoveEvent(event);
+}
+
+void ConsoleView::contextMenuEvent(QContextMenuEvent *event)
+{
+    QMenu menu(this);
+    QAction* copy = menu.addAction("Copy");
+    copy->setEnabled(_selection_anchor >= 0);
+    QAction* all = menu.addAction("Select all");
+    QAction* selected = menu.exec(event->globalPos());
+    if(selected == copy)
+    {
+        copy_selection();
+    }
+    else if(selected == all)
+    {
+        select_all();
+    }
+}
+
+void ConsoleView::index()
+{
+    const std::deque<ScrollbackBuffer::Chunk>& chunks = _buffer.chunks();
+    _indexed = std::max(_indexed, _buffer.begin_offset());
+
+    for(std::size_t c = _buffer.chunk_index(_indexed); c < chunks.size(); ++c)
+    {
+        const ScrollbackBuffer::Chunk& chunk = chunks[c];
+        std::uint64_t position = std::max(chunk.offset, _indexed);
+
+        if(chunk.sender != _indexed_sender)
+        {
+            if(_indexed_sender != SENDER::NONE)
+            {
+                _lines.push_back(Line{position, 0, chunk.sender, SEPARATOR});
+            }
+            _lines.push_back(Line{position, 0, chunk.sender, FIRST});
+            _line_open = true;
+            _indexed_sender = chunk.sender;
+        }
+
+        const bool frame = chunk.flags & ScrollbackBuffer::FRAME;
+        if(frame && position == chunk.offset && _line_open && _lines.back().length > 0)
+        {
+            _line_open = false;
+        }
+        const std::uint8_t bad = (chunk.flags & ScrollbackBuffer::BAD_FRAME) ? BAD : 0;
+
+        // a sender's first line is still an open empty marker and takes the packet
+        if(frame && !bad && position == chunk.offset && is_packet(chunk))
+        {
+            if(!_line_open)
+            {
+                _lines.push_back(Line{position, 0, chunk.sender, 0});
+            }
+            _lines.back().length = chunk.length;
+            _lines.back().flags |= DECODED;
+            _line_open = false;
+            _indexed = chunk.end();
+            continue;
+        }
+
+        while(position < chunk.end())
+        {
+            if(!_line_open)
+            {
+                _lines.push_back(Line{position, 0, chunk.sender, 0});
+                _line_open = true;
+            }
+            Line& line = _lines.back();
+            line.flags |= bad;
+            if(_hex_mode)
+            {
+                const std::uint64_t limit = std::min(chunk.end(), line.offset + hex_line);
+                line.length = static_cast<std::uint32_t>(limit - line.offset);
+                position = limit;
+                _line_open = line.length < hex_line;
+            }
+            else
+            {
+                const std::uint64_t limit = std::min(chunk.end(), line.offset + max_text_line);
+                const std::uint64_t found = _buffer.find(position, limit, '\n');
+                if(found < limit)
+                {
+                    line.length = static_cast<std::uint32_t>(found + 1 - line.offset);
+                    position = found + 1;
+                    _line_open = false;
+                }
+                else
+                {
+                    std::uint64_t end = limit;
+                    _line_open = limit - line.offset < max_text_line;
+                    if(!_line_open)
+                    {
+                        // a sequence cut by the wrap moves to the next line
+                        char tail[3];
+                        _buffer.copy(limit - sizeof(tail), sizeof(tail), tail);
+                        end = limit - sizeof(tail) + TextDecoder::complete(tail, sizeof(tail), _encoding);
+                    }
+                    line.length = static_cast<std::uint32_t>(end - line.offset);
+                    position = end;
+                }
+            }
+        }
+        if(frame)
+        {
+            _line_open = false;
+        }
+        _indexed = chunk.end();
+    }
+}
+
+bool ConsoleView::is_packet(const ScrollbackBuffer::Chunk& chunk)
+{
+    if(!_hex_mode || !_decoder || _decoder->empty())
+    {
+        return false;
+    }
+    const std::size_t head = std::min<std::size_t>(chunk.length, _decoder->match_extent());
+    _packet_head.resize(head);
+    _buffer.copy(chunk.offset, head, _packet_head.data());
+    return _decoder->match(_packet_head.data(), chunk.length) >= 0;
+}
+
+void ConsoleView::reindex()
+{
+    const bool at_bottom = verticalScrollBar()->value() == verticalScrollBar()->maximum();
+
+    _lines.clear();
+    _first_line = 0;
+    _indexed = _buffer.begin_offset();
+    _indexed_sender = SENDER::NONE;
+    _line_open = false;
+    _selection_anchor = -1;
+    _selection_end = -1;
+    _max_width = 0;
+    index();
+
+    update_scrollbars();
+    if(at_bottom)
+    {
+        verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+    }
+    viewport()->update();
+}
+
+void ConsoleView::drop_trimmed()
+{
+    const std::uint64_t begin = _buffer.begin_offset();
+    int dropped = 0;
+    while(!_lines.empty())
+    {
+        Line& line = _lines.front();
+        const bool trimmed = (line.flags & SEPARATOR) ?
+                    line.offset < begin : (line.offset < begin && line.offset + line.length <= begin);
+        if(trimmed)
+        {
+            _lines.pop_front();
+            ++_first_line;
+            ++dropped;
+        }
+        else
+        {
+            if(line.offset < begin)
+            {
+                // the rest of a packet is no longer the packet
+                line.length -= static_cast<std::uint32_t>(begin - line.offset);
+                line.offset = begin;
+                line.flags &= static_cast<std::uint8_t>(~DECODED);
+            }
+            break;
+        }
+    }
+    if(_lines.empty())
+    {
+        _line_open = false;
+    }
+
+    // keep content under the reader in place when not following the tail
+    if(dropped > 0 && verticalScrollBar()->value() != verticalScrollBar()->maximum())
+    {
+        verticalScrollBar()->setValue(std::max(0, verticalScrollBar()->value() - dropped));
+    }
+}
+
+void ConsoleView::update_scrollbars()
+{
+    const bool at_bottom = verticalScrollBar()->value() == verticalScrollBar()->maximum();
+    const int page = std::max(1, viewport()->height() / fontMetrics().lineSpacing());
+    const int lines = static_cast<int>(std::min<std::size_t>(_lines.size(), std::numeric_limits<int>::max()));
+
+    verticalScrollBar()->setPageStep(page);
+    verticalScrollBar()->setRange(0, std::max(0, lines - page));
+    if(at_bottom)
+    {
+        verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+    }
+
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    horizontalScrollBar()->setSingleStep(fontMetrics().averageCharWidth());
+    horizontalScrollBar()->setRange(0, std::max(0, _max_width - viewport()->width()));
+}
+
+QString ConsoleView::render_line(const Line& line) const
+{
+    if(line.flags & SEPARATOR)
+    {
+        return QString();
+    }
+
+    QByteArray bytes(static_cast<int>(line.length), Qt::Uninitialized);
+    _buffer.copy(line.offset, line.length, bytes.data());
+
+    QString text = line_prefix(line);
+
+    if(_hex_mode)
+    {
+        const QString decoded = (line.flags & DECODED) && _decoder ?
+                    _decoder->format(bytes.constData(), static_cast<std::size_t>(bytes.size())) : QString();
+        text += decoded.isEmpty() ? format_hex(bytes) : decoded;
+    }
+    else
+    {
+        while(bytes.endsWith('\n') || bytes.endsWith('\r'))
+        {
+            bytes.chop(1);
+        }
+        text += decode_text(bytes);
+    }
+    return text;
+}
+
+QString ConsoleView::line_prefix(const Line& line) const
+{
+    QString prefix = format_timestamp(line);
+    if(line.flags & FIRST)
+    {
+        prefix += line.sender == SENDER::DEVICE ? "<-- " : "--> ";
+    }
+    return prefix;
+}
+
+void ConsoleView::paint_highlights(QPainter& painter, const Line& line, const QString& text, int x, int y) const
+{
+    if(!_triggers || _triggers->empty() || line.sender != SENDER::DEVICE || line.length == 0 || (line.flags & (SEPARATOR | DECODED)))
+    {
+        return;
+    }
+
+    QByteArray bytes(static_cast<int>(line.length), Qt::Uninitialized);
+    _buffer.copy(line.offset, line.length, bytes.data());
+    std::vector<TriggerEngine::Match> matches;
+    _triggers->find(bytes.constData(), static_cast<std::size_t>(bytes.size()), TriggerEngine::HIGHLIGHT, matches);
+    if(matches.empty())
+    {
+        return;
+    }
+
+    // column of the character a byte starts, the way render_line() lays the line out
+    const int prefix = line_prefix(line).size();
+    const auto column = [&](int byte)
+    {
+        const QByteArray head = bytes.left(byte);
+        const int length = _hex_mode ? format_hex(head).size() : decode_text(head).size();
+        return std::min(prefix + length, text.size());
+    };
+    const QFontMetrics metrics = fontMetrics();
+    for(const TriggerEngine::Match& match : matches)
+    {
+        const int end = static_cast<int>(match.end);
+        const int begin = end - _triggers->rules()[static_cast<std::size_t>(match.rule)].pattern.size();
+        const int first = column(begin);
+        const int last = column(end);
+        if(last > first)
+        {
+            painter.fillRect(x + metrics.horizontalAdvance(text.left(first)), y,
+                             metrics.horizontalAdvance(text.mid(first, last - first)), metrics.lineSpacing(), trigger_color);
+        }
+    }
+}
+
+QString ConsoleView::format_hex(const QByteArray& bytes) const
+{
+    const std::size_t size = static_cast<std::size_t>(bytes.size());
+    QByteArray text(static_cast<int>(HexFormatter::output_capacity(size)), Qt::Uninitialized);
+    const std::size_t length = _hex.format(bytes.constData(), size, text.data());
+    return QString::fromLatin1(text.constData(), static_cast<int>(length));
+}
+
+QString ConsoleView::decode_text(const QByteArray& bytes) const
+{
+    TextDecoder decoder(_encoding);
+    QString text;
+    decoder.decode(bytes.constData(), static_cast<std::size_t>(bytes.size()), text);
+    decoder.flush(text);
+    return text;
+}
+
+QString ConsoleView::format_timestamp(const Line& line) const
+{
+    if(_timestamps == TIMESTAMPS::NONE)
+    {
+        return QString();
+    }
+    const std::deque<ScrollbackBuffer::Chunk>& chunks = _buffer.chunks();
+    const std::size_t chunk = _buffer.chunk_index(line.offset);
+    if(chunk >= chunks.size())
+    {
+        return QString();
+    }
+    const std::int64_t timestamp = chunks[chunk].timestamp;
+
+    // fixed width, so text after it stays in columns
+    switch(_timestamps)
+    {
+    case TIMESTAMPS::TIME_OF_DAY:
+    {
+        const std::int64_t wall = timestamp + _wall_offset;
+        return QDateTime::fromMSecsSinceEpoch(wall / 1000000).toString("hh:mm:ss.zzz") +
+                QString("%1 ").arg(wall / 1000 % 1000, 3, 10, QChar('0'));
+    }
+    case TIMESTAMPS::SINCE_START:
+        return QString("%1 ").arg(static_cast<double>(timestamp - _start) / 1e9, 14, 'f', 6);
+    case TIMESTAMPS::DELTA:
+    {
+        const std::int64_t previous = chunk > 0 ? chunks[chunk - 1].timestamp : timestamp;
+        return QString("+%1 ").arg(static_cast<double>(timestamp - previous) / 1e9, 12, 'f', 6);
+    }
+    default:
+        return QString();
+    }
+}
+
+std::int64_t ConsoleView::line_at(const QPoint& pos) const
+{
+    if(_lines.empty())
+    {
+        return -1;
+    }
+    const std::int64_t row = verticalScrollBar()->value() + std::max(0, pos.y()) / fontMetrics().lineSpacing();
+    return _first_line + std::min<std::int64_t>(row, static_cast<std::int64_t>(_lines.size()) - 1);
+}
+
+bool ConsoleView::is_selected(std::int64_t line) const
+{
+    if(_selection_anchor < 0)
+    {
+        return false;
+    }
+    return line >= std::min(_selection_anchor, _selection_end) &&
+           line <= std::max(_selection_anchor, _selection_end);
+}
@@ -0,0 +1,175 @@
+#ifndef CONSOLEVIEW_HPP
+#define CONSOLEVIEW_HPP
+
+/*
+Virtualized console view. History is kept as raw bytes in a bounded
+scrollback buffer and only lines visible in the viewport are formatted
+and painted, so cost of a repaint does not depend on history size.
+Timestamp prefixes come from the chunk a line starts in, looked up while
+the line is rendered. Trigger highlights are found the same way, by running
+the trigger automaton over each painted line, a match split over two lines
+is not highlighted.
+
+With a packet decoder in hex mode, a whole frame matching one of its
+packets is indexed as a single line and decoded into a row of fields when
+painted. Indexing only compares the identifying bytes, anything not
+matching stays hex.
+
+Text is decoded in the selected encoding. Long lines are wrapped on a
+character boundary so every line decodes on its own.
+*/
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include <QAbstractScrollArea>
+#include <QByteArray>
+
+class QPainter;
+
+#include "scrollbackbuffer.hpp"
+#include "hexformatter.hpp"
+#include "packetdecoder.hpp"
+#include "textdecoder.hpp"
+#include "triggerengine.hpp"
+
+class ConsoleView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+
+    struct PaintStats
+    {
+        std::uint64_t paints;
+        std::int64_t time;      // nanoseconds, all paints together
+        std::int64_t max;       // slowest paint
+    };
+
+    // end of one read or frame within appended data, flags from ScrollbackBuffer::CHUNK_FLAG
+    struct Piece
+    {
+        std::uint32_t end;
+        std::uint8_t flags;
+        std::int64_t timestamp;
+    };
+
+    enum class TIMESTAMPS
+    {
+        NONE = 0,
+        TIME_OF_DAY,
+        SINCE_START,    // since the view was created or cleared
+        DELTA           // since the previous chunk
+    };
+
+    explicit ConsoleView(QWidget *parent = nullptr);
+
+    // every piece keeps its own timestamp, pieces flagged FRAME start on a new line
+    void append_pieces(const QByteArray& data, const std::vector<Piece>& pieces, const SENDER& sender);
+    void clear();
+
+    void set_capacity(std::size_t capacity);
+    std::size_t capacity() const;
+
+    void set_hex_mode(bool hex);
+    bool hex_mode() const;
+
+    void set_timestamps(TIMESTAMPS timestamps);
+    TIMESTAMPS timestamps() const;
+
+    void set_encoding(TextDecoder::ENCODING encoding);
+    TextDecoder::ENCODING encoding() const;
+
+    // rules with the highlight action are marked in painted lines, owned by the caller
+    void set_highlighter(const TriggerEngine* triggers);
+    // frames of known packets are shown decoded in hex mode, owned by the caller,
+    // set again after changing its packets
+    void set_decoder(const PacketDecoder* decoder);
+
+    void set_protect_alphanumeric(bool protect);
+    void set_protect_extended(bool protect);
+
+    const ScrollbackBuffer& buffer() const;
+    PaintStats paint_stats() const;
+
+    void copy_selection() const;
+    void select_all();
+
+    // selects the lines holding buffer bytes [offset, offset + length) and scrolls them into view
+    void reveal(std::uint64_t offset, std::uint64_t length);
+
+protected:
+
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void changeEvent(QEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void contextMenuEvent(QContextMenuEvent *event) override;
+
+private:
+
+    enum LINE_FLAG : std::uint8_t
+    {
+        FIRST = 1,      // first line sent by new sender
+        SEPARATOR = 2,  // empty line between senders
+        BAD = 4,        // part of a frame that failed validation
+        DECODED = 8     // whole frame of a packet the decoder knows
+    };
+
+    struct Line
+    {
+        std::uint64_t offset;
+        std::uint32_t length;
+        SENDER sender;
+        std::uint8_t flags;
+    };
+
+    void index();
+    bool is_packet(const ScrollbackBuffer::Chunk& chunk);
+    void reindex();
+    void drop_trimmed();
+    void update_scrollbars();
+
+    QString render_line(const Line& line) const;
+    QString line_prefix(const Line& line) const;
+    void paint_highlights(QPainter& painter, const Line& line, const QString& text, int x, int y) const;
+    QString format_hex(const QByteArray& bytes) const;
+    QString decode_text(const QByteArray& bytes) const;
+    QString format_timestamp(const Line& line) const;
+
+    std::int64_t line_at(const QPoint& pos) const;
+    bool is_selected(std::int64_t line) const;
+
+    ScrollbackBuffer _buffer;
+    std::deque<Line> _lines;
+
+    // absolute number of _lines.front(), keeps selection stable while trimming
+    std::int64_t _first_line;
+    std::uint64_t _indexed;
+    SENDER _indexed_sender;
+    bool _line_open;
+
+    bool _hex_mode;
+    HexFormatter _hex;
+    TextDecoder::ENCODING _encoding;
+
+    const TriggerEngine* _triggers;
+    const PacketDecoder* _decoder;
+    std::vector<char> _packet_head;
+
+    TIMESTAMPS _timestamps;
+    // wall clock minus monotonic clock, nanoseconds
+    std::int64_t _wall_offset;
+    std::int64_t _start;
+
+    std::int64_t _selection_anchor;
+    std::int64_t _selection_end;
+    int _max_width;
+
+    PaintStats _paint_stats;
+};
+
+#endif
@@ -0,0 +1,39 @@
+#include "mainwindow.hpp"
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+
+#include "monotonicclock.hpp"
+
+int main(int argc, char *argv[])
+{
+    // before anything else, so startup times include setting up the application
+    const std::int64_t started = monotonic_ns();
+
+    QApplication a(argc, argv);
+
+    QCoreApplication::setOrganizationName("Vernocte laboratories");
+    QCoreApplication::setOrganizationDomain("vernocte.org");
+    QCoreApplication::setApplicationName("Serial Port Commander");
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    const QCommandLineOption startup_option("startup-time", "Print how long startup took once ports and library are loaded, then quit.");
+    parser.addOption(startup_option);
+    parser.process(a);
+
+    MainWindow w(nullptr, started);
+    if(parser.isSet(startup_option))
+    {
+        QObject::connect(&w, &MainWindow::startup_finished, &a, [&w]()
+        {
+            QTextStream out(stdout);
+            out << w.startup_report() << '\n';
+            out.flush();
+            QCoreApplication::quit();
+        }, Qt::QueuedConnection);
+    }
+    w.show();
+
+    return a.exec();
+}
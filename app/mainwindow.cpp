@@ -0,0 +1,559 @@
+#include "mainwindow.hpp"
+#include "ui_mainwindow.h"
+
+#include <QSettings>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QInputDialog>
+#include <QMessageBox>
+#include <QSignalBlocker>
+#include <QStandardPaths>
+#include <QDir>
+#include <QTimer>
+
+#include <algorithm>
+
+#include "comportconsole.hpp"
+#include "commanddelegate.hpp"
+#include "capturereader.hpp"
+#include "messageformat.hpp"
+#include "monotonicclock.hpp"
+#ifdef Q_OS_LINUX
+#include "reactorbackend.hpp"
+#endif
+
+MainWindow::MainWindow(QWidget *parent, std::int64_t started) :
+    QMainWindow(parent),
+    ui(new Ui::MainWindow), _watcher(), _commands(), _command_filter(), _journal(), _history(),
+    _library_thread(), _library_stop(false), _library_generation(0), _library_loading(false),
+    _pending_saves(), _pending_deletes(),
+    _started(started != 0 ? started : monotonic_ns()), _first_paint(-1), _ports_ready(-1), _library_ready(-1)
+{
+    ui->setupUi(this);
+
+    // filtering runs over the display text, case does not matter
+    _command_filter.setSourceModel(&_commands);
+    _command_filter.setFilterCaseSensitivity(Qt::CaseInsensitive);
+    ui->messages_list->setModel(&_command_filter);
+    CommandDelegate* delegate = new CommandDelegate(ui->messages_list);
+    ui->messages_list->setItemDelegate(delegate);
+    connect(delegate, &CommandDelegate::send_command, this, &MainWindow::send_command);
+    connect(delegate, &CommandDelegate::delete_command, this, &MainWindow::delete_command);
+    connect(ui->messages_filter_edit, &QLineEdit::textChanged, &_command_filter, &QSortFilterProxyModel::setFilterFixedString);
+
+    QSettings settings;
+    restoreGeometry(settings.value("MainWindow/geometry").toByteArray());
+    restoreState(settings.value("MainWindow/state").toByteArray());
+
+    for(const QString& port : _watcher.ports())
+    {
+        add_port_item(port);
+    }
+    connect(&_watcher, &PortWatcher::ports_changed, this, &MainWindow::ports_changed);
+    connect(&_watcher, &PortWatcher::enumerated, this, [this]()
+    {
+        if(_ports_ready < 0)
+        {
+            _ports_ready = monotonic_ns();
+            startup_step();
+        }
+    });
+
+    {
+        // an empty path has to be loaded as well, setting it would not say so
+        const QSignalBlocker blocker(ui->messages_file_path);
+        ui->messages_file_path->setText(settings.value("messagespath").toString());
+    }
+    load_library(ui->messages_file_path->text());
+
+    {
+        const QSignalBlocker blocker(ui->io_threads_spin);
+        ui->io_threads_spin->setValue(settings.value("MainWindow/io_threads", 0).toInt());
+    }
+#ifdef Q_OS_LINUX
+    if(ui->io_threads_spin->value() > 0)
+    {
+        _reactor = std::make_unique<PortReactor>(ui->io_threads_spin->value());
+    }
+#else
+    ui->io_threads_spin->hide();
+#endif
+}
+
+MainWindow::~MainWindow()
+{
+    // queued batches are dropped along with this object
+    stop_library();
+
+    QSettings settings;
+    settings.setValue("MainWindow/geometry", saveGeometry());
+    settings.setValue("MainWindow/state", saveState());
+
+    // consoles refer to the port workers, so they go before the members
+    while(ui->main_tab_widget->count() > 0)
+    {
+        delete ui->main_tab_widget->widget(0);
+    }
+
+    delete ui;
+}
+
+QString MainWindow::startup_report() const
+{
+    const auto step = [this](std::int64_t done)
+    {
+        return done < 0 ? QString("-") : QString::number(static_cast<double>(done - _started) / 1e6, 'f', 1);
+    };
+    return QString("first paint %1 ms, ports %2 ms (%3), library %4 ms (%5 commands)")
+            .arg(step(_first_paint), step(_ports_ready))
+            .arg(_watcher.ports().size())
+            .arg(step(_library_ready))
+            .arg(_commands.rowCount());
+}
+
+void MainWindow::paintEvent(QPaintEvent *event)
+{
+    QMainWindow::paintEvent(event);
+    if(_first_paint < 0)
+    {
+        _first_paint = monotonic_ns();
+        // consoles need it only once a port is opened
+        QTimer::singleShot(0, this, &MainWindow::open_history);
+        startup_step();
+    }
+}
+
+void MainWindow::ports_changed(const QStringList& added, const QStringList& removed)
+{
+    for(const QString& port : removed)
+    {
+        remove_port_item(port);
+    }
+    for(const QString& port : added)
+    {
+        add_port_item(port);
+    }
+}
+
+void MainWindow::add_port_item(const QString& port)
+{
+    // list is kept sorted, item signals only matter when the user clicks
+    const QSignalBlocker blocker(ui->ports_list);
+    int row = 0;
+    while(row < ui->ports_list->count() && ui->ports_list->item(row)->text() < port)
+    {
+        ++row;
+    }
+    if(row < ui->ports_list->count() && ui->ports_list->item(row)->text() == port)
+    {
+        return;
+    }
+
+    QListWidgetItem* item = new QListWidgetItem(port);
+    item->setSizeHint(QSize(item->sizeHint().width(), 64));
+    item->setCheckState(is_connected(port) ? Qt::Checked : Qt::Unchecked);
+    ui->ports_list->insertItem(row, item);
+}
+
+void MainWindow::remove_port_item(const QString& port)
+{
+    close_port(port);
+
+    const QSignalBlocker blocker(ui->ports_list);
+    for(int i = ui->ports_list->count() - 1; i >= 0; --i)
+    {
+        if(ui->ports_list->item(i)->text() == port)
+        {
+            delete ui->ports_list->takeItem(i);
+        }
+    }
+}
+
+void MainWindow::close_port(const QString& port)
+{
+    for(int i = ui->main_tab_widget->count() - 1; i >= 0; --i)
+    {
+        if(ui->main_tab_widget->tabText(i) == port)
+        {
+            // console refers to the port worker, so it goes first
+            delete ui->main_tab_widget->widget(i);
+        }
+    }
+    _connected_ports.erase(std::remove_if(_connected_ports.begin(), _connected_ports.end(), [&port](const std::unique_ptr<PortWorker>& p)
+    {
+        return p->port_name() == port;
+    }), _connected_ports.end());
+
+    const QSignalBlocker blocker(ui->ports_list);
+    for(int i = 0; i < ui->ports_list->count(); ++i)
+    {
+        if(ui->ports_list->item(i)->text() == port)
+        {
+            ui->ports_list->item(i)->setCheckState(Qt::Unchecked);
+        }
+    }
+
+#ifdef Q_OS_UNIX
+    // replay ports exist only for a single session
+    const auto replay = std::find_if(_replays.begin(), _replays.end(), [&port](const std::unique_ptr<ReplayEngine>& r)
+    {
+        return r->port_name() == port;
+    });
+    if(replay != _replays.end())
+    {
+        _replays.erase(replay);
+        // may be called from the item's own signal, drop it once that returns
+        QMetaObject::invokeMethod(this, [this, port]()
+        {
+            remove_port_item(port);
+        }, Qt::QueuedConnection);
+    }
+#endif
+}
+
+bool MainWindow::is_connected(const QString& port)
+{
+    for(auto& p : _connected_ports)
+    {
+        if(p->port_name() == port)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MainWindow::on_ports_list_itemChanged(QListWidgetItem *item)
+{
+    const QString port = item->text();
+    if(item->checkState() == Qt::Checked)
+    {
+        if(is_connected(port))
+        {
+            return;
+        }
+        // connect to port
+#ifdef Q_OS_LINUX
+        if(_reactor)
+        {
+            _connected_ports.emplace_back(std::make_unique<PortWorker>(std::make_unique<ReactorBackend>(port, _reactor.get())));
+        }
+        else
+#endif
+        {
+            _connected_ports.emplace_back(std::make_unique<PortWorker>(port));
+        }
+        if(!_connected_ports.back()->open())
+        {
+            _connected_ports.pop_back();
+            const QSignalBlocker blocker(ui->ports_list);
+            item->setCheckState(Qt::Unchecked);
+            return;
+        }
+
+        // unplugged while open, watcher may take a moment to notice the node is gone
+        connect(_connected_ports.back().get(), &PortWorker::closed, this, [this, port]()
+        {
+            close_port(port);
+        }, Qt::QueuedConnection);
+
+        ComPortConsole* console = new ComPortConsole(ui->main_tab_widget);
+        connect(console, &ComPortConsole::save_message, this, &MainWindow::save_command);
+        console->set_history(&_history);
+        console->set_port(_connected_ports.back().get());
+        ui->main_tab_widget->addTab(console, port);
+#ifdef Q_OS_UNIX
+        // replay starts once somebody listens, keeps original timing intact
+        for(auto& replay : _replays)
+        {
+            if(replay->port_name() == port)
+            {
+                replay->start();
+            }
+        }
+#endif
+    }
+    else if(item->checkState() == Qt::Unchecked)
+    {
+        // disconnect from the port
+        close_port(port);
+    }
+}
+
+void MainWindow::on_main_tab_widget_currentChanged(int)
+{
+
+}
+
+void MainWindow::save_command(QString command)
+{
+    if(_library_loading)
+    {
+        _pending_saves.append(command);
+        return;
+    }
+    _commands.add(command);
+    _journal.append(command);
+    compact_commands();
+}
+
+void MainWindow::send_command(std::uint64_t id)
+{
+    ComPortConsole* port = qobject_cast<ComPortConsole*>(ui->main_tab_widget->currentWidget());
+    if(port)
+    {
+        port->send_message(_commands.command(id));
+    }
+}
+
+void MainWindow::delete_command(std::uint64_t id)
+{
+    if(_library_loading)
+    {
+        // hidden right away, library_loaded() resets the list and deletes it again by text
+        const QString command = _commands.command(id);
+        if(_commands.remove(id))
+        {
+            _pending_deletes.append(command);
+        }
+        return;
+    }
+    const int row = _commands.row(id);
+    if(_commands.remove(id))
+    {
+        _journal.remove(row);
+        compact_commands();
+    }
+}
+
+void MainWindow::compact_commands()
+{
+    if(!_journal.needs_compaction())
+    {
+        return;
+    }
+    QString error;
+    if(!_journal.compact(_commands.commands(), &error))
+    {
+        // journal keeps growing and still holds every edit
+        QMessageBox::warning(this, "Messages", error);
+    }
+}
+
+void MainWindow::on_messages_file_button_clicked()
+{
+    QSettings settings;
+    QFileDialog dialog;
+    dialog.setFileMode(QFileDialog::AnyFile);
+    dialog.setDefaultSuffix("txt");
+    dialog.setNameFilter("*.txt");
+    dialog.setDirectory(settings.value("messagespathdirectory").toString());
+    QString path = "";
+    if(dialog.exec())
+    {
+        path = dialog.selectedFiles().first();
+    }
+    if(path.size() != 0)
+    {
+        ui->messages_file_path->setText(path);
+        settings.setValue("messagespath", path);
+        settings.setValue("messagespathdirectory", dialog.directory().path());
+    }
+}
+
+void MainWindow::on_messages_file_path_textChanged(const QString &arg1)
+{
+    load_library(arg1);
+}
+
+void MainWindow::on_replay_button_clicked()
+{
+#ifdef Q_OS_UNIX
+    QSettings settings;
+    const QString path = QFileDialog::getOpenFileName(this, "Replay capture",
+                                                      settings.value("replaydirectory").toString(),
+                                                      "Capture (*.spcap)");
+    if(path.isEmpty())
+    {
+        return;
+    }
+    settings.setValue("replaydirectory", QFileInfo(path).path());
+
+    bool ok = false;
+    const double speed = QInputDialog::getDouble(this, "Replay capture", "Speed (0 replays as fast as possible)",
+                                                 1.0, 0.0, 1000.0, 2, &ok);
+    if(!ok)
+    {
+        return;
+    }
+
+    std::unique_ptr<ReplayEngine> replay = std::make_unique<ReplayEngine>(CaptureReader::session_files(path), speed);
+    if(!replay->open())
+    {
+        QMessageBox::warning(this, "Replay capture", replay->error_string());
+        return;
+    }
+    add_port_item(replay->port_name());
+    _replays.emplace_back(std::move(replay));
+#endif
+}
+
+void MainWindow::on_schedule_button_clicked()
+{
+    ComPortConsole* port = qobject_cast<ComPortConsole*>(ui->main_tab_widget->currentWidget());
+    if(!port)
+    {
+        return;
+    }
+    // one command per line there, control characters have to stay escaped
+    QStringList commands;
+    for(const QString& command : _commands.commands())
+    {
+        commands.append(MessageFormat::escape(command));
+    }
+    port->set_schedule(commands);
+}
+
+void MainWindow::on_io_threads_spin_valueChanged(int threads)
+{
+    QSettings settings;
+    settings.setValue("MainWindow/io_threads", threads);
+}
+
+void MainWindow::open_history()
+{
+    const QString data = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QString error;
+    if(!QDir().mkpath(data) || !_history.open(data + "/history", &error))
+    {
+        QMessageBox::warning(this, "History", error.isEmpty() ? QString("%1 is not writable").arg(data) : error);
+    }
+}
+
+void MainWindow::load_library(const QString& path)
+{
+    stop_library();
+    _journal.close();
+    _commands.clear();
+    _library_loading = true;
+    const int generation = ++_library_generation;
+    if(path.isEmpty())
+    {
+        library_loaded(generation, path, CommandJournal::Library(), true, QString());
+        return;
+    }
+
+    ui->messages_filter_edit->setPlaceholderText("Loading...");
+    _library_thread = std::thread([this, generation, path]()
+    {
+        CommandJournal::Library library;
+        QString error;
+        const bool ok = CommandJournal::read(path, library, [this, generation](const QStringList& batch)
+        {
+            if(_library_stop)
+            {
+                return false;
+            }
+            QMetaObject::invokeMethod(this, [this, generation, batch]()
+            {
+                library_batch(generation, batch);
+            }, Qt::QueuedConnection);
+            return true;
+        }, &error);
+        if(!_library_stop)
+        {
+            QMetaObject::invokeMethod(this, [this, generation, path, library, ok, error]()
+            {
+                library_loaded(generation, path, library, ok, error);
+            }, Qt::QueuedConnection);
+        }
+    });
+}
+
+void MainWindow::stop_library()
+{
+    if(_library_thread.joinable())
+    {
+        _library_stop = true;
+        _library_thread.join();
+        _library_stop = false;
+    }
+}
+
+void MainWindow::library_batch(int generation, const QStringList& commands)
+{
+    if(generation != _library_generation)
+    {
+        return;
+    }
+    // one insert per batch, rows are only painted when visible
+    _commands.append(commands);
+    ui->messages_filter_edit->setPlaceholderText(QString("Loading, %1 commands").arg(_commands.rowCount()));
+}
+
+void MainWindow::library_loaded(int generation, const QString& path, const CommandJournal::Library& library,
+                                bool ok, const QString& error)
+{
+    if(generation != _library_generation)
+    {
+        return;
+    }
+    if(_library_thread.joinable())
+    {
+        _library_thread.join();
+    }
+    _library_loading = false;
+    ui->messages_filter_edit->setPlaceholderText("Filter");
+
+    if(!error.isEmpty())
+    {
+        QMessageBox::warning(this, "Messages", error);
+    }
+    // batches hold the file as it is, journal edits replayed over it need a reset,
+    // which also gives rows new ids, so deletes made while loading go by text
+    if(library.operations > 0 || _commands.rowCount() != library.commands.size() || !_pending_deletes.isEmpty())
+    {
+        _commands.set_commands(library.commands);
+    }
+    QString open_error;
+    if(ok && !_journal.open(path, library, &open_error) && !open_error.isEmpty())
+    {
+        QMessageBox::warning(this, "Messages", open_error);
+    }
+
+    if(!_journal.is_open() && !(_pending_saves.isEmpty() && _pending_deletes.isEmpty()))
+    {
+        QMessageBox::warning(this, "Messages", QString("%1 is not open, commands saved or deleted while it was loading "
+                                                       "are only kept until the program exits").arg(path));
+    }
+    const QStringList deletes = _pending_deletes;
+    _pending_deletes.clear();
+    for(const QString& command : deletes)
+    {
+        const std::uint64_t id = _commands.find(command);
+        if(id != 0)
+        {
+            delete_command(id);
+        }
+    }
+    const QStringList saves = _pending_saves;
+    _pending_saves.clear();
+    for(const QString& command : saves)
+    {
+        save_command(command);
+    }
+
+    if(_library_ready < 0)
+    {
+        _library_ready = monotonic_ns();
+        startup_step();
+    }
+}
+
+void MainWindow::startup_step()
+{
+    if(_first_paint >= 0 && _ports_ready >= 0 && _library_ready >= 0)
+    {
+        emit startup_finished();
+    }
+}
@@ -0,0 +1,139 @@
+#ifndef MAINWINDOW_HPP
+#define MAINWINDOW_HPP
+
+/*
+Main application window
+
+Nothing slow runs before the window is painted for the first time. Ports
+are enumerated by the watcher's own thread, the command library is read on
+another one and streams into the list while it is parsed, and the history
+is loaded once the window is up. startup_report() tells how long each of
+these took from the start of the process.
+*/
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <memory>
+
+#include <QMainWindow>
+#include <QListWidgetItem>
+#include <QSortFilterProxyModel>
+
+#include "portworker.hpp"
+#include "portwatcher.hpp"
+#include "commandmodel.hpp"
+#include "commandjournal.hpp"
+#include "commandhistory.hpp"
+#ifdef Q_OS_UNIX
+#include "replayengine.hpp"
+#endif
+#ifdef Q_OS_LINUX
+#include "portreactor.hpp"
+#endif
+
+namespace Ui {
+class MainWindow;
+}
+
+class MainWindow : public QMainWindow
+{
+    Q_OBJECT
+
+signals:
+
+    // first paint, ports and library all done
+    void startup_finished();
+
+public:
+    // started is monotonic_ns() taken as early as possible, 0 starts the clock here
+    explicit MainWindow(QWidget *parent = nullptr, std::int64_t started = 0);
+    ~MainWindow();
+
+    // milliseconds to each startup step, filled in as they finish
+    QString startup_report() const;
+
+protected:
+
+    void paintEvent(QPaintEvent *event) override;
+
+private slots:
+
+    void ports_changed(const QStringList& added, const QStringList& removed);
+    void add_port_item(const QString& port);
+    void remove_port_item(const QString& port);
+    void close_port(const QString& port);
+    bool is_connected(const QString& port);
+
+    void on_ports_list_itemChanged(QListWidgetItem *item);
+    void on_main_tab_widget_currentChanged(int);
+    void save_command(QString command);
+
+    void send_command(std::uint64_t id);
+    void delete_command(std::uint64_t id);
+    void compact_commands();
+
+    void on_messages_file_button_clicked();
+
+    void on_messages_file_path_textChanged(const QString &arg1);
+
+    void on_replay_button_clicked();
+
+    void on_schedule_button_clicked();
+
+    void on_io_threads_spin_valueChanged(int threads);
+
+private:
+
+    void open_history();
+
+    // reads the library on _library_thread, replaces the one being read
+    void load_library(const QString& path);
+    void stop_library();
+    void library_batch(int generation, const QStringList& commands);
+    void library_loaded(int generation, const QString& path, const CommandJournal::Library& library,
+                        bool ok, const QString& error);
+
+    void startup_step();
+
+    Ui::MainWindow *ui;
+
+    PortWatcher _watcher;
+
+    CommandModel _commands;
+    QSortFilterProxyModel _command_filter;
+    // every edit of _commands is journaled right away, nothing is saved on exit
+    CommandJournal _journal;
+
+    // sent commands, shared by the consoles so every port completes from all of them
+    CommandHistory _history;
+
+    // results of a replaced read still queued carry an older generation
+    std::thread _library_thread;
+    std::atomic<bool> _library_stop;
+    int _library_generation;
+    bool _library_loading;
+    // edits made before the journal is open, applied once it is, deletes by
+    // text since reading the journal can replace the rows and their ids
+    QStringList _pending_saves;
+    QStringList _pending_deletes;
+
+    // monotonic_ns(), -1 until the step is done
+    std::int64_t _started;
+    std::int64_t _first_paint;
+    std::int64_t _ports_ready;
+    std::int64_t _library_ready;
+
+#ifdef Q_OS_LINUX
+    // serves every port when io threads are set, created at startup, outlives the ports
+    std::unique_ptr<PortReactor> _reactor;
+#endif
+    std::vector<std::unique_ptr<PortWorker> > _connected_ports;
+#ifdef Q_OS_UNIX
+    // pseudo terminals playing captured sessions, listed next to real ports
+    std::vector<std::unique_ptr<ReplayEngine> > _replays;
+#endif
+};
+
+#endif // MAINWINDOW_HPP
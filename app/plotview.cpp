@@ -0,0 +1,198 @@
+#include "plotview.hpp"
+
+#include <QColor>
+#include <QLineF>
+#include <QPainter>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+
+#include "monotonicclock.hpp"
+
+namespace
+{
+    const int margin = 4;
+
+    const QColor channel_colors[] = {
+        QColor(38, 139, 210), QColor(220, 50, 47), QColor(133, 153, 0), QColor(181, 137, 0),
+        QColor(108, 113, 196), QColor(42, 161, 152), QColor(203, 75, 22), QColor(211, 54, 130)
+    };
+}
+
+PlotView::PlotView(QWidget *parent) :
+    QWidget(parent), _buffer(nullptr), _labels(), _window(0), _dirty(false), _refresh(), _columns(),
+    _paint_stats{0, 0, 0}
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMinimumHeight(120);
+
+    _refresh.setTimerType(Qt::PreciseTimer);
+    connect(&_refresh, &QTimer::timeout, this, [this]()
+    {
+        if(_dirty)
+        {
+            _dirty = false;
+            update();
+        }
+    });
+    set_refresh_rate(30);
+}
+
+void PlotView::set_buffer(const TelemetryBuffer* buffer)
+{
+    _buffer = buffer;
+    update();
+}
+
+void PlotView::set_labels(const QStringList& labels)
+{
+    _labels = labels;
+    update();
+}
+
+void PlotView::set_window(std::uint64_t samples)
+{
+    _window = samples;
+    update();
+}
+
+std::uint64_t PlotView::window() const
+{
+    return _window;
+}
+
+void PlotView::set_refresh_rate(int fps)
+{
+    _refresh.start(1000 / std::max(1, fps));
+}
+
+void PlotView::data_changed()
+{
+    _dirty = true;
+}
+
+PlotView::PaintStats PlotView::paint_stats() const
+{
+    return _paint_stats;
+}
+
+void PlotView::paintEvent(QPaintEvent *)
+{
+    const std::int64_t start = monotonic_ns();
+
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().base());
+    const QRect area = rect().adjusted(margin, margin, -margin, -margin);
+    const QFontMetrics metrics = fontMetrics();
+
+    if(!_buffer || _buffer->empty() || area.width() < 2 || area.height() < 2)
+    {
+        painter.setPen(palette().color(QPalette::Disabled, QPalette::Text));
+        painter.drawText(area, Qt::AlignCenter, tr("No samples"));
+        return;
+    }
+
+    const std::uint64_t last = _buffer->end();
+    const std::uint64_t first = _window > 0 && last - _buffer->begin() > _window ? last - _window : _buffer->begin();
+    const std::uint64_t samples = last - first;
+    const int channels = _buffer->channels();
+
+    // whole window scaled, the pyramid makes this a few block lookups per channel
+    float low = NAN;
+    float high = NAN;
+    for(int c = 0; c < channels; ++c)
+    {
+        const std::pair<float, float> range = _buffer->range(c, first, last);
+        low = std::fmin(low, range.first);
+        high = std::fmax(high, range.second);
+    }
+    if(std::isnan(low) || std::isnan(high))
+    {
+        painter.setPen(palette().color(QPalette::Disabled, QPalette::Text));
+        painter.drawText(area, Qt::AlignCenter, tr("No numbers"));
+        return;
+    }
+    if(!(high > low))
+    {
+        low -= 1;
+        high += 1;
+    }
+    const double scale = (area.height() - 1) / (static_cast<double>(high) - low);
+    auto to_y = [&](float value)
+    {
+        return area.bottom() - (static_cast<double>(value) - low) * scale;
+    };
+
+    const int pixels = area.width();
+    _columns.resize(static_cast<std::size_t>(channels));
+    QVector<QLineF> lines;
+    for(int c = 0; c < channels; ++c)
+    {
+        lines.clear();
+        if(samples <= static_cast<std::uint64_t>(pixels))
+        {
+            // fewer samples than columns, straight lines between them
+            const double step = samples > 1 ? (pixels - 1) / static_cast<double>(samples - 1) : 0;
+            for(std::uint64_t i = first + 1; i < last; ++i)
+            {
+                const float a = _buffer->at(c, i - 1);
+                const float b = _buffer->at(c, i);
+                if(!std::isnan(a) && !std::isnan(b))
+                {
+                    lines.append(QLineF(area.left() + (i - 1 - first) * step, to_y(a),
+                                        area.left() + (i - first) * step, to_y(b)));
+                }
+            }
+        }
+        else
+        {
+            std::vector<std::pair<float, float> >& columns = _columns[static_cast<std::size_t>(c)];
+            _buffer->decimate(c, first, last, pixels, columns);
+            bool joined = false;
+            double previous_top = 0;
+            double previous_bottom = 0;
+            for(int x = 0; x < pixels; ++x)
+            {
+                const std::pair<float, float>& column = columns[static_cast<std::size_t>(x)];
+                if(std::isnan(column.first))
+                {
+                    joined = false;
+                    continue;
+                }
+                const double top = to_y(column.second);
+                const double bottom = to_y(column.first);
+                // stretched to meet the previous column, steep edges stay connected
+                const double from = joined ? std::min(top, previous_bottom) : top;
+                const double to = joined ? std::max(bottom, previous_top) : bottom;
+                // a flat column still covers one pixel
+                lines.append(QLineF(area.left() + x + 0.5, from, area.left() + x + 0.5, std::max(to, from + 1)));
+                previous_top = top;
+                previous_bottom = bottom;
+                joined = true;
+            }
+        }
+        painter.setPen(channel_colors[c % 8]);
+        painter.drawLines(lines);
+    }
+
+    painter.setPen(palette().color(QPalette::Text));
+    painter.drawText(area, Qt::AlignLeft | Qt::AlignTop, QString::number(high, 'g', 6));
+    painter.drawText(area, Qt::AlignLeft | Qt::AlignBottom, QString::number(low, 'g', 6));
+    painter.drawText(area, Qt::AlignRight | Qt::AlignBottom, tr("%1 samples").arg(samples));
+
+    int x = area.right();
+    for(int c = channels - 1; c >= 0; --c)
+    {
+        const QString label = _labels.value(c, QString::number(c + 1));
+        x -= metrics.horizontalAdvance(label);
+        painter.setPen(channel_colors[c % 8]);
+        painter.drawText(x, area.top() + metrics.ascent(), label);
+        x -= metrics.horizontalAdvance(' ');
+    }
+
+    const std::int64_t duration = monotonic_ns() - start;
+    ++_paint_stats.paints;
+    _paint_stats.time += duration;
+    _paint_stats.max = std::max(_paint_stats.max, duration);
+}
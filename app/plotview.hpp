@@ -0,0 +1,71 @@
+#ifndef PLOTVIEW_HPP
+#define PLOTVIEW_HPP
+
+/*
+Line plot of the telemetry buffer. Every channel is decimated to one min/max
+pair per pixel column and drawn as vertical strokes joined to the previous
+column, a window shorter than the plot is wide is drawn as a polyline
+through the samples. Painting cost follows the width of the widget, not the
+number of samples, and new data only marks the plot dirty, repaints run at
+most at the refresh rate.
+*/
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <QStringList>
+#include <QTimer>
+#include <QWidget>
+
+#include "telemetrybuffer.hpp"
+
+class PlotView : public QWidget
+{
+    Q_OBJECT
+
+public:
+
+    struct PaintStats
+    {
+        std::uint64_t paints;
+        std::int64_t time;      // nanoseconds, all paints together
+        std::int64_t max;       // slowest paint
+    };
+
+    explicit PlotView(QWidget *parent = nullptr);
+
+    // owned by the caller, nullptr shows nothing
+    void set_buffer(const TelemetryBuffer* buffer);
+    // channel names for the legend
+    void set_labels(const QStringList& labels);
+
+    // newest samples shown, 0 for everything retained
+    void set_window(std::uint64_t samples);
+    std::uint64_t window() const;
+
+    void set_refresh_rate(int fps);
+
+    // buffer changed, repainted on the next refresh
+    void data_changed();
+
+    PaintStats paint_stats() const;
+
+protected:
+
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+
+    const TelemetryBuffer* _buffer;
+    QStringList _labels;
+    std::uint64_t _window;
+    bool _dirty;
+    QTimer _refresh;
+
+    std::vector<std::vector<std::pair<float, float> > > _columns;
+
+    PaintStats _paint_stats;
+};
+
+#endif
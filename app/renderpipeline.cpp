@@ -0,0 +1,105 @@
+#include "renderpipeline.hpp"
+
+#include <algorithm>
+
+#include "consoleview.hpp"
+#include "monotonicclock.hpp"
+
+RenderPipeline::RenderPipeline(QObject *parent) :
+    QObject(parent), _view(nullptr), _timer(), _since_flush(),
+    _frame_interval(1000 / 60), _pending(), _pending_bytes(0), _pending_chunks(0)
+{
+    _timer.setSingleShot(true);
+    _timer.setTimerType(Qt::PreciseTimer);
+    connect(&_timer, &QTimer::timeout, this, &RenderPipeline::flush);
+    _since_flush.start();
+}
+
+void RenderPipeline::set_view(ConsoleView* view)
+{
+    _view = view;
+}
+
+void RenderPipeline::set_frame_rate(int fps)
+{
+    _frame_interval = 1000 / std::max(1, fps);
+}
+
+int RenderPipeline::frame_rate() const
+{
+    return 1000 / std::max(1, _frame_interval);
+}
+
+void RenderPipeline::push(const QByteArray& data, const SENDER& sender, std::int64_t timestamp)
+{
+    append(data.constData(), static_cast<std::size_t>(data.size()), sender, timestamp, 0);
+}
+
+void RenderPipeline::push_frame(const char* data, std::size_t size, const SENDER& sender, std::int64_t timestamp, std::uint8_t flags)
+{
+    append(data, size, sender, timestamp, static_cast<std::uint8_t>(flags | ScrollbackBuffer::FRAME));
+}
+
+void RenderPipeline::flush()
+{
+    _timer.stop();
+    _since_flush.restart();
+    if(_pending.empty() || !_view)
+    {
+        return;
+    }
+
+    FlushStats stats{_pending_bytes, _pending_chunks, _pending.size(), 0};
+    std::vector<Block> blocks;
+    blocks.swap(_pending);
+    _pending_bytes = 0;
+    _pending_chunks = 0;
+
+    const std::int64_t start = monotonic_ns();
+    for(const Block& block : blocks)
+    {
+        _view->append_pieces(block.data, block.pieces, block.sender);
+    }
+    stats.duration = monotonic_ns() - start;
+
+    emit flushed(stats);
+}
+
+void RenderPipeline::clear()
+{
+    _timer.stop();
+    _pending.clear();
+    _pending_bytes = 0;
+    _pending_chunks = 0;
+}
+
+void RenderPipeline::append(const char* data, std::size_t size, const SENDER& sender, std::int64_t timestamp, std::uint8_t flags)
+{
+    if(size == 0)
+    {
+        return;
+    }
+
+    if(_pending.empty() || _pending.back().sender != sender)
+    {
+        _pending.push_back(Block{QByteArray(), sender, {}});
+    }
+    Block& block = _pending.back();
+    block.data.append(data, static_cast<int>(size));
+    block.pieces.push_back(ConsoleView::Piece{static_cast<std::uint32_t>(block.data.size()), flags, timestamp});
+    _pending_bytes += size;
+    ++_pending_chunks;
+
+    schedule();
+}
+
+void RenderPipeline::schedule()
+{
+    if(_timer.isActive())
+    {
+        return;
+    }
+    // first chunk after a quiet period is shown right away, bursts wait for the next frame
+    const qint64 elapsed = _since_flush.elapsed();
+    _timer.start(static_cast<int>(std::max<qint64>(0, _frame_interval - elapsed)));
+}
@@ -0,0 +1,81 @@
+#ifndef RENDERPIPELINE_HPP
+#define RENDERPIPELINE_HPP
+
+/*
+Collects console traffic and hands it to the view at most once per display
+frame. Consecutive chunks from the same sender are merged into one block,
+so a burst of readyRead callbacks costs a single index update and repaint.
+Every chunk keeps its own timestamp within the block.
+*/
+
+#include <cstdint>
+#include <vector>
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QTimer>
+
+#include "sender.hpp"
+#include "consoleview.hpp"
+
+class RenderPipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    struct FlushStats
+    {
+        std::uint64_t bytes;    // bytes handed to the view
+        std::uint64_t chunks;   // chunks merged into this flush
+        std::uint64_t blocks;   // sender blocks left after merging
+        std::int64_t duration;  // nanoseconds spent in the view
+    };
+
+signals:
+
+    void flushed(const RenderPipeline::FlushStats& stats);
+
+public:
+
+    explicit RenderPipeline(QObject *parent = nullptr);
+
+    void set_view(ConsoleView* view);
+
+    // upper limit of flushes per second
+    void set_frame_rate(int fps);
+    int frame_rate() const;
+
+    void push(const QByteArray& data, const SENDER& sender, std::int64_t timestamp);
+    // whole frame, kept apart from its neighbours, flags from ScrollbackBuffer::CHUNK_FLAG
+    void push_frame(const char* data, std::size_t size, const SENDER& sender, std::int64_t timestamp, std::uint8_t flags);
+    void flush();
+    void clear();
+
+private:
+
+    struct Block
+    {
+        QByteArray data;
+        SENDER sender;
+        std::vector<ConsoleView::Piece> pieces;     // one per pushed chunk
+    };
+
+    void append(const char* data, std::size_t size, const SENDER& sender, std::int64_t timestamp, std::uint8_t flags);
+
+    void schedule();
+
+    ConsoleView* _view;
+    QTimer _timer;
+    QElapsedTimer _since_flush;
+    int _frame_interval;
+
+    std::vector<Block> _pending;
+    std::uint64_t _pending_bytes;
+    std::uint64_t _pending_chunks;
+};
+
+Q_DECLARE_METATYPE(RenderPipeline::FlushStats)
+
+#endif
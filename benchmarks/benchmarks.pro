@@ -0,0 +1,8 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    hexformatter \
+    textdecoder
+
+unix: SUBDIRS += loopback
+linux: SUBDIRS += portscaling
@@ -0,0 +1,11 @@
+# Helpers shared by the pty benchmarks, include from a benchmark project:
+#     include(../common/common.pri)
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += \
+    $$PWD/ptyrun.cpp
+
+HEADERS += \
+    $$PWD/ptyrun.hpp
@@ -0,0 +1,49 @@
+#include "ptyrun.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+QByteArray line_payload(int size)
+{
+    QByteArray payload(size, Qt::Uninitialized);
+    for(int i = 0; i < payload.size(); ++i)
+    {
+        payload[i] = static_cast<char>('A' + i % 26);
+    }
+    payload[payload.size() - 1] = '\n';
+    return payload;
+}
+
+int open_pty_master(QString& name, QString& error)
+{
+    const int master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if(master < 0 || grantpt(master) != 0 || unlockpt(master) != 0 || !ptsname(master))
+    {
+        error = QString::fromLocal8Bit(std::strerror(errno));
+        if(master >= 0)
+        {
+            ::close(master);
+        }
+        return -1;
+    }
+    name = QString::fromLocal8Bit(ptsname(master));
+    return master;
+}
+
+double cpu_seconds(const rusage& usage)
+{
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+double thread_cpu_seconds()
+{
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_nsec) / 1e9;
+}
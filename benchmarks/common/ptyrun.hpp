@@ -0,0 +1,32 @@
+#ifndef PTYRUN_HPP
+#define PTYRUN_HPP
+
+/*
+Pieces shared by the benchmarks that drive ports through a pty: the
+payload, opening the pty master and CPU time of the process and threads.
+*/
+
+#include <cstdint>
+
+#include <sys/resource.h>
+
+#include <QByteArray>
+#include <QString>
+
+// how long a finished run waits for data still in flight
+const std::int64_t drain_timeout = 2000000000;
+
+// milliseconds a producer thread waits in poll() before checking whether to stop
+const int poll_timeout = 50;
+
+// printable lines, so text mode splits them like real traffic
+QByteArray line_payload(int size);
+
+// nonblocking master, -1 with error set on failure
+int open_pty_master(QString& name, QString& error);
+
+double cpu_seconds(const rusage& usage);
+// of the calling thread
+double thread_cpu_seconds();
+
+#endif
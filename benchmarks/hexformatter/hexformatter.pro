@@ -0,0 +1,22 @@
+#-------------------------------------------------
+#
+# Hex display formatter throughput, table driven formatter against the
+# original per byte QString loop
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = hexformatter_benchmark
+TEMPLATE = app
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+        main.cpp
+
+include(../../core/core.pri)
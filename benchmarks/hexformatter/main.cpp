@@ -0,0 +1,97 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include <cctype>
+#include <vector>
+
+#include "hexformatter.hpp"
+
+/*
+Hex mode formatting throughput on a single core. The legacy loop is the one
+ComPortConsole::new_message used before HexFormatter, kept here verbatim.
+*/
+
+namespace
+{
+    QString legacy_format(const QByteArray& array, bool protect_alphanumeric, bool protect_extended)
+    {
+        QString message;
+        for(const auto& byte : array)
+        {
+            if(isalnum(byte) && protect_alphanumeric)
+            {
+                message += QChar::fromLatin1(byte);
+            }
+            else if(byte >= 33 && byte <= 126 && protect_extended)
+            {
+                message += QChar::fromLatin1(byte);
+            }
+            else
+            {
+                message += " 0x";
+                message += QString::number(byte, 16).right(2);
+                message += " ";
+            }
+        }
+        return message;
+    }
+
+    double megabytes_per_second(qint64 bytes, qint64 nanoseconds)
+    {
+        return static_cast<double>(bytes) * 1000.0 / static_cast<double>(nanoseconds);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QTextStream out(stdout);
+
+    // mixed traffic, mostly printable with binary bytes in between
+    QByteArray input(4 * 1024 * 1024, Qt::Uninitialized);
+    for(int i = 0; i < input.size(); ++i)
+    {
+        input[i] = static_cast<char>(i % 7 == 0 ? (i * 131) & 0xFF : 'A' + i % 26);
+    }
+
+    const int legacy_rounds = 2;
+    const int table_rounds = 50;
+
+    out << "protect_alphanumeric,protect_extended,legacy_mb_s,table_mb_s,speedup\n";
+    for(int mode = 0; mode < 4; ++mode)
+    {
+        const bool protect_alphanumeric = mode & 1;
+        const bool protect_extended = mode & 2;
+
+        QElapsedTimer timer;
+        timer.start();
+        int legacy_length = 0;
+        for(int round = 0; round < legacy_rounds; ++round)
+        {
+            legacy_length += legacy_format(input, protect_alphanumeric, protect_extended).size();
+        }
+        const double legacy = megabytes_per_second(static_cast<qint64>(input.size()) * legacy_rounds, timer.nsecsElapsed());
+
+        HexFormatter formatter(protect_alphanumeric, protect_extended);
+        std::vector<char> buffer(HexFormatter::output_capacity(static_cast<std::size_t>(input.size())));
+        timer.restart();
+        std::size_t table_length = 0;
+        for(int round = 0; round < table_rounds; ++round)
+        {
+            table_length += formatter.format(input.constData(), static_cast<std::size_t>(input.size()), buffer.data());
+        }
+        const double table = megabytes_per_second(static_cast<qint64>(input.size()) * table_rounds, timer.nsecsElapsed());
+
+        // keep results observable so neither loop is optimised away
+        if(legacy_length == 0 || table_length == 0)
+        {
+            return 1;
+        }
+
+        out << static_cast<int>(protect_alphanumeric) << "," << static_cast<int>(protect_extended) << ","
+            << legacy << "," << table << "," << table / legacy << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,40 @@
+#-------------------------------------------------
+#
+# Console throughput and latency over a pty loopback. Builds the real
+# console widget, run with QT_QPA_PLATFORM=offscreen on machines without
+# a display.
+#
+#-------------------------------------------------
+
+QT       += core gui widgets serialport
+
+TARGET = loopback_benchmark
+TEMPLATE = app
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+!unix: error("loopback benchmark needs a pty")
+
+INCLUDEPATH += ../../app
+
+SOURCES += \
+        main.cpp \
+    loopbackrun.cpp \
+    ../../app/comportconsole.cpp \
+    ../../app/consoleview.cpp \
+    ../../app/renderpipeline.cpp
+
+HEADERS += \
+    loopbackrun.hpp \
+    ../../app/comportconsole.hpp \
+    ../../app/consoleview.hpp \
+    ../../app/renderpipeline.hpp
+
+FORMS += \
+    ../../app/comportconsole.ui
+
+include(../common/common.pri)
+include(../../core/core.pri)
@@ -0,0 +1,322 @@
+#include "loopbackrun.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QCoreApplication>
+#include <QEvent>
+#include <QRadioButton>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "consoleview.hpp"
+#include "monotonicclock.hpp"
+#include "ptyrun.hpp"
+
+namespace
+{
+    // sample storage is allocated up front, a run ends early when it is full
+    const std::size_t max_chunks = 4 * 1024 * 1024;
+
+    // unsent data allowed between user and device, keeps TX from queueing up seconds of data
+    const std::size_t tx_window = 1024 * 1024;
+}
+
+LoopbackRun::LoopbackRun(const Settings& settings, QObject *parent) :
+    QObject(parent), _settings(settings), _error(), _master(-1), _slave(-1),
+    _port(), _console(), _view(nullptr), _payload(), _user_payload(),
+    _sent(), _sent_count(0), _done_count(0), _latencies(), _start(0), _last_delivery(0),
+    _thread(), _producing(false), _running(false), _producer_done(false), _thread_cpu(0),
+    _loop(), _send_timer(), _done_timer(), _drain_deadline(0)
+{
+    _settings.chunk_size = std::max(1, _settings.chunk_size);
+
+    _payload = line_payload(_settings.chunk_size);
+    _user_payload = QString::fromLatin1(_payload);
+
+    std::size_t chunks = max_chunks;
+    if(_settings.rate > 0)
+    {
+        const qint64 expected = _settings.rate * _settings.duration / 1000 / _settings.chunk_size + 2;
+        chunks = std::min(chunks, static_cast<std::size_t>(expected));
+    }
+    _sent.resize(chunks);
+    _latencies.reserve(chunks);
+
+    _send_timer.setTimerType(Qt::PreciseTimer);
+    _send_timer.setInterval(1);
+    connect(&_send_timer, &QTimer::timeout, this, &LoopbackRun::send_user);
+
+    _done_timer.setInterval(5);
+    connect(&_done_timer, &QTimer::timeout, this, &LoopbackRun::check_done);
+}
+
+LoopbackRun::~LoopbackRun()
+{
+    _producing = false;
+    _running = false;
+    if(_thread.joinable())
+    {
+        _thread.join();
+    }
+    _console.reset();
+    _port.reset();
+    if(_slave >= 0)
+    {
+        ::close(_slave);
+    }
+    if(_master >= 0)
+    {
+        ::close(_master);
+    }
+}
+
+bool LoopbackRun::open()
+{
+    QString name;
+    _master = open_pty_master(name, _error);
+    if(_master < 0)
+    {
+        return false;
+    }
+
+    _slave = ::open(name.toLocal8Bit().constData(), O_RDWR | O_NOCTTY);
+    if(_slave < 0)
+    {
+        _error = QString::fromLocal8Bit(std::strerror(errno));
+        return false;
+    }
+    termios attributes;
+    if(tcgetattr(_slave, &attributes) == 0)
+    {
+        cfmakeraw(&attributes);
+        tcsetattr(_slave, TCSANOW, &attributes);
+    }
+
+    _port.reset(new PortWorker(name));
+    if(!_port->open())
+    {
+        _error = QString("Could not open %1").arg(name);
+        return false;
+    }
+
+    _console.reset(new ComPortConsole());
+    _console->resize(1280, 800);
+    _console->set_port(_port.get());
+
+    // frame messages exactly as given, so byte counts line up with chunks
+    _console->findChild<QRadioButton*>("line_ending_none")->setChecked(true);
+    _console->findChild<QComboBox*>("checksum_combo")->setCurrentIndex(0);
+    _console->findChild<QCheckBox*>("add_dollar_checkbox")->setChecked(false);
+    _console->findChild<QCheckBox*>("communication_hex_mode")->setChecked(_settings.hex_mode);
+
+    _view = _console->findChild<ConsoleView*>("message_history");
+    _view->viewport()->installEventFilter(this);
+    _console->show();
+    QCoreApplication::processEvents();
+    return true;
+}
+
+LoopbackRun::Result LoopbackRun::run()
+{
+    rusage before;
+    getrusage(RUSAGE_SELF, &before);
+
+    _start = monotonic_ns();
+    _last_delivery = _start;
+    _producing = true;
+    _running = true;
+    if(_settings.direction == DIRECTION::RX)
+    {
+        _thread = std::thread(&LoopbackRun::write_device, this);
+    }
+    else
+    {
+        _thread = std::thread(&LoopbackRun::read_device, this);
+        _send_timer.start();
+    }
+
+    QTimer::singleShot(_settings.duration, this, &LoopbackRun::stop_producing);
+    _loop.exec();
+
+    _running = false;
+    _thread.join();
+
+    rusage after;
+    getrusage(RUSAGE_SELF, &after);
+
+    Result result;
+    result.bytes = static_cast<std::uint64_t>(_latencies.size()) * static_cast<std::uint64_t>(_settings.chunk_size);
+    result.seconds = static_cast<double>(_last_delivery - _start) / 1e9;
+    result.latencies = std::move(_latencies);
+    std::sort(result.latencies.begin(), result.latencies.end());
+    result.cpu_seconds = cpu_seconds(after) - cpu_seconds(before) - _thread_cpu;
+#ifdef Q_OS_MACOS
+    result.peak_rss_kb = after.ru_maxrss / 1024;
+#else
+    result.peak_rss_kb = after.ru_maxrss;
+#endif
+    return result;
+}
+
+QString LoopbackRun::error_string() const
+{
+    return _error;
+}
+
+bool LoopbackRun::eventFilter(QObject *obj, QEvent *event)
+{
+    if(_settings.direction == DIRECTION::RX && event->type() == QEvent::Paint)
+    {
+        const std::uint64_t delivered = _view->buffer().end_offset();
+        const std::size_t sent = _sent_count.load(std::memory_order_acquire);
+        std::size_t done = _done_count.load(std::memory_order_relaxed);
+        const std::int64_t now = monotonic_ns();
+        while(done < sent && (done + 1) * static_cast<std::uint64_t>(_settings.chunk_size) <= delivered)
+        {
+            _latencies.push_back(now - _sent[done]);
+            ++done;
+            _last_delivery = now;
+        }
+        _done_count.store(done, std::memory_order_relaxed);
+    }
+    return QObject::eventFilter(obj, event);
+}
+
+void LoopbackRun::write_device()
+{
+    using clock = std::chrono::steady_clock;
+    const clock::time_point start = clock::now();
+
+    std::size_t count = 0;
+    while(_producing && count < _sent.size())
+    {
+        if(_settings.rate > 0)
+        {
+            const auto offset = std::chrono::nanoseconds(
+                        static_cast<std::int64_t>(count) * _settings.chunk_size * 1000000000 / _settings.rate);
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<clock::duration>(offset));
+        }
+
+        _sent[count] = monotonic_ns();
+        ++count;
+        _sent_count.store(count, std::memory_order_release);
+
+        const char* data = _payload.constData();
+        std::size_t left = static_cast<std::size_t>(_payload.size());
+        while(left > 0 && _running)
+        {
+            const ssize_t written = ::write(_master, data, left);
+            if(written > 0)
+            {
+                data += written;
+                left -= static_cast<std::size_t>(written);
+            }
+            else if(written < 0 && errno != EAGAIN && errno != EINTR)
+            {
+                _running = false;
+            }
+            else
+            {
+                pollfd descriptor = {_master, POLLOUT, 0};
+                poll(&descriptor, 1, poll_timeout);
+            }
+        }
+    }
+    _producer_done = true;
+    _thread_cpu = thread_cpu_seconds();
+}
+
+void LoopbackRun::read_device()
+{
+    std::vector<char> buffer(64 * 1024);
+    std::uint64_t received = 0;
+    std::size_t done = 0;
+
+    while(_running)
+    {
+        pollfd descriptor = {_master, POLLIN, 0};
+        if(poll(&descriptor, 1, poll_timeout) <= 0)
+        {
+            continue;
+        }
+        const ssize_t size = ::read(_master, buffer.data(), buffer.size());
+        if(size <= 0)
+        {
+            continue;
+        }
+        received += static_cast<std::uint64_t>(size);
+
+        const std::int64_t now = monotonic_ns();
+        const std::size_t sent = _sent_count.load(std::memory_order_acquire);
+        while(done < sent && (done + 1) * static_cast<std::uint64_t>(_settings.chunk_size) <= received)
+        {
+            _latencies.push_back(now - _sent[done]);
+            ++done;
+            _last_delivery = now;
+        }
+        _done_count.store(done, std::memory_order_release);
+    }
+    _thread_cpu = thread_cpu_seconds();
+}
+
+void LoopbackRun::send_user()
+{
+    std::size_t target = _sent.size();
+    if(_settings.rate > 0)
+    {
+        const double elapsed = static_cast<double>(monotonic_ns() - _start) / 1e9;
+        target = std::min(target, static_cast<std::size_t>(elapsed * static_cast<double>(_settings.rate) / _settings.chunk_size) + 1);
+    }
+    const std::size_t window = std::max<std::size_t>(1, tx_window / static_cast<std::size_t>(_settings.chunk_size));
+
+    std::size_t count = _sent_count.load(std::memory_order_relaxed);
+    while(_producing && count < target && count - _done_count.load(std::memory_order_acquire) < window)
+    {
+        _sent[count] = monotonic_ns();
+        _sent_count.store(count + 1, std::memory_order_release);
+        if(!_console->send_message(_user_payload))
+        {
+            // TX queue at its high-water mark, nothing went out, retried on the next tick
+            _sent_count.store(count, std::memory_order_release);
+            break;
+        }
+        ++count;
+    }
+    if(count == _sent.size())
+    {
+        stop_producing();
+    }
+}
+
+void LoopbackRun::stop_producing()
+{
+    if(!_producing)
+    {
+        return;
+    }
+    _producing = false;
+    _send_timer.stop();
+    _producer_done = _settings.direction == DIRECTION::TX;
+    _drain_deadline = monotonic_ns() + drain_timeout;
+    _done_timer.start();
+}
+
+void LoopbackRun::check_done()
+{
+    const bool drained = _producer_done &&
+            _done_count.load(std::memory_order_acquire) == _sent_count.load(std::memory_order_acquire);
+    if(drained || monotonic_ns() > _drain_deadline)
+    {
+        _done_timer.stop();
+        _loop.quit();
+    }
+}
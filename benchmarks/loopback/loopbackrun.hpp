@@ -0,0 +1,112 @@
+#ifndef LOOPBACKRUN_HPP
+#define LOOPBACKRUN_HPP
+
+/*
+One benchmark run: a real ComPortConsole connected to the slave side of a
+pty, the test plays the device on the master side. RX latency runs from the
+master write to the first paint of the view that contains the chunk, TX
+latency from send_message() to the bytes arriving on the master. CPU time
+excludes the thread playing the device.
+*/
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <QObject>
+#include <QEventLoop>
+#include <QTimer>
+
+#include "portworker.hpp"
+#include "comportconsole.hpp"
+
+class ConsoleView;
+
+class LoopbackRun : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    enum class DIRECTION
+    {
+        RX = 0,
+        TX
+    };
+
+    struct Settings
+    {
+        DIRECTION direction;
+        bool hex_mode;
+        int chunk_size;
+        qint64 rate;        // bytes per second, 0 is unlimited
+        int duration;       // milliseconds
+    };
+
+    struct Result
+    {
+        std::uint64_t bytes;
+        double seconds;
+        std::vector<std::int64_t> latencies;    // nanoseconds, sorted
+        double cpu_seconds;
+        long peak_rss_kb;
+    };
+
+    explicit LoopbackRun(const Settings& settings, QObject *parent = nullptr);
+    ~LoopbackRun() override;
+
+    bool open();
+    Result run();
+
+    QString error_string() const;
+
+protected:
+
+    bool eventFilter(QObject *obj, QEvent *event) override;
+
+private:
+
+    // device thread
+    void write_device();
+    void read_device();
+
+    // GUI thread
+    void send_user();
+    void stop_producing();
+    void check_done();
+
+    Settings _settings;
+    QString _error;
+
+    int _master;
+    int _slave;
+    std::unique_ptr<PortWorker> _port;
+    std::unique_ptr<ComPortConsole> _console;
+    ConsoleView* _view;
+
+    QByteArray _payload;
+    QString _user_payload;
+
+    // send time per chunk, written before the count is published
+    std::vector<std::int64_t> _sent;
+    std::atomic<std::size_t> _sent_count;
+    std::atomic<std::size_t> _done_count;
+    std::vector<std::int64_t> _latencies;
+    std::int64_t _start;
+    std::int64_t _last_delivery;
+
+    std::thread _thread;
+    std::atomic<bool> _producing;
+    std::atomic<bool> _running;
+    std::atomic<bool> _producer_done;
+    double _thread_cpu;
+
+    QEventLoop _loop;
+    QTimer _send_timer;
+    QTimer _done_timer;
+    std::int64_t _drain_deadline;
+};
+
+#endif
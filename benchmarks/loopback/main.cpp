@@ -0,0 +1,106 @@
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+
+#include <cstdint>
+#include <vector>
+
+#include "loopbackrun.hpp"
+
+/*
+End to end throughput and latency of the console over a pty loopback. Every
+combination of direction, display mode and chunk size is one CSV row.
+peak_rss_kb is the process high water mark, so it never goes down between
+rows; run a single combination for an isolated figure.
+
+    QT_QPA_PLATFORM=offscreen ./loopback_benchmark --direction rx --mode hex
+*/
+
+namespace
+{
+    double percentile_us(const std::vector<std::int64_t>& sorted, double percentile)
+    {
+        if(sorted.empty())
+        {
+            return 0;
+        }
+        const std::size_t index = static_cast<std::size_t>(percentile * static_cast<double>(sorted.size() - 1));
+        return static_cast<double>(sorted[index]) / 1000.0;
+    }
+
+    QStringList choices(const QString& value, const QStringList& all)
+    {
+        return value == "both" ? all : QStringList(value);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication a(argc, argv);
+
+    // keep the console settings of the real application untouched
+    QCoreApplication::setOrganizationName("Vernocte laboratories");
+    QCoreApplication::setOrganizationDomain("vernocte.org");
+    QCoreApplication::setApplicationName("Serial Port Commander Benchmark");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Console throughput and latency over a pty loopback, CSV on stdout.");
+    parser.addHelpOption();
+
+    const QCommandLineOption direction_option("direction", "rx, tx or both.", "direction", "both");
+    const QCommandLineOption mode_option("mode", "Display mode: text, hex or both.", "mode", "both");
+    const QCommandLineOption chunk_option("chunk", "Comma separated chunk sizes in bytes.", "sizes", "16,256,4096");
+    const QCommandLineOption rate_option("rate", "Offered load in bytes per second, 0 is unlimited.", "bytes", "0");
+    const QCommandLineOption duration_option("duration", "Seconds per run.", "seconds", "3");
+    parser.addOptions({direction_option, mode_option, chunk_option, rate_option, duration_option});
+    parser.process(a);
+
+    const QStringList directions = choices(parser.value(direction_option), {"rx", "tx"});
+    const QStringList modes = choices(parser.value(mode_option), {"text", "hex"});
+    const QStringList chunks = parser.value(chunk_option).split(',', Qt::SkipEmptyParts);
+    const qint64 rate = parser.value(rate_option).toLongLong();
+    const int duration = static_cast<int>(parser.value(duration_option).toDouble() * 1000);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    out << "direction,mode,chunk_size,rate_limit,bytes,seconds,bytes_per_s,chunks,"
+           "p50_us,p90_us,p99_us,max_us,cpu_s,peak_rss_kb\n";
+    out.flush();
+
+    int failures = 0;
+    for(const QString& direction : directions)
+    {
+        for(const QString& mode : modes)
+        {
+            for(const QString& chunk : chunks)
+            {
+                LoopbackRun::Settings settings;
+                settings.direction = direction == "tx" ? LoopbackRun::DIRECTION::TX : LoopbackRun::DIRECTION::RX;
+                settings.hex_mode = mode == "hex";
+                settings.chunk_size = chunk.toInt();
+                settings.rate = rate;
+                settings.duration = duration;
+
+                LoopbackRun run(settings);
+                if(!run.open())
+                {
+                    err << direction << " " << mode << " " << chunk << ": " << run.error_string() << "\n";
+                    ++failures;
+                    continue;
+                }
+                const LoopbackRun::Result result = run.run();
+                const double bytes_per_s = result.seconds > 0 ? static_cast<double>(result.bytes) / result.seconds : 0;
+
+                out << direction << "," << mode << "," << settings.chunk_size << "," << rate << ","
+                    << result.bytes << "," << result.seconds << "," << bytes_per_s << "," << result.latencies.size() << ","
+                    << percentile_us(result.latencies, 0.5) << "," << percentile_us(result.latencies, 0.9) << ","
+                    << percentile_us(result.latencies, 0.99) << "," << percentile_us(result.latencies, 1.0) << ","
+                    << result.cpu_seconds << "," << result.peak_rss_kb << "\n";
+                out.flush();
+            }
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}
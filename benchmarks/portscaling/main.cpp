@@ -0,0 +1,94 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+
+#include "scalingrun.hpp"
+
+/*
+Aggregate throughput and CPU use of the port I/O engines as the number of
+ports grows. Every combination of port count and I/O threads is one CSV
+row, io_threads 0 is the thread per port QSerialPort backend, anything
+else a PortReactor with that many threads. The default rate is what a
+port at 115200 baud carries, use --rate 0 to find the ceiling.
+
+    ./portscaling_benchmark --ports 1,8,32,64 --io-threads 0,1,2
+*/
+
+namespace
+{
+    QList<int> numbers(const QString& value)
+    {
+        QList<int> result;
+        for(const QString& item : value.split(',', Qt::SkipEmptyParts))
+        {
+            result.append(item.toInt());
+        }
+        return result;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Port I/O engine scaling over pty pairs, CSV on stdout.");
+    parser.addHelpOption();
+
+    const QCommandLineOption ports_option("ports", "Comma separated port counts.", "counts", "1,4,16,32,64");
+    const QCommandLineOption threads_option("io-threads", "Comma separated I/O thread counts, 0 is a thread per port.", "counts", "0,1,2");
+    const QCommandLineOption rate_option("rate", "Offered load per port in bytes per second, 0 is unlimited.", "bytes", "11520");
+    const QCommandLineOption chunk_option("chunk", "Bytes per device write.", "bytes", "64");
+    const QCommandLineOption duration_option("duration", "Seconds per run.", "seconds", "3");
+    parser.addOptions({ports_option, threads_option, rate_option, chunk_option, duration_option});
+    parser.process(a);
+
+    const QList<int> port_counts = numbers(parser.value(ports_option));
+    const QList<int> thread_counts = numbers(parser.value(threads_option));
+    const qint64 rate = parser.value(rate_option).toLongLong();
+    const int chunk = parser.value(chunk_option).toInt();
+    const int duration = static_cast<int>(parser.value(duration_option).toDouble() * 1000);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    out << "io_threads,ports,rate_per_port,chunk_size,written,received,seconds,bytes_per_s,"
+           "cpu_s,cpu_percent,cpu_us_per_kb,wakeups,events_per_wakeup\n";
+    out.flush();
+
+    int failures = 0;
+    for(const int threads : thread_counts)
+    {
+        for(const int ports : port_counts)
+        {
+            ScalingRun::Settings settings;
+            settings.ports = ports;
+            settings.io_threads = threads;
+            settings.rate = rate;
+            settings.chunk_size = chunk;
+            settings.duration = duration;
+
+            ScalingRun run(settings);
+            if(!run.open())
+            {
+                err << threads << " threads, " << ports << " ports: " << run.error_string() << "\n";
+                ++failures;
+                continue;
+            }
+            const ScalingRun::Result result = run.run();
+            const double bytes_per_s = result.seconds > 0 ? static_cast<double>(result.received) / result.seconds : 0;
+            const double cpu_percent = result.seconds > 0 ? result.cpu_seconds / result.seconds * 100 : 0;
+            const double cpu_us_per_kb = result.received > 0 ? result.cpu_seconds * 1e6 / (static_cast<double>(result.received) / 1024) : 0;
+            const double events_per_wakeup = result.reactor.wakeups > 0 ?
+                        static_cast<double>(result.reactor.events) / static_cast<double>(result.reactor.wakeups) : 0;
+
+            out << threads << "," << ports << "," << rate << "," << chunk << ","
+                << result.written << "," << result.received << "," << result.seconds << "," << bytes_per_s << ","
+                << result.cpu_seconds << "," << cpu_percent << "," << cpu_us_per_kb << ","
+                << result.reactor.wakeups << "," << events_per_wakeup << "\n";
+            out.flush();
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,29 @@
+#-------------------------------------------------
+#
+# Throughput and CPU use of the port I/O engines over many pty pairs,
+# a thread per port against the epoll reactor.
+#
+#-------------------------------------------------
+
+QT       += core serialport
+QT       -= gui
+
+TARGET = portscaling_benchmark
+TEMPLATE = app
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+!linux: error("port scaling benchmark needs epoll")
+
+SOURCES += \
+        main.cpp \
+    scalingrun.cpp
+
+HEADERS += \
+    scalingrun.hpp
+
+include(../common/common.pri)
+include(../../core/core.pri)
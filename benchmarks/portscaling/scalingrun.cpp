@@ -0,0 +1,205 @@
+#include "scalingrun.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#include <poll.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "monotonicclock.hpp"
+#include "ptyrun.hpp"
+#include "reactorbackend.hpp"
+
+namespace
+{
+    // chunks written to one port before moving to the next while unlimited
+    const std::uint64_t burst = 16;
+}
+
+ScalingRun::ScalingRun(const Settings& settings, QObject *parent) :
+    QObject(parent), _settings(settings), _error(), _masters(), _reactor(), _ports(),
+    _payload(), _received(0), _written(0), _start(0), _last_delivery(0),
+    _thread(), _producing(false), _producer_done(false), _thread_cpu(0),
+    _loop(), _done_timer(), _drain_deadline(0)
+{
+    _settings.ports = std::max(1, _settings.ports);
+    _settings.chunk_size = std::max(1, _settings.chunk_size);
+
+    _payload = line_payload(_settings.chunk_size);
+
+    _done_timer.setInterval(5);
+    connect(&_done_timer, &QTimer::timeout, this, &ScalingRun::check_done);
+}
+
+ScalingRun::~ScalingRun()
+{
+    _producing = false;
+    if(_thread.joinable())
+    {
+        _thread.join();
+    }
+    // workers go before the reactor serving them
+    _ports.clear();
+    _reactor.reset();
+    for(const int master : _masters)
+    {
+        ::close(master);
+    }
+}
+
+bool ScalingRun::open()
+{
+    if(_settings.io_threads > 0)
+    {
+        _reactor = std::make_unique<PortReactor>(_settings.io_threads);
+    }
+
+    for(int i = 0; i < _settings.ports; ++i)
+    {
+        QString name;
+        const int master = open_pty_master(name, _error);
+        if(master < 0)
+        {
+            return false;
+        }
+        _masters.push_back(master);
+
+        if(_reactor)
+        {
+            _ports.emplace_back(std::make_unique<PortWorker>(std::make_unique<ReactorBackend>(name, _reactor.get())));
+        }
+        else
+        {
+            _ports.emplace_back(std::make_unique<PortWorker>(name));
+        }
+        PortWorker* port = _ports.back().get();
+        if(!port->open())
+        {
+            _error = QString("Could not open %1").arg(name);
+            return false;
+        }
+        connect(port, &PortWorker::received, this, [this, port]()
+        {
+            drain(port);
+        });
+    }
+    return true;
+}
+
+ScalingRun::Result ScalingRun::run()
+{
+    rusage before;
+    getrusage(RUSAGE_SELF, &before);
+
+    _start = monotonic_ns();
+    _last_delivery = _start;
+    _producing = true;
+    _thread = std::thread(&ScalingRun::write_devices, this);
+
+    QTimer::singleShot(_settings.duration, this, &ScalingRun::stop_producing);
+    _loop.exec();
+
+    _producing = false;
+    _thread.join();
+
+    rusage after;
+    getrusage(RUSAGE_SELF, &after);
+
+    Result result;
+    result.written = _written;
+    result.received = _received;
+    result.seconds = static_cast<double>(_last_delivery - _start) / 1e9;
+    result.cpu_seconds = cpu_seconds(after) - cpu_seconds(before) - _thread_cpu;
+    result.reactor = _reactor ? _reactor->stats() : PortReactor::Stats{0, 0, 0};
+    return result;
+}
+
+QString ScalingRun::error_string() const
+{
+    return _error;
+}
+
+void ScalingRun::write_devices()
+{
+    using clock = std::chrono::steady_clock;
+    const clock::time_point start = clock::now();
+
+    const std::size_t ports = _masters.size();
+    const std::size_t chunk = static_cast<std::size_t>(_payload.size());
+    std::vector<std::uint64_t> chunks(ports, 0);
+    // bytes of the current chunk already written, a pty may take part of it
+    std::vector<std::size_t> offsets(ports, 0);
+    std::vector<pollfd> descriptors(ports);
+
+    while(_producing)
+    {
+        const std::int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+        bool progress = false;
+        for(std::size_t i = 0; i < ports && _producing; ++i)
+        {
+            const std::uint64_t due = _settings.rate > 0 ?
+                        static_cast<std::uint64_t>(_settings.rate * elapsed / 1000000000 / _settings.chunk_size) :
+                        chunks[i] + burst;
+            while(chunks[i] < due)
+            {
+                const ssize_t written = ::write(_masters[i], _payload.constData() + offsets[i], chunk - offsets[i]);
+                if(written <= 0)
+                {
+                    // device buffer full, the port is behind, retried next round
+                    break;
+                }
+                progress = true;
+                _written.fetch_add(static_cast<std::uint64_t>(written), std::memory_order_relaxed);
+                offsets[i] += static_cast<std::size_t>(written);
+                if(offsets[i] == chunk)
+                {
+                    offsets[i] = 0;
+                    ++chunks[i];
+                }
+            }
+        }
+
+        if(_settings.rate > 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        else if(!progress)
+        {
+            for(std::size_t i = 0; i < ports; ++i)
+            {
+                descriptors[i] = pollfd{_masters[i], POLLOUT, 0};
+            }
+            poll(descriptors.data(), static_cast<nfds_t>(ports), poll_timeout);
+        }
+    }
+    _thread_cpu = thread_cpu_seconds();
+    _producer_done = true;
+}
+
+void ScalingRun::drain(PortWorker* port)
+{
+    PortWorker::Chunk chunk;
+    while(port->pop(chunk))
+    {
+        _received += static_cast<std::uint64_t>(chunk.data.size());
+        _last_delivery = chunk.timestamp;
+    }
+}
+
+void ScalingRun::stop_producing()
+{
+    _producing = false;
+    _drain_deadline = monotonic_ns() + drain_timeout;
+    _done_timer.start();
+}
+
+void ScalingRun::check_done()
+{
+    const bool drained = _producer_done && _received == _written.load();
+    if(drained || monotonic_ns() > _drain_deadline)
+    {
+        _done_timer.stop();
+        _loop.quit();
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef SCALINGRUN_HPP
+#define SCALINGRUN_HPP
+
+/*
+One benchmark run: a number of PortWorkers on the slave sides of ptys, all
+on threads of their own or all on a shared PortReactor, with one thread
+playing every device on the master sides. The GUI side only drains the
+queues and counts bytes, so what is measured is the I/O engine. CPU time
+excludes the thread playing the devices.
+*/
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <QObject>
+#include <QEventLoop>
+#include <QTimer>
+
+#include "portworker.hpp"
+#include "portreactor.hpp"
+
+class ScalingRun : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    struct Settings
+    {
+        int ports;
+        int io_threads;     // 0 is a thread per port
+        qint64 rate;        // bytes per second and port, 0 is unlimited
+        int chunk_size;
+        int duration;       // milliseconds
+    };
+
+    struct Result
+    {
+        std::uint64_t written;
+        std::uint64_t received;
+        double seconds;
+        double cpu_seconds;
+        PortReactor::Stats reactor;     // zero without a reactor
+    };
+
+    explicit ScalingRun(const Settings& settings, QObject *parent = nullptr);
+    ~ScalingRun() override;
+
+    bool open();
+    Result run();
+
+    QString error_string() const;
+
+private:
+
+    // device thread
+    void write_devices();
+
+    // GUI thread
+    void drain(PortWorker* port);
+    void stop_producing();
+    void check_done();
+
+    Settings _settings;
+    QString _error;
+
+    std::vector<int> _masters;
+    std::unique_ptr<PortReactor> _reactor;
+    std::vector<std::unique_ptr<PortWorker> > _ports;
+
+    QByteArray _payload;
+    std::uint64_t _received;
+    std::atomic<std::uint64_t> _written;
+    std::int64_t _start;
+    std::int64_t _last_delivery;
+
+    std::thread _thread;
+    std::atomic<bool> _producing;
+    std::atomic<bool> _producer_done;
+    double _thread_cpu;
+
+    QEventLoop _loop;
+    QTimer _done_timer;
+    std::int64_t _drain_deadline;
+};
+
+#endif
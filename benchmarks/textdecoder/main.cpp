@@ -0,0 +1,118 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include <cstring>
+#include <vector>
+
+#include "textdecoder.hpp"
+
+/*
+Decoding throughput on a single core, input fed in read sized chunks so
+sequences get split between them. memcpy of the same bytes is the floor,
+QString::fromUtf8 over each chunk is what the console used before.
+*/
+
+namespace
+{
+    const int rounds = 50;
+
+    double megabytes_per_second(qint64 bytes, qint64 nanoseconds)
+    {
+        return static_cast<double>(bytes) * 1000.0 / static_cast<double>(nanoseconds);
+    }
+
+    QByteArray ascii_input(int size)
+    {
+        QByteArray input(size, Qt::Uninitialized);
+        for(int i = 0; i < input.size(); ++i)
+        {
+            input[i] = static_cast<char>(i % 64 == 63 ? '\n' : 'A' + i % 26);
+        }
+        return input;
+    }
+
+    // text with a two, three or four byte character every few words
+    QByteArray mixed_input(int size)
+    {
+        const char* const words[] = {"temperature ", "\xC3\xA9t\xC3\xA9 ", "22.5\xC2\xB0" "C ", "\xE2\x82\xAC" "12 ", "ok\n", "\xF0\x9F\x98\x80 "};
+        QByteArray input;
+        input.reserve(size + 16);
+        for(int i = 0; input.size() < size; ++i)
+        {
+            input += words[(i * 7) % 6];
+        }
+        input.truncate(size);
+        return input;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QTextStream out(stdout);
+
+    const int size = 4 * 1024 * 1024;
+    const char* const encodings[] = {"ascii", "latin1", "utf8"};
+
+    out << "input,encoding,chunk,memcpy_mb_s,fromutf8_mb_s,decoder_mb_s\n";
+    for(int kind = 0; kind < 2; ++kind)
+    {
+        const QByteArray input = kind == 0 ? ascii_input(size) : mixed_input(size);
+        for(const int chunk : {64, 4096})
+        {
+            std::vector<char> copy(static_cast<std::size_t>(chunk));
+            QElapsedTimer timer;
+            timer.start();
+            std::size_t copied = 0;
+            for(int round = 0; round < rounds; ++round)
+            {
+                for(int offset = 0; offset < input.size(); offset += chunk)
+                {
+                    std::memcpy(copy.data(), input.constData() + offset, static_cast<std::size_t>(chunk));
+                    copied += static_cast<unsigned char>(copy[0]);
+                }
+            }
+            const double memcpy_speed = megabytes_per_second(static_cast<qint64>(input.size()) * rounds, timer.nsecsElapsed());
+
+            timer.restart();
+            qint64 qt_length = 0;
+            for(int round = 0; round < rounds; ++round)
+            {
+                for(int offset = 0; offset < input.size(); offset += chunk)
+                {
+                    qt_length += QString::fromUtf8(input.constData() + offset, chunk).size();
+                }
+            }
+            const double qt_speed = megabytes_per_second(static_cast<qint64>(input.size()) * rounds, timer.nsecsElapsed());
+
+            for(int encoding = 0; encoding < 3; ++encoding)
+            {
+                TextDecoder decoder(static_cast<TextDecoder::ENCODING>(encoding));
+                std::vector<char16_t> text(TextDecoder::output_capacity(static_cast<std::size_t>(chunk)));
+                timer.restart();
+                std::size_t decoded = 0;
+                for(int round = 0; round < rounds; ++round)
+                {
+                    for(int offset = 0; offset < input.size(); offset += chunk)
+                    {
+                        decoded += decoder.decode(input.constData() + offset, static_cast<std::size_t>(chunk), text.data());
+                    }
+                    decoded += decoder.flush(text.data());
+                }
+                const double decoder_speed = megabytes_per_second(static_cast<qint64>(input.size()) * rounds, timer.nsecsElapsed());
+
+                // keep results observable so no loop is optimised away
+                if(copied == 0 || qt_length == 0 || decoded == 0)
+                {
+                    return 1;
+                }
+
+                out << (kind == 0 ? "ascii" : "mixed") << "," << encodings[encoding] << "," << chunk << ","
+                    << memcpy_speed << "," << qt_speed << "," << decoder_speed << "\n";
+            }
+        }
+    }
+
+    return 0;
+}
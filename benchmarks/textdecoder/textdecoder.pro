@@ -0,0 +1,21 @@
+#-------------------------------------------------
+#
+# Streaming text decoder throughput against memcpy and QString::fromUtf8
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = textdecoder_benchmark
+TEMPLATE = app
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+        main.cpp
+
+include(../../core/core.pri)
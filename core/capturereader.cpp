@@ -0,0 +1,111 @@
+#include "capturereader.hpp"
+
+#include <cstring>
+
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QtEndian>
+
+#include "capturewriter.hpp"
+
+CaptureReader::CaptureReader(const QString& path) :
+    _file(path), _error(), _data(nullptr), _size(0), _position(0)
+{
+
+}
+
+CaptureReader::~CaptureReader()
+{
+    close();
+}
+
+bool CaptureReader::open()
+{
+    close();
+    if(!_file.open(QIODevice::ReadOnly))
+    {
+        _error = _file.errorString();
+        return false;
+    }
+    _size = _file.size();
+    _data = _size > 0 ? _file.map(0, _size) : nullptr;
+    if(!_data || _size < static_cast<qint64>(CaptureWriter::header_size) ||
+            std::memcmp(_data, CaptureWriter::magic, sizeof(CaptureWriter::magic)) != 0 ||
+            qFromLittleEndian<quint32>(_data + 8) != CaptureWriter::version)
+    {
+        _error = "Not a capture file";
+        close();
+        return false;
+    }
+    rewind();
+    return true;
+}
+
+void CaptureReader::close()
+{
+    if(_data)
+    {
+        _file.unmap(const_cast<uchar*>(_data));
+        _data = nullptr;
+    }
+    _file.close();
+    _size = 0;
+    _position = 0;
+}
+
+QString CaptureReader::error_string() const
+{
+    return _error;
+}
+
+bool CaptureReader::next(Record& record)
+{
+    if(!_data || _position + static_cast<qint64>(CaptureWriter::record_header_size) > _size)
+    {
+        return false;
+    }
+    const uchar* header = _data + _position;
+    record.timestamp = qFromLittleEndian<qint64>(header);
+    record.length = qFromLittleEndian<quint32>(header + 8);
+    record.sender = static_cast<SENDER>(header[12]);
+    record.data = reinterpret_cast<const char*>(header + CaptureWriter::record_header_size);
+
+    // zero filled tail of a file that was not closed cleanly
+    if(record.length == 0 && record.sender == SENDER::NONE)
+    {
+        return false;
+    }
+
+    const qint64 end = _position + static_cast<qint64>(CaptureWriter::record_header_size) + record.length;
+    if(end > _size)
+    {
+        return false;
+    }
+    _position = end;
+    return true;
+}
+
+void CaptureReader::rewind()
+{
+    _position = static_cast<qint64>(CaptureWriter::header_size);
+}
+
+QStringList CaptureReader::session_files(const QString& first)
+{
+    QStringList files(first);
+    const QRegularExpressionMatch match = QRegularExpression("^(.*)-(\\d{4})\\.spcap$").match(first);
+    if(!match.hasMatch())
+    {
+        return files;
+    }
+    for(int index = match.captured(2).toInt() + 1; ; ++index)
+    {
+        const QString path = QString("%1-%2.spcap").arg(match.captured(1)).arg(index, 4, 10, QChar('0'));
+        if(!QFileInfo::exists(path))
+        {
+            break;
+        }
+        files.append(path);
+    }
+    return files;
+}
@@ -0,0 +1,55 @@
+#ifndef CAPTUREREADER_HPP
+#define CAPTUREREADER_HPP
+
+/*
+Sequential reader of capture files written by CaptureWriter. The file is
+memory mapped and records point straight into the mapping.
+*/
+
+#include <cstdint>
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+
+#include "sender.hpp"
+
+class CaptureReader
+{
+public:
+
+    struct Record
+    {
+        std::int64_t timestamp;
+        SENDER sender;
+        const char* data;
+        std::uint32_t length;
+    };
+
+    explicit CaptureReader(const QString& path);
+    ~CaptureReader();
+
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    bool open();
+    void close();
+    QString error_string() const;
+
+    // false at the end of file or on a truncated record
+    bool next(Record& record);
+    void rewind();
+
+    // all files of a rotated session, starting with the given one
+    static QStringList session_files(const QString& first);
+
+private:
+
+    QFile _file;
+    QString _error;
+    const uchar* _data;
+    qint64 _size;
+    qint64 _position;
+};
+
+#endif
@@ -0,0 +1,180 @@
+#include "capturewriter.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <QtEndian>
+
+namespace
+{
+    const qint64 window_size = 32 * 1024 * 1024;
+}
+
+const char CaptureWriter::magic[8] = {'S', 'P', 'C', 'C', 'A', 'P', '0', '1'};
+
+CaptureWriter::CaptureWriter(const QString& base, qint64 file_limit) :
+    _base(base), _file_limit(std::max<qint64>(file_limit, 1024 * 1024)), _index(0),
+    _file(), _error(), _window(nullptr), _window_offset(0), _window_used(0), _bytes_written(0)
+{
+
+}
+
+CaptureWriter::~CaptureWriter()
+{
+    close();
+}
+
+bool CaptureWriter::open()
+{
+    close();
+    _index = 0;
+    _bytes_written = 0;
+    return open_file();
+}
+
+void CaptureWriter::close()
+{
+    if(_file.isOpen())
+    {
+        finish_file();
+    }
+}
+
+bool CaptureWriter::is_open() const
+{
+    return _file.isOpen();
+}
+
+bool CaptureWriter::write(const SENDER& sender, std::int64_t timestamp, const char* data, std::size_t size)
+{
+    if(!_file.isOpen())
+    {
+        return false;
+    }
+    if(size == 0)
+    {
+        return true;
+    }
+
+    const qint64 record_size = static_cast<qint64>(record_header_size + size);
+    const qint64 position = _window_offset + _window_used;
+    if(position > static_cast<qint64>(header_size) && position + record_size > _file_limit)
+    {
+        finish_file();
+        ++_index;
+        if(!open_file())
+        {
+            return false;
+        }
+    }
+
+    char header[record_header_size] = {};
+    qToLittleEndian<qint64>(timestamp, header);
+    qToLittleEndian<quint32>(static_cast<quint32>(size), header + 8);
+    header[12] = static_cast<char>(sender);
+
+    if(!put(header, sizeof(header)) || !put(data, size))
+    {
+        return false;
+    }
+    _bytes_written += size;
+    return true;
+}
+
+QString CaptureWriter::file_name() const
+{
+    return _file.fileName();
+}
+
+QString CaptureWriter::error_string() const
+{
+    return _error;
+}
+
+std::uint64_t CaptureWriter::bytes_written() const
+{
+    return _bytes_written;
+}
+
+int CaptureWriter::files() const
+{
+    return _index + (_file.isOpen() ? 1 : 0);
+}
+
+bool CaptureWriter::open_file()
+{
+    _file.setFileName(QString("%1-%2.spcap").arg(_base).arg(_index, 4, 10, QChar('0')));
+    if(!_file.open(QIODevice::ReadWrite | QIODevice::Truncate))
+    {
+        _error = _file.errorString();
+        return false;
+    }
+
+    _window = nullptr;
+    _window_offset = 0;
+    _window_used = 0;
+    if(!map_window(0))
+    {
+        return false;
+    }
+
+    char header[header_size] = {};
+    std::memcpy(header, magic, sizeof(magic));
+    qToLittleEndian<quint32>(version, header + 8);
+    return put(header, sizeof(header));
+}
+
+void CaptureWriter::finish_file()
+{
+    const qint64 size = _window_offset + _window_used;
+    if(_window)
+    {
+        _file.unmap(_window);
+        _window = nullptr;
+    }
+    // drop unused tail of the last window
+    _file.resize(size);
+    _file.close();
+}
+
+bool CaptureWriter::map_window(qint64 offset)
+{
+    if(_window)
+    {
+        _file.unmap(_window);
+        _window = nullptr;
+    }
+    if(_file.size() < offset + window_size && !_file.resize(offset + window_size))
+    {
+        _error = _file.errorString();
+        _file.close();
+        return false;
+    }
+    _window = _file.map(offset, window_size);
+    if(!_window)
+    {
+        _error = _file.errorString();
+        _file.close();
+        return false;
+    }
+    _window_offset = offset;
+    _window_used = 0;
+    return true;
+}
+
+bool CaptureWriter::put(const char* data, std::size_t size)
+{
+    while(size > 0)
+    {
+        if(_window_used == window_size && !map_window(_window_offset + window_size))
+        {
+            return false;
+        }
+        const std::size_t count = std::min<std::size_t>(size, static_cast<std::size_t>(window_size - _window_used));
+        std::memcpy(_window + _window_used, data, count);
+        _window_used += static_cast<qint64>(count);
+        data += count;
+        size -= count;
+    }
+    return true;
+}
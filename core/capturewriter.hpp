@@ -0,0 +1,74 @@
+#ifndef CAPTUREWRITER_HPP
+#define CAPTUREWRITER_HPP
+
+/*
+Lossless binary log of port traffic. Files are written through memory
+mapped windows, so appending a record is a memcpy. When a file reaches its
+size limit capture continues in the next file.
+
+File layout, all integers little endian:
+    header  "SPCCAP01", uint32 version, uint32 reserved
+    record  int64 timestamp (ns, monotonic), uint32 length,
+            uint8 sender, 3 reserved bytes, payload
+A record with zero length and sender marks the end of a file that was not
+closed cleanly.
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+#include <QFile>
+#include <QString>
+
+#include "sender.hpp"
+
+class CaptureWriter
+{
+public:
+
+    static const char magic[8];
+    static const std::uint32_t version = 1;
+    static const std::size_t header_size = 16;
+    static const std::size_t record_header_size = 16;
+
+    // files are named <base>-0000.spcap, <base>-0001.spcap, ...
+    explicit CaptureWriter(const QString& base, qint64 file_limit = 1024LL * 1024 * 1024);
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    bool open();
+    void close();
+    bool is_open() const;
+
+    bool write(const SENDER& sender, std::int64_t timestamp, const char* data, std::size_t size);
+
+    QString file_name() const;
+    QString error_string() const;
+
+    // payload bytes written across all files
+    std::uint64_t bytes_written() const;
+    int files() const;
+
+private:
+
+    bool open_file();
+    void finish_file();
+    bool map_window(qint64 offset);
+    bool put(const char* data, std::size_t size);
+
+    QString _base;
+    qint64 _file_limit;
+    int _index;
+    QFile _file;
+    QString _error;
+
+    uchar* _window;
+    qint64 _window_offset;
+    qint64 _window_used;
+
+    std::uint64_t _bytes_written;
+};
+
+#endif
@@ -0,0 +1,275 @@
+#include "checksum.hpp"
+
+#include <cstring>
+
+namespace
+{
+    struct Crc8Table
+    {
+        std::uint8_t table[256];
+
+        Crc8Table()
+        {
+            for(unsigned i = 0; i < 256; ++i)
+            {
+                std::uint8_t crc = static_cast<std::uint8_t>(i);
+                for(int bit = 0; bit < 8; ++bit)
+                {
+                    crc = static_cast<std::uint8_t>((crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1);
+                }
+                table[i] = crc;
+            }
+        }
+    };
+
+    struct ModbusTable
+    {
+        std::uint16_t table[256];
+
+        ModbusTable()
+        {
+            for(unsigned i = 0; i < 256; ++i)
+            {
+                std::uint16_t crc = static_cast<std::uint16_t>(i);
+                for(int bit = 0; bit < 8; ++bit)
+                {
+                    crc = static_cast<std::uint16_t>((crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1);
+                }
+                table[i] = crc;
+            }
+        }
+    };
+
+    struct CcittTable
+    {
+        std::uint16_t table[256];
+
+        CcittTable()
+        {
+            for(unsigned i = 0; i < 256; ++i)
+            {
+                std::uint16_t crc = static_cast<std::uint16_t>(i << 8);
+                for(int bit = 0; bit < 8; ++bit)
+                {
+                    crc = static_cast<std::uint16_t>((crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1);
+                }
+                table[i] = crc;
+            }
+        }
+    };
+
+    // table[k][b] is the CRC of byte b followed by k zero bytes
+    struct Crc32Table
+    {
+        std::uint32_t table[8][256];
+
+        Crc32Table()
+        {
+            for(unsigned i = 0; i < 256; ++i)
+            {
+                std::uint32_t crc = i;
+                for(int bit = 0; bit < 8; ++bit)
+                {
+                    crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+                }
+                table[0][i] = crc;
+            }
+            for(unsigned i = 0; i < 256; ++i)
+            {
+                for(int k = 1; k < 8; ++k)
+                {
+                    table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFF];
+                }
+            }
+        }
+    };
+
+    const char hex_digits[] = "0123456789abcdef";
+
+    std::uint32_t load_le32(const unsigned char* data)
+    {
+        return static_cast<std::uint32_t>(data[0]) | static_cast<std::uint32_t>(data[1]) << 8 |
+               static_cast<std::uint32_t>(data[2]) << 16 | static_cast<std::uint32_t>(data[3]) << 24;
+    }
+}
+
+std::uint32_t Checksum::compute(const TYPE& type, const char* data, std::size_t size)
+{
+    switch(type)
+    {
+    case TYPE::NMEA_XOR:
+        return nmea_xor(data, size);
+    case TYPE::CRC8:
+        return crc8(data, size);
+    case TYPE::CRC16_MODBUS:
+        return crc16_modbus(data, size);
+    case TYPE::CRC16_CCITT:
+        return crc16_ccitt(data, size);
+    case TYPE::CRC32:
+        return crc32(data, size);
+    default:
+        return 0;
+    }
+}
+
+void Checksum::append(const TYPE& type, std::uint32_t value, QByteArray& out)
+{
+    char bytes[4];
+    out.append(bytes, encode(type, value, bytes));
+}
+
+int Checksum::encode(const TYPE& type, std::uint32_t value, char* out)
+{
+    switch(type)
+    {
+    case TYPE::NMEA_XOR:
+        out[0] = '*';
+        out[1] = hex_digits[(value >> 4) & 0xF];
+        out[2] = hex_digits[value & 0xF];
+        return 3;
+    case TYPE::CRC8:
+        out[0] = static_cast<char>(value & 0xFF);
+        return 1;
+    case TYPE::CRC16_MODBUS:
+        out[0] = static_cast<char>(value & 0xFF);
+        out[1] = static_cast<char>((value >> 8) & 0xFF);
+        return 2;
+    case TYPE::CRC16_CCITT:
+        out[0] = static_cast<char>((value >> 8) & 0xFF);
+        out[1] = static_cast<char>(value & 0xFF);
+        return 2;
+    case TYPE::CRC32:
+        for(int i = 0; i < 4; ++i)
+        {
+            out[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+int Checksum::appended_size(const TYPE& type)
+{
+    switch(type)
+    {
+    case TYPE::NMEA_XOR:
+        return 3;
+    case TYPE::CRC8:
+        return 1;
+    case TYPE::CRC16_MODBUS:
+    case TYPE::CRC16_CCITT:
+        return 2;
+    case TYPE::CRC32:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+QStringList Checksum::names()
+{
+    return {"None", "NMEA XOR", "CRC-8", "CRC-16/Modbus", "CRC-16/CCITT", "CRC-32"};
+}
+
+QString Checksum::name(const TYPE& type)
+{
+    return names().value(static_cast<int>(type));
+}
+
+Checksum::TYPE Checksum::from_name(const QString& name, bool* ok)
+{
+    const QStringList all = names();
+    for(int i = 0; i < all.size(); ++i)
+    {
+        if(all.at(i).compare(name, Qt::CaseInsensitive) == 0)
+        {
+            if(ok)
+            {
+                *ok = true;
+            }
+            return static_cast<TYPE>(i);
+        }
+    }
+    if(ok)
+    {
+        *ok = false;
+    }
+    return TYPE::NONE;
+}
+
+std::uint8_t Checksum::nmea_xor(const char* data, std::size_t size)
+{
+    // eight bytes at a time, folded at the end
+    std::uint64_t wide = 0;
+    std::size_t i = 0;
+    for(; i + 8 <= size; i += 8)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        wide ^= word;
+    }
+    wide ^= wide >> 32;
+    wide ^= wide >> 16;
+    wide ^= wide >> 8;
+    std::uint8_t crc = static_cast<std::uint8_t>(wide);
+    for(; i < size; ++i)
+    {
+        crc ^= static_cast<std::uint8_t>(data[i]);
+    }
+    return crc;
+}
+
+std::uint8_t Checksum::crc8(const char* data, std::size_t size)
+{
+    static const Crc8Table table;
+    std::uint8_t crc = 0;
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        crc = table.table[crc ^ static_cast<std::uint8_t>(data[i])];
+    }
+    return crc;
+}
+
+std::uint16_t Checksum::crc16_modbus(const char* data, std::size_t size)
+{
+    static const ModbusTable table;
+    std::uint16_t crc = 0xFFFF;
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        crc = static_cast<std::uint16_t>((crc >> 8) ^ table.table[(crc ^ static_cast<std::uint8_t>(data[i])) & 0xFF]);
+    }
+    return crc;
+}
+
+std::uint16_t Checksum::crc16_ccitt(const char* data, std::size_t size)
+{
+    static const CcittTable table;
+    std::uint16_t crc = 0xFFFF;
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        crc = static_cast<std::uint16_t>((crc << 8) ^ table.table[((crc >> 8) ^ static_cast<std::uint8_t>(data[i])) & 0xFF]);
+    }
+    return crc;
+}
+
+std::uint32_t Checksum::crc32(const char* data, std::size_t size)
+{
+    static const Crc32Table tables;
+    const auto& t = tables.table;
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(data);
+
+    std::uint32_t crc = 0xFFFFFFFFu;
+    for(; size >= 8; size -= 8, in += 8)
+    {
+        const std::uint32_t low = load_le32(in) ^ crc;
+        const std::uint32_t high = load_le32(in + 4);
+        crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+              t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+    }
+    for(; size > 0; --size, ++in)
+    {
+        crc = (crc >> 8) ^ t[0][(crc ^ *in) & 0xFF];
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
@@ -0,0 +1,56 @@
+#ifndef CHECKSUM_HPP
+#define CHECKSUM_HPP
+
+/*
+Checksums appended to outgoing commands. All CRCs are table driven, CRC-32
+processes eight bytes per step (slicing-by-8). Tables are built on first use.
+
+    NMEA_XOR      XOR of all bytes, sent as *hh text
+    CRC8          poly 0x07, init 0x00 (SMBus), 1 byte
+    CRC16_MODBUS  poly 0x8005 reflected, init 0xFFFF, 2 bytes low first
+    CRC16_CCITT   poly 0x1021, init 0xFFFF (CCITT-FALSE), 2 bytes high first
+    CRC32         poly 0x04C11DB7 reflected, init and xorout 0xFFFFFFFF, 4 bytes low first
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+class Checksum
+{
+public:
+
+    enum class TYPE : std::uint8_t
+    {
+        NONE = 0,
+        NMEA_XOR,
+        CRC8,
+        CRC16_MODBUS,
+        CRC16_CCITT,
+        CRC32
+    };
+
+    static std::uint32_t compute(const TYPE& type, const char* data, std::size_t size);
+
+    // bytes appended to a frame, in the byte order and encoding the protocols expect
+    static void append(const TYPE& type, std::uint32_t value, QByteArray& out);
+    // same bytes written to out, which must hold appended_size(), returns their count
+    static int encode(const TYPE& type, std::uint32_t value, char* out);
+    static int appended_size(const TYPE& type);
+
+    // names as shown in the GUI and accepted on the command line, in TYPE order
+    static QStringList names();
+    static QString name(const TYPE& type);
+    static TYPE from_name(const QString& name, bool* ok = nullptr);
+
+    static std::uint8_t nmea_xor(const char* data, std::size_t size);
+    static std::uint8_t crc8(const char* data, std::size_t size);
+    static std::uint16_t crc16_modbus(const char* data, std::size_t size);
+    static std::uint16_t crc16_ccitt(const char* data, std::size_t size);
+    static std::uint32_t crc32(const char* data, std::size_t size);
+};
+
+#endif
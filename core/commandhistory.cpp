@@ -0,0 +1,280 @@
+#include "commandhistory.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+#include <QSaveFile>
+
+#include "messageformat.hpp"
+
+namespace
+{
+    // log is rewritten once it has this many lines and more than twice the entries
+    const int minimum_compaction = 1024;
+}
+
+CommandHistory::CommandHistory(int limit) :
+    _limit(std::max(limit, 1)), _sequence(0), _entries(), _recent(), _path(), _log(), _lines(0)
+{
+
+}
+
+CommandHistory::~CommandHistory()
+{
+    close();
+}
+
+bool CommandHistory::open(const QString& path, QString* error)
+{
+    close();
+    if(path.isEmpty())
+    {
+        return false;
+    }
+
+    QFile file(path);
+    if(file.exists())
+    {
+        if(!file.open(QIODevice::ReadOnly))
+        {
+            if(error)
+            {
+                *error = QString("%1: %2").arg(path, file.errorString());
+            }
+            return false;
+        }
+        const QByteArray content = file.readAll();
+        // last use per command first, the index is sorted once instead of growing line by line
+        QHash<QString, std::uint64_t> used;
+        int start = 0;
+        while(start < content.size())
+        {
+            const int end = content.indexOf('\n', start);
+            if(end < 0)
+            {
+                // cut short by a crash while it was written
+                break;
+            }
+            const int length = end > start && content[end - 1] == '\r' ? end - start - 1 : end - start;
+            if(length > 0)
+            {
+                used[MessageFormat::unescape(QString::fromUtf8(content.constData() + start, length))] = ++_sequence;
+                ++_lines;
+            }
+            start = end + 1;
+        }
+        load(used);
+    }
+
+    _path = path;
+    if(_lines >= minimum_compaction && _lines > 2 * size())
+    {
+        return compact(error);
+    }
+
+    _log.setFileName(path);
+    if(!_log.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        if(error)
+        {
+            *error = QString("%1: %2").arg(path, _log.errorString());
+        }
+        return false;
+    }
+    return true;
+}
+
+void CommandHistory::close()
+{
+    if(_log.isOpen())
+    {
+        _log.close();
+    }
+    _path.clear();
+    _entries.clear();
+    _recent.clear();
+    _lines = 0;
+}
+
+int CommandHistory::size() const
+{
+    return static_cast<int>(_entries.size());
+}
+
+bool CommandHistory::empty() const
+{
+    return _entries.empty();
+}
+
+void CommandHistory::add(const QString& command)
+{
+    if(command.isEmpty())
+    {
+        return;
+    }
+    touch(command);
+    if(!_log.isOpen())
+    {
+        return;
+    }
+
+    const QByteArray line = MessageFormat::escape(command).toUtf8() + "\n";
+    if(_log.write(line) != line.size() || !_log.flush())
+    {
+        return;
+    }
+    ++_lines;
+    if(_lines >= minimum_compaction && _lines > 2 * size())
+    {
+        compact(nullptr);
+    }
+}
+
+QString CommandHistory::recent(int index) const
+{
+    if(index < 0 || index >= size())
+    {
+        return QString();
+    }
+    auto it = _recent.crbegin();
+    std::advance(it, index);
+    return it->second;
+}
+
+QStringList CommandHistory::complete(const QString& prefix, int limit) const
+{
+    QStringList result;
+    if(prefix.isEmpty() || limit <= 0)
+    {
+        return result;
+    }
+
+    // everything starting with prefix sorts right after it
+    auto first = std::lower_bound(_entries.cbegin(), _entries.cend(), prefix, &CommandHistory::before);
+    std::vector<const Entry*> matches;
+    for(auto it = first; it != _entries.cend() && it->command.startsWith(prefix); ++it)
+    {
+        matches.push_back(&*it);
+    }
+
+    const auto newer = [](const Entry* a, const Entry* b)
+    {
+        return a->used > b->used;
+    };
+    const std::size_t count = std::min(matches.size(), static_cast<std::size_t>(limit));
+    std::partial_sort(matches.begin(), matches.begin() + static_cast<std::ptrdiff_t>(count), matches.end(), newer);
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        result.append(matches[i]->command);
+    }
+    return result;
+}
+
+int CommandHistory::search(const QString& text, int from) const
+{
+    if(text.isEmpty() || from < 0 || from >= size())
+    {
+        return -1;
+    }
+    auto it = _recent.crbegin();
+    std::advance(it, from);
+    for(int index = from; it != _recent.crend(); ++it, ++index)
+    {
+        if(it->second.contains(text))
+        {
+            return index;
+        }
+    }
+    return -1;
+}
+
+void CommandHistory::load(const QHash<QString, std::uint64_t>& used)
+{
+    _entries.reserve(static_cast<std::size_t>(used.size()));
+    for(auto it = used.cbegin(); it != used.cend(); ++it)
+    {
+        _entries.push_back(Entry{it.key(), it.value()});
+    }
+    // past the limit only the most recently used are kept
+    if(size() > _limit)
+    {
+        std::nth_element(_entries.begin(), _entries.begin() + _limit, _entries.end(), [](const Entry& a, const Entry& b)
+        {
+            return a.used > b.used;
+        });
+        _entries.erase(_entries.begin() + _limit, _entries.end());
+    }
+    std::sort(_entries.begin(), _entries.end(), [](const Entry& a, const Entry& b)
+    {
+        return a.command < b.command;
+    });
+    for(const Entry& entry : _entries)
+    {
+        _recent.emplace(entry.used, entry.command);
+    }
+}
+
+bool CommandHistory::before(const Entry& entry, const QString& command)
+{
+    return entry.command < command;
+}
+
+void CommandHistory::touch(const QString& command)
+{
+    auto it = std::lower_bound(_entries.begin(), _entries.end(), command, &CommandHistory::before);
+    if(it != _entries.end() && it->command == command)
+    {
+        _recent.erase(it->used);
+        it->used = ++_sequence;
+    }
+    else
+    {
+        _entries.insert(it, Entry{command, ++_sequence});
+    }
+    _recent.emplace(_sequence, command);
+
+    if(size() > _limit)
+    {
+        const auto oldest = _recent.begin();
+        _entries.erase(std::lower_bound(_entries.begin(), _entries.end(), oldest->second, &CommandHistory::before));
+        _recent.erase(oldest);
+    }
+}
+
+bool CommandHistory::compact(QString* error)
+{
+    // oldest first, so loading it again restores the same order
+    QByteArray content;
+    for(const auto& command : _recent)
+    {
+        content.append(MessageFormat::escape(command.second).toUtf8());
+        content.append('\n');
+    }
+
+    QSaveFile file(_path);
+    if(!file.open(QIODevice::WriteOnly) || file.write(content) != content.size() || !file.commit())
+    {
+        if(error)
+        {
+            *error = QString("%1: %2").arg(_path, file.errorString());
+        }
+        return false;
+    }
+    _lines = size();
+
+    // the old log was renamed over, appends have to go to the new file
+    if(_log.isOpen())
+    {
+        _log.close();
+    }
+    _log.setFileName(_path);
+    if(!_log.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        if(error)
+        {
+            *error = QString("%1: %2").arg(_path, _log.errorString());
+        }
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,80 @@
+#ifndef COMMANDHISTORY_HPP
+#define COMMANDHISTORY_HPP
+
+/*
+Commands sent from any console, newest last use wins and every command is
+kept once. Entries live in an array sorted by text, so everything starting
+with a prefix is one contiguous range found by binary search; a second index
+ordered by last use drives Up/Down and reverse search.
+
+On disk it is a log of one escaped command per line in the order they were
+sent. Loading replays it, the log is rewritten from the index once it holds
+mostly repeats, and the oldest commands are dropped past the limit.
+*/
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+class CommandHistory
+{
+public:
+
+    static const int default_limit = 50000;
+
+    explicit CommandHistory(int limit = default_limit);
+    ~CommandHistory();
+
+    CommandHistory(const CommandHistory&) = delete;
+    CommandHistory& operator=(const CommandHistory&) = delete;
+
+    // loads the log and keeps it open for appending, a missing file is an empty history
+    bool open(const QString& path, QString* error = nullptr);
+    void close();
+
+    int size() const;
+    bool empty() const;
+
+    // moves an existing command to the front instead of adding it again
+    void add(const QString& command);
+
+    // 0 is the newest command
+    QString recent(int index) const;
+
+    // commands starting with prefix, most recently used first
+    QStringList complete(const QString& prefix, int limit) const;
+
+    // recent() index of the newest command at or after from that contains text, -1 when none
+    int search(const QString& text, int from) const;
+
+private:
+
+    struct Entry
+    {
+        QString command;
+        std::uint64_t used;
+    };
+
+    void load(const QHash<QString, std::uint64_t>& used);
+    static bool before(const Entry& entry, const QString& command);
+    void touch(const QString& command);
+    bool compact(QString* error);
+
+    int _limit;
+    std::uint64_t _sequence;
+    // sorted by command
+    std::vector<Entry> _entries;
+    // last use to command, newest at the end
+    std::map<std::uint64_t, QString> _recent;
+
+    QString _path;
+    QFile _log;
+    int _lines;
+};
+
+#endif
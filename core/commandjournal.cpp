@@ -0,0 +1,293 @@
+#include "commandjournal.hpp"
+
+#include <algorithm>
+
+#include <QSaveFile>
+
+#include "checksum.hpp"
+#include "messageformat.hpp"
+
+namespace
+{
+    // compaction once the journal has this many edits and more than the library has entries
+    const int minimum_compaction = 1024;
+
+    // commands handed to read() progress at a time
+    const int read_batch = 4096;
+
+    QByteArray header(std::uint32_t crc, qint64 size)
+    {
+        return QString("#base %1 %2\n").arg(crc, 8, 16, QChar('0')).arg(size).toUtf8();
+    }
+}
+
+CommandJournal::CommandJournal() :
+    _path(), _journal(), _entries(0), _operations(0)
+{
+
+}
+
+CommandJournal::~CommandJournal()
+{
+    close();
+}
+
+QStringList CommandJournal::load(const QString& path, QString* error)
+{
+    Library library;
+    read(path, library, Progress(), error);
+    return library.commands;
+}
+
+bool CommandJournal::read(const QString& path, Library& library, const Progress& progress, QString* error)
+{
+    library = Library();
+    QByteArray content;
+    QFile file(path);
+    if(file.exists())
+    {
+        if(!file.open(QIODevice::ReadOnly))
+        {
+            if(error)
+            {
+                *error = QString("%1: %2").arg(path, file.errorString());
+            }
+            return false;
+        }
+        content = file.readAll();
+    }
+    library.crc = Checksum::crc32(content.constData(), static_cast<std::size_t>(content.size()));
+    library.size = content.size();
+
+    // parsed in place, one string per command and nothing else
+    QStringList batch;
+    int start = 0;
+    while(start < content.size())
+    {
+        int end = content.indexOf('\n', start);
+        if(end < 0)
+        {
+            end = content.size();
+        }
+        const int length = end > start && content[end - 1] == '\r' ? end - start - 1 : end - start;
+        library.commands.append(MessageFormat::unescape(QString::fromUtf8(content.constData() + start, length)));
+        start = end + 1;
+
+        if(progress)
+        {
+            batch.append(library.commands.back());
+            if(batch.size() == read_batch)
+            {
+                if(!progress(batch))
+                {
+                    return false;
+                }
+                batch.clear();
+            }
+        }
+    }
+    if(progress && !batch.isEmpty() && !progress(batch))
+    {
+        return false;
+    }
+
+    read_journal(path, library);
+    return true;
+}
+
+bool CommandJournal::open(const QString& path, QStringList& commands, QString* error)
+{
+    close();
+    commands.clear();
+    Library library;
+    if(path.isEmpty() || !read(path, library, Progress(), error))
+    {
+        return false;
+    }
+    commands = library.commands;
+    return open(path, library, error);
+}
+
+bool CommandJournal::open(const QString& path, const Library& library, QString* error)
+{
+    close();
+    if(path.isEmpty())
+    {
+        return false;
+    }
+
+    _path = path;
+    _entries = library.commands.size();
+    _operations = 0;
+    // replayed edits are folded into the file right away, the journal starts empty
+    if(library.operations > 0)
+    {
+        return compact(library.commands, error);
+    }
+    return start_journal(library.crc, library.size, error);
+}
+
+void CommandJournal::close()
+{
+    if(_journal.isOpen())
+    {
+        _journal.close();
+    }
+    _path.clear();
+    _entries = 0;
+    _operations = 0;
+}
+
+bool CommandJournal::is_open() const
+{
+    return _journal.isOpen();
+}
+
+QString CommandJournal::path() const
+{
+    return _path;
+}
+
+bool CommandJournal::append(const QString& command)
+{
+    if(!write("+" + MessageFormat::escape(command).toUtf8() + "\n"))
+    {
+        return false;
+    }
+    ++_entries;
+    return true;
+}
+
+bool CommandJournal::remove(int row)
+{
+    if(row < 0 || row >= _entries || !write("-" + QByteArray::number(row) + "\n"))
+    {
+        return false;
+    }
+    --_entries;
+    return true;
+}
+
+bool CommandJournal::needs_compaction() const
+{
+    return _operations >= minimum_compaction && _operations > _entries;
+}
+
+bool CommandJournal::compact(const QStringList& commands, QString* error)
+{
+    if(_path.isEmpty())
+    {
+        return false;
+    }
+
+    QByteArray content;
+    for(const QString& command : commands)
+    {
+        content.append(MessageFormat::escape(command).toUtf8());
+        content.append('\n');
+    }
+
+    QSaveFile file(_path);
+    if(!file.open(QIODevice::WriteOnly) || file.write(content) != content.size() || !file.commit())
+    {
+        if(error)
+        {
+            *error = QString("%1: %2").arg(_path, file.errorString());
+        }
+        return false;
+    }
+
+    _entries = commands.size();
+    _operations = 0;
+    return start_journal(Checksum::crc32(content.constData(), static_cast<std::size_t>(content.size())),
+                         content.size(), error);
+}
+
+QString CommandJournal::journal_path(const QString& path)
+{
+    return path + ".journal";
+}
+
+bool CommandJournal::read_journal(const QString& path, Library& library)
+{
+    QFile journal(journal_path(path));
+    if(!journal.open(QIODevice::ReadOnly))
+    {
+        return true;
+    }
+    const QByteArray edits = journal.readAll();
+    const int first = edits.indexOf('\n');
+    if(first < 0 || edits.left(first + 1) != header(library.crc, library.size))
+    {
+        // belongs to an older command file
+        return false;
+    }
+
+    int start = first + 1;
+    while(start < edits.size())
+    {
+        const int end = edits.indexOf('\n', start);
+        if(end < 0)
+        {
+            // cut short by a crash while it was written
+            break;
+        }
+        if(edits[start] == '+')
+        {
+            library.commands.append(MessageFormat::unescape(QString::fromUtf8(edits.constData() + start + 1, end - start - 1)));
+            ++library.operations;
+        }
+        else if(edits[start] == '-')
+        {
+            bool ok = false;
+            const int row = edits.mid(start + 1, end - start - 1).toInt(&ok);
+            if(ok && row >= 0 && row < library.commands.size())
+            {
+                library.commands.removeAt(row);
+                ++library.operations;
+            }
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+bool CommandJournal::start_journal(std::uint32_t crc, qint64 size, QString* error)
+{
+    if(_journal.isOpen())
+    {
+        _journal.close();
+    }
+
+    QSaveFile file(journal_path(_path));
+    const QByteArray line = header(crc, size);
+    if(!file.open(QIODevice::WriteOnly) || file.write(line) != line.size() || !file.commit())
+    {
+        if(error)
+        {
+            *error = QString("%1: %2").arg(journal_path(_path), file.errorString());
+        }
+        return false;
+    }
+
+    _journal.setFileName(journal_path(_path));
+    if(!_journal.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        if(error)
+        {
+            *error = QString("%1: %2").arg(_journal.fileName(), _journal.errorString());
+        }
+        return false;
+    }
+    return true;
+}
+
+bool CommandJournal::write(const QByteArray& line)
+{
+    if(!_journal.isOpen() || _journal.write(line) != line.size() || !_journal.flush())
+    {
+        return false;
+    }
+    ++_operations;
+    return true;
+}
@@ -0,0 +1,84 @@
+#ifndef COMMANDJOURNAL_HPP
+#define COMMANDJOURNAL_HPP
+
+/*
+Saved command library on disk. The command file holds one escaped command
+per line, edits since it was written go to <file>.journal as one flushed
+line each: "+command" appends, "-row" removes a row. Loading replays the
+journal over the file, so a crash loses at most the edit being written.
+
+Compaction writes the current list to the command file with an atomic
+rename and starts a new journal. The journal header names the CRC-32 and
+size of the file it belongs to, a journal left over from a compaction that
+was cut short does not match and is ignored.
+
+Reading and opening are separate steps as well, so a large library can be
+read on another thread and handed over in pieces while it is parsed.
+*/
+
+#include <cstdint>
+#include <functional>
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+
+class CommandJournal
+{
+public:
+
+    // a library as read, before its journal is opened
+    struct Library
+    {
+        QStringList commands;
+        std::uint32_t crc = 0;
+        qint64 size = 0;
+        int operations = 0;     // journal edits replayed over the file
+    };
+
+    // commands of the file in order, return false to stop reading
+    using Progress = std::function<bool(const QStringList& batch)>;
+
+    CommandJournal();
+    ~CommandJournal();
+
+    CommandJournal(const CommandJournal&) = delete;
+    CommandJournal& operator=(const CommandJournal&) = delete;
+
+    // read only, used by the headless console
+    static QStringList load(const QString& path, QString* error = nullptr);
+
+    // safe on any thread, progress sees the file's commands before journal edits
+    // are replayed over them, false when reading failed or was stopped
+    static bool read(const QString& path, Library& library, const Progress& progress, QString* error = nullptr);
+
+    // loads the library and keeps its journal open for edits, a missing file is an empty library
+    bool open(const QString& path, QStringList& commands, QString* error = nullptr);
+    // the same with a library read() returned, nothing is read again
+    bool open(const QString& path, const Library& library, QString* error = nullptr);
+    void close();
+    bool is_open() const;
+    QString path() const;
+
+    bool append(const QString& command);
+    bool remove(int row);
+
+    // journal has outgrown the library, compact() it with the current list
+    bool needs_compaction() const;
+    bool compact(const QStringList& commands, QString* error = nullptr);
+
+private:
+
+    static QString journal_path(const QString& path);
+    // replays the journal when its header matches the command file, false when it was stale
+    static bool read_journal(const QString& path, Library& library);
+    bool start_journal(std::uint32_t crc, qint64 size, QString* error);
+    bool write(const QByteArray& line);
+
+    QString _path;
+    QFile _journal;
+    int _entries;
+    int _operations;
+};
+
+#endif
@@ -0,0 +1,250 @@
+#include "commandscheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include <QStringList>
+
+#ifdef Q_OS_LINUX
+#include <sys/prctl.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+#include "monotonicclock.hpp"
+#include "portworker.hpp"
+
+namespace
+{
+    const std::size_t histogram_size = 10001;
+
+    // longest single wait, keeps stop() responsive with long periods
+    const std::int64_t max_wait = 50000000;
+
+    std::int64_t percentile(const std::vector<std::uint64_t>& histogram, std::uint64_t count, double fraction)
+    {
+        const std::uint64_t target = static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(count)));
+        std::uint64_t seen = 0;
+        for(std::size_t i = 0; i < histogram.size(); ++i)
+        {
+            seen += histogram[i];
+            if(seen >= target && seen > 0)
+            {
+                return static_cast<std::int64_t>(i) * 1000;
+            }
+        }
+        return 0;
+    }
+}
+
+QString CommandScheduler::Stats::text() const
+{
+    QStringList lines;
+    lines << QString("%1 sends/s, %2 B/s, %3 sends in %4 s")
+             .arg(send_rate, 0, 'f', 1).arg(byte_rate, 0, 'f', 0).arg(sends).arg(elapsed / 1e9, 0, 'f', 1);
+    lines << QString("Jitter %1 us avg, %2 us stddev, %3 to %4 us")
+             .arg(jitter_mean / 1000.0, 0, 'f', 1).arg(jitter_stddev / 1000.0, 0, 'f', 1)
+             .arg(jitter_min / 1000.0, 0, 'f', 1).arg(jitter_max / 1000.0, 0, 'f', 1);
+    lines << QString("Jitter p50 %1 us, p99 %2 us").arg(jitter_p50 / 1000).arg(jitter_p99 / 1000);
+    lines << QString("%1 ticks, %2 late, %3 skipped, %4 sends refused by the TX queue")
+             .arg(ticks).arg(late_ticks).arg(skipped_ticks).arg(rejected);
+    return lines.join('\n');
+}
+
+CommandScheduler::CommandScheduler(PortWorker* port) :
+    _port(port), _settings(), _thread(), _running(false), _timer(-1),
+    _mutex(), _stats(), _start(0), _jitter_sum(0), _jitter_square_sum(0), _histogram(histogram_size, 0)
+{
+    _stats = Stats{};
+#ifdef Q_OS_LINUX
+    _timer = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+#endif
+}
+
+CommandScheduler::~CommandScheduler()
+{
+    stop();
+#ifdef Q_OS_LINUX
+    if(_timer >= 0)
+    {
+        ::close(_timer);
+    }
+#endif
+}
+
+bool CommandScheduler::start(const Settings& settings)
+{
+    stop();
+    if(settings.frames.empty() || settings.period <= 0 || settings.burst <= 0)
+    {
+        return false;
+    }
+    _settings = settings;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stats = Stats{};
+        _stats.running = true;
+        _start = monotonic_ns();
+        _jitter_sum = 0;
+        _jitter_square_sum = 0;
+        std::fill(_histogram.begin(), _histogram.end(), 0);
+    }
+
+    _running = true;
+    _thread = std::thread(&CommandScheduler::run, this);
+    return true;
+}
+
+void CommandScheduler::stop()
+{
+    _running = false;
+    if(_thread.joinable())
+    {
+        _thread.join();
+    }
+}
+
+bool CommandScheduler::running() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats.running;
+}
+
+CommandScheduler::Stats CommandScheduler::stats() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    Stats stats = _stats;
+    if(stats.running)
+    {
+        stats.elapsed = monotonic_ns() - _start;
+    }
+    if(stats.ticks > 0)
+    {
+        const double count = static_cast<double>(stats.ticks);
+        stats.jitter_mean = _jitter_sum / count;
+        stats.jitter_stddev = std::sqrt(std::max(0.0, _jitter_square_sum / count - stats.jitter_mean * stats.jitter_mean));
+        stats.jitter_p50 = percentile(_histogram, stats.ticks, 0.50);
+        stats.jitter_p99 = percentile(_histogram, stats.ticks, 0.99);
+    }
+    if(stats.elapsed > 0)
+    {
+        stats.send_rate = static_cast<double>(stats.sends) * 1e9 / static_cast<double>(stats.elapsed);
+        stats.byte_rate = static_cast<double>(stats.bytes) * 1e9 / static_cast<double>(stats.elapsed);
+    }
+    return stats;
+}
+
+void CommandScheduler::run()
+{
+#ifdef Q_OS_LINUX
+    // default slack of 50 us would swallow sub-millisecond periods
+    prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0);
+#endif
+
+    const std::vector<QByteArray>& frames = _settings.frames;
+    const std::uint64_t total = _settings.repetitions * frames.size();
+    std::size_t next = 0;
+    std::uint64_t sent = 0;
+
+    // _start is set by start() before this thread exists
+    std::int64_t deadline = _start;
+    while(_running && (total == 0 || sent < total))
+    {
+        if(!wait_until(deadline))
+        {
+            break;
+        }
+        const std::int64_t now = monotonic_ns();
+
+        std::uint64_t bytes = 0;
+        std::uint64_t accepted = 0;
+        int burst = 0;
+        for(; burst < _settings.burst && (total == 0 || sent < total); ++burst, ++sent)
+        {
+            // a refused command is not retried, that would shift the schedule
+            if(_port->write(frames[next]))
+            {
+                bytes += static_cast<std::uint64_t>(frames[next].size());
+                ++accepted;
+            }
+            next = next + 1 < frames.size() ? next + 1 : 0;
+        }
+        record(now - deadline, accepted, bytes, static_cast<std::uint64_t>(burst) - accepted);
+
+        deadline += _settings.period;
+        const std::int64_t behind = monotonic_ns() - deadline;
+        if(behind > _settings.period)
+        {
+            // more than a tick behind, catching up would turn into a burst
+            const std::int64_t skipped = behind / _settings.period;
+            deadline += skipped * _settings.period;
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stats.skipped_ticks += static_cast<std::uint64_t>(skipped);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stats.elapsed = monotonic_ns() - _start;
+    _stats.running = false;
+}
+
+bool CommandScheduler::wait_until(std::int64_t deadline)
+{
+    const std::int64_t wake = deadline - _settings.spin;
+    while(_running)
+    {
+        const std::int64_t now = monotonic_ns();
+        if(now >= wake)
+        {
+            break;
+        }
+        const std::int64_t target = std::min(wake, now + max_wait);
+#ifdef Q_OS_LINUX
+        if(_timer >= 0)
+        {
+            itimerspec spec = {};
+            spec.it_value.tv_sec = static_cast<time_t>(target / 1000000000);
+            spec.it_value.tv_nsec = static_cast<long>(target % 1000000000);
+            std::uint64_t expirations = 0;
+            if(timerfd_settime(_timer, TFD_TIMER_ABSTIME, &spec, nullptr) == 0 &&
+               ::read(_timer, &expirations, sizeof(expirations)) == sizeof(expirations))
+            {
+                continue;
+            }
+        }
+#endif
+        std::this_thread::sleep_for(std::chrono::nanoseconds(target - now));
+    }
+
+    while(_running && monotonic_ns() < deadline)
+    {
+        // spin
+    }
+    return _running;
+}
+
+void CommandScheduler::record(std::int64_t jitter, std::uint64_t sends, std::uint64_t bytes, std::uint64_t rejected)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if(_stats.ticks == 0 || jitter < _stats.jitter_min)
+    {
+        _stats.jitter_min = jitter;
+    }
+    _stats.jitter_max = std::max(_stats.jitter_max, jitter);
+    ++_stats.ticks;
+    _stats.sends += sends;
+    _stats.bytes += bytes;
+    _stats.rejected += rejected;
+    if(jitter > _settings.period)
+    {
+        ++_stats.late_ticks;
+    }
+
+    const double value = static_cast<double>(jitter);
+    _jitter_sum += value;
+    _jitter_square_sum += value * value;
+    const std::size_t bucket = static_cast<std::size_t>(std::max<std::int64_t>(0, jitter) / 1000);
+    ++_histogram[std::min(bucket, histogram_size - 1)];
+}
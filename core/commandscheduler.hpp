@@ -0,0 +1,92 @@
+#ifndef COMMANDSCHEDULER_HPP
+#define COMMANDSCHEDULER_HPP
+
+/*
+Sends a sequence of framed commands on a fixed period from its own timing
+thread, for load generation. Ticks are on an absolute schedule, so lateness
+does not accumulate. Waiting uses timerfd on Linux and sleep elsewhere, the
+last stretch before a tick is spent spinning for sub-millisecond precision.
+Jitter is the distance between scheduled time and dispatch to the port
+worker.
+*/
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+
+class PortWorker;
+
+class CommandScheduler
+{
+public:
+
+    struct Settings
+    {
+        std::vector<QByteArray> frames;
+        std::int64_t period = 1000000;  // nanoseconds between ticks
+        int burst = 1;                  // commands sent on every tick
+        std::uint64_t repetitions = 0;  // passes through the sequence, 0 runs until stopped
+        std::int64_t spin = 50000;      // nanoseconds spent spinning before each tick, 0 only sleeps
+    };
+
+    struct Stats
+    {
+        bool running;
+        std::uint64_t ticks;
+        std::uint64_t sends;
+        std::uint64_t bytes;
+        std::uint64_t rejected;         // refused by the port's full TX queue
+        std::uint64_t late_ticks;       // dispatched more than a period late
+        std::uint64_t skipped_ticks;    // dropped to get back on schedule
+        std::int64_t elapsed;           // nanoseconds since start
+        std::int64_t jitter_min;
+        std::int64_t jitter_max;
+        double jitter_mean;
+        double jitter_stddev;
+        std::int64_t jitter_p50;
+        std::int64_t jitter_p99;
+        double send_rate;               // per second
+        double byte_rate;
+
+        QString text() const;
+    };
+
+    explicit CommandScheduler(PortWorker* port);
+    ~CommandScheduler();
+
+    CommandScheduler(const CommandScheduler&) = delete;
+    CommandScheduler& operator=(const CommandScheduler&) = delete;
+
+    bool start(const Settings& settings);
+    void stop();
+    bool running() const;
+
+    Stats stats() const;
+
+private:
+
+    void run();
+    bool wait_until(std::int64_t deadline);
+    void record(std::int64_t jitter, std::uint64_t sends, std::uint64_t bytes, std::uint64_t rejected);
+
+    PortWorker* _port;
+    Settings _settings;
+    std::thread _thread;
+    std::atomic<bool> _running;
+    int _timer;
+
+    mutable std::mutex _mutex;
+    Stats _stats;
+    std::int64_t _start;
+    double _jitter_sum;
+    double _jitter_square_sum;
+    // one microsecond per bucket, last one collects everything above
+    std::vector<std::uint64_t> _histogram;
+};
+
+#endif
@@ -0,0 +1,17 @@
+# Link against the core library, include from any project next to it:
+#     include(../core/core.pri)
+
+QT += serialport
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+CORE_OUT = $$shadowed($$PWD)
+
+win32:CONFIG(release, debug|release): CORE_OUT = $$CORE_OUT/release
+else:win32:CONFIG(debug, debug|release): CORE_OUT = $$CORE_OUT/debug
+
+LIBS += -L$$CORE_OUT -lserialportcore
+
+win32-g++|!win32: PRE_TARGETDEPS += $$CORE_OUT/libserialportcore.a
+else: PRE_TARGETDEPS += $$CORE_OUT/serialportcore.lib
@@ -0,0 +1,77 @@
+#-------------------------------------------------
+#
+# Port I/O, capture, replay and formatting shared by the GUI, the headless
+# console and the benchmarks. No widgets in here.
+#
+#-------------------------------------------------
+
+QT       += core serialport
+QT       -= gui
+
+TARGET = serialportcore
+TEMPLATE = lib
+
+CONFIG += c++17 staticlib
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+    scrollbackbuffer.cpp \
+    sessionsearch.cpp \
+    hexformatter.cpp \
+    messageformat.cpp \
+    checksum.cpp \
+    framer.cpp \
+    portstats.cpp \
+    serialbackend.cpp \
+    portworker.cpp \
+    portwatcher.cpp \
+    commandscheduler.cpp \
+    commandjournal.cpp \
+    commandhistory.cpp \
+    latencytracker.cpp \
+    triggerengine.cpp \
+    telemetrybuffer.cpp \
+    fieldextractor.cpp \
+    packetdecoder.cpp \
+    textdecoder.cpp \
+    capturewriter.cpp \
+    capturereader.cpp
+
+HEADERS += \
+    sender.hpp \
+    monotonicclock.hpp \
+    scrollbackbuffer.hpp \
+    sessionsearch.hpp \
+    hexformatter.hpp \
+    messageformat.hpp \
+    checksum.hpp \
+    framer.hpp \
+    portstats.hpp \
+    spscqueue.hpp \
+    portbackend.hpp \
+    serialbackend.hpp \
+    portworker.hpp \
+    portwatcher.hpp \
+    commandscheduler.hpp \
+    commandjournal.hpp \
+    commandhistory.hpp \
+    latencytracker.hpp \
+    triggerengine.hpp \
+    telemetrybuffer.hpp \
+    fieldextractor.hpp \
+    packetdecoder.hpp \
+    textdecoder.hpp \
+    capturewriter.hpp \
+    capturereader.hpp
+
+unix {
+    SOURCES += replayengine.cpp
+    HEADERS += replayengine.hpp
+}
+
+# epoll, a few threads serving every port
+linux {
+    SOURCES += portreactor.cpp reactorbackend.cpp
+    HEADERS += portreactor.hpp reactorbackend.hpp
+}
@@ -0,0 +1,193 @@
+#include "fieldextractor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include <QRegularExpression>
+#include <QStringList>
+
+bool FieldExtractor::Settings::parse_fields(const QString& text, std::vector<int>& fields, QString* error)
+{
+    std::vector<int> result;
+    for(const QString& token : text.split(QRegularExpression("[,;\\s]+"), Qt::SkipEmptyParts))
+    {
+        bool ok = false;
+        const int field = token.toInt(&ok);
+        if(!ok || field < 1)
+        {
+            if(error)
+            {
+                *error = QString("\"%1\" is not a field number").arg(token);
+            }
+            return false;
+        }
+        result.push_back(field - 1);
+    }
+    if(static_cast<int>(result.size()) > TelemetryBuffer::max_channels)
+    {
+        if(error)
+        {
+            *error = QString("at most %1 fields").arg(TelemetryBuffer::max_channels);
+        }
+        return false;
+    }
+    fields = result;
+    return true;
+}
+
+QString FieldExtractor::Settings::fields_to_string(const std::vector<int>& fields)
+{
+    QStringList tokens;
+    for(const int field : fields)
+    {
+        tokens << QString::number(field + 1);
+    }
+    return tokens.join(", ");
+}
+
+FieldExtractor::FieldExtractor() :
+    _settings(), _delimiter(), _partial(), _overflow(false)
+{
+    set_settings(Settings());
+}
+
+void FieldExtractor::set_settings(const Settings& settings)
+{
+    _settings = settings;
+    std::fill(std::begin(_delimiter), std::end(_delimiter), false);
+    for(const char c : _settings.delimiters)
+    {
+        _delimiter[static_cast<unsigned char>(c)] = true;
+    }
+    reset();
+}
+
+const FieldExtractor::Settings& FieldExtractor::settings() const
+{
+    return _settings;
+}
+
+void FieldExtractor::reset()
+{
+    _partial.clear();
+    _overflow = false;
+}
+
+std::size_t FieldExtractor::push(const char* data, std::size_t size, TelemetryBuffer& buffer)
+{
+    std::size_t rows = 0;
+    const char* const end = data + size;
+    while(data < end)
+    {
+        const char* newline = static_cast<const char*>(std::memchr(data, '\n', static_cast<std::size_t>(end - data)));
+        const char* stop = newline ? newline : end;
+        const std::size_t length = static_cast<std::size_t>(stop - data);
+
+        if(!_overflow && _partial.size() + static_cast<int>(length) > static_cast<int>(max_line))
+        {
+            _partial.clear();
+            _overflow = true;
+        }
+        if(!newline)
+        {
+            if(!_overflow)
+            {
+                _partial.append(data, static_cast<int>(length));
+            }
+            break;
+        }
+        if(_overflow)
+        {
+            // end of the skipped line
+            _overflow = false;
+        }
+        else if(_partial.isEmpty())
+        {
+            // whole line inside this read, no copy
+            rows += line(data, length, buffer) ? 1 : 0;
+        }
+        else
+        {
+            _partial.append(data, static_cast<int>(length));
+            rows += line(_partial.constData(), static_cast<std::size_t>(_partial.size()), buffer) ? 1 : 0;
+            _partial.clear();
+        }
+        data = newline + 1;
+    }
+    return rows;
+}
+
+bool FieldExtractor::line(const char* data, std::size_t size, TelemetryBuffer& buffer)
+{
+    if(size > 0 && data[size - 1] == '\r')
+    {
+        --size;
+    }
+    const std::size_t prefix = static_cast<std::size_t>(_settings.prefix.size());
+    if(prefix > 0)
+    {
+        if(size < prefix || std::memcmp(data, _settings.prefix.constData(), prefix) != 0)
+        {
+            return false;
+        }
+        data += prefix;
+        size -= prefix;
+    }
+
+    float values[TelemetryBuffer::max_channels];
+    std::fill(std::begin(values), std::end(values), std::numeric_limits<float>::quiet_NaN());
+    const std::vector<int>& fields = _settings.fields;
+    int count = 0;
+    bool found = false;
+
+    int field = 0;
+    std::size_t i = 0;
+    while(i < size && !(fields.empty() && count == TelemetryBuffer::max_channels))
+    {
+        if(_delimiter[static_cast<unsigned char>(data[i])])
+        {
+            ++i;
+            continue;
+        }
+        const std::size_t start = i;
+        while(i < size && !_delimiter[static_cast<unsigned char>(data[i])])
+        {
+            ++i;
+        }
+        bool ok = false;
+        const double value = QByteArray::fromRawData(data + start, static_cast<int>(i - start)).toDouble(&ok);
+        if(fields.empty())
+        {
+            if(ok)
+            {
+                values[count++] = static_cast<float>(value);
+                found = true;
+            }
+        }
+        else if(ok)
+        {
+            for(std::size_t c = 0; c < fields.size(); ++c)
+            {
+                if(fields[c] == field)
+                {
+                    values[c] = static_cast<float>(value);
+                    found = true;
+                }
+            }
+        }
+        ++field;
+    }
+    if(!found)
+    {
+        return false;
+    }
+
+    if(buffer.channels() == 0)
+    {
+        buffer.set_channels(fields.empty() ? count : static_cast<int>(fields.size()));
+    }
+    buffer.append(values, fields.empty() ? count : static_cast<int>(fields.size()));
+    return true;
+}
@@ -0,0 +1,64 @@
+#ifndef FIELDEXTRACTOR_HPP
+#define FIELDEXTRACTOR_HPP
+
+/*
+Pulls numbers out of received text lines for the plot. Lines end with \n,
+a trailing \r is dropped, a line split over reads is carried to the next
+push(). With a prefix only lines starting with it are used and the prefix
+is cut off. The rest is split on any of the delimiter characters, empty
+fields are skipped.
+
+Without a field list every numeric field of a line is a channel, the first
+line holding numbers decides how many. With one the listed fields are the
+channels in that order, a field that is missing or not a number is NaN.
+Numbers are parsed in the C locale whatever the system's is.
+*/
+
+#include <cstddef>
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+
+#include "telemetrybuffer.hpp"
+
+class FieldExtractor
+{
+public:
+
+    struct Settings
+    {
+        QByteArray delimiters = ",; \t";
+        // 0 based field numbers, empty for all numeric fields
+        std::vector<int> fields;
+        QByteArray prefix;
+
+        // field list as typed, 1 based numbers separated by commas or spaces
+        static bool parse_fields(const QString& text, std::vector<int>& fields, QString* error = nullptr);
+        static QString fields_to_string(const std::vector<int>& fields);
+    };
+
+    // longest line kept while waiting for its end
+    static const std::size_t max_line = 4096;
+
+    FieldExtractor();
+
+    // drops a partial line, the buffer is not touched
+    void set_settings(const Settings& settings);
+    const Settings& settings() const;
+    void reset();
+
+    // sets the buffer's channels when it has none yet, returns rows appended
+    std::size_t push(const char* data, std::size_t size, TelemetryBuffer& buffer);
+
+private:
+
+    bool line(const char* data, std::size_t size, TelemetryBuffer& buffer);
+
+    Settings _settings;
+    bool _delimiter[256];
+    QByteArray _partial;
+    bool _overflow;     // rest of an oversized line is skipped
+};
+
+#endif
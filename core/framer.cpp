@@ -0,0 +1,614 @@
+#include "framer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <QStringList>
+
+namespace
+{
+    const char slip_end = static_cast<char>(0xC0);
+    const char slip_esc = static_cast<char>(0xDB);
+    const char slip_esc_end = static_cast<char>(0xDC);
+    const char slip_esc_esc = static_cast<char>(0xDD);
+
+    const char* const mode_names[] = {"none", "delimiter", "nmea", "length", "slip", "cobs"};
+
+    QString escape_bytes(const QByteArray& bytes)
+    {
+        QString text;
+        for(const char byte : bytes)
+        {
+            if(byte == '\r')
+            {
+                text += "\\r";
+            }
+            else if(byte == '\n')
+            {
+                text += "\\n";
+            }
+            else if(byte == '\t')
+            {
+                text += "\\t";
+            }
+            else if(byte == '\\')
+            {
+                text += "\\\\";
+            }
+            else if(byte > ' ' && byte < 127)
+            {
+                text += QChar::fromLatin1(byte);
+            }
+            else
+            {
+                text += QString("\\x%1").arg(static_cast<int>(static_cast<unsigned char>(byte)), 2, 16, QChar('0'));
+            }
+        }
+        return text;
+    }
+
+    QByteArray unescape_bytes(const QString& text)
+    {
+        const QByteArray in = text.toLatin1();
+        QByteArray out;
+        for(int i = 0; i < in.size(); ++i)
+        {
+            if(in[i] != '\\' || i + 1 >= in.size())
+            {
+                out += in[i];
+                continue;
+            }
+            const char code = in[++i];
+            if(code == 'r')
+            {
+                out += '\r';
+            }
+            else if(code == 'n')
+            {
+                out += '\n';
+            }
+            else if(code == 't')
+            {
+                out += '\t';
+            }
+            else if(code == 'x' && i + 2 < in.size())
+            {
+                out += static_cast<char>(in.mid(i + 1, 2).toInt(nullptr, 16));
+                i += 2;
+            }
+            else
+            {
+                out += code;
+            }
+        }
+        return out;
+    }
+
+    int hex_value(char c)
+    {
+        if(c >= '0' && c <= '9')
+        {
+            return c - '0';
+        }
+        if(c >= 'a' && c <= 'f')
+        {
+            return c - 'a' + 10;
+        }
+        if(c >= 'A' && c <= 'F')
+        {
+            return c - 'A' + 10;
+        }
+        return -1;
+    }
+}
+
+QString Framer::Settings::to_string() const
+{
+    QStringList parts(mode_names[static_cast<int>(mode)]);
+    if(mode == MODE::DELIMITER)
+    {
+        parts << escape_bytes(delimiter);
+    }
+    else if(mode == MODE::LENGTH)
+    {
+        parts << QString::number(length_offset) << QString::number(length_size)
+              << (big_endian ? "be" : "le") << QString::number(length_adjust);
+    }
+    if(mode != MODE::NONE && mode != MODE::NMEA && checksum != Checksum::TYPE::NONE)
+    {
+        parts << Checksum::name(checksum);
+    }
+    return parts.join(' ');
+}
+
+bool Framer::Settings::from_string(const QString& text, Settings& settings, QString* error)
+{
+    QStringList parts = text.split(' ', Qt::SkipEmptyParts);
+    Settings result;
+    auto fail = [error, &text](const QString& reason)
+    {
+        if(error)
+        {
+            *error = QString("%1: %2").arg(text, reason);
+        }
+        return false;
+    };
+
+    const QString mode = parts.isEmpty() ? QString("none") : parts.takeFirst().toLower();
+    const auto name = std::find(std::begin(mode_names), std::end(mode_names), mode);
+    if(name == std::end(mode_names))
+    {
+        return fail("unknown framing");
+    }
+    result.mode = static_cast<MODE>(name - std::begin(mode_names));
+
+    if(result.mode == MODE::DELIMITER)
+    {
+        if(parts.isEmpty())
+        {
+            return fail("delimiter missing");
+        }
+        result.delimiter = unescape_bytes(parts.takeFirst());
+        if(result.delimiter.isEmpty())
+        {
+            return fail("delimiter missing");
+        }
+    }
+    else if(result.mode == MODE::LENGTH)
+    {
+        if(parts.size() < 4)
+        {
+            return fail("expected offset, size, be or le and adjustment");
+        }
+        bool offset_ok = false;
+        bool size_ok = false;
+        bool adjust_ok = false;
+        result.length_offset = parts.takeFirst().toInt(&offset_ok);
+        result.length_size = parts.takeFirst().toInt(&size_ok);
+        const QString order = parts.takeFirst().toLower();
+        result.length_adjust = parts.takeFirst().toInt(&adjust_ok);
+        if(!offset_ok || !size_ok || !adjust_ok || result.length_offset < 0 ||
+           (result.length_size != 1 && result.length_size != 2 && result.length_size != 4) ||
+           (order != "be" && order != "le"))
+        {
+            return fail("bad length field");
+        }
+        result.big_endian = order == "be";
+    }
+
+    if(!parts.isEmpty())
+    {
+        bool known = false;
+        result.checksum = Checksum::from_name(parts.join(' '), &known);
+        if(!known)
+        {
+            return fail("unknown checksum");
+        }
+    }
+
+    settings = result;
+    return true;
+}
+
+Framer::Framer() :
+    Framer(Settings())
+{
+
+}
+
+Framer::Framer(const Settings& settings) :
+    _settings(settings), _buffer(), _begin(0), _end(0), _scan(0), _resyncing(false), _stats{0, 0, 0, 0}
+{
+
+}
+
+QString Framer::name(const MODE& mode)
+{
+    return mode_names[static_cast<int>(mode)];
+}
+
+void Framer::set_settings(const Settings& settings)
+{
+    _settings = settings;
+    reset();
+}
+
+const Framer::Settings& Framer::settings() const
+{
+    return _settings;
+}
+
+bool Framer::enabled() const
+{
+    return _settings.mode != MODE::NONE;
+}
+
+void Framer::reset()
+{
+    _begin = 0;
+    _end = 0;
+    _scan = 0;
+    _resyncing = false;
+    _stats = Stats{0, 0, 0, 0};
+}
+
+void Framer::push(const char* data, std::size_t size)
+{
+    if(_begin == _end)
+    {
+        _begin = 0;
+        _end = 0;
+        _scan = 0;
+    }
+    else if(_begin > 0 && _buffer.size() - _end < size)
+    {
+        // only the unfinished frame moves
+        std::memmove(_buffer.data(), _buffer.data() + _begin, _end - _begin);
+        _end -= _begin;
+        _scan -= _begin;
+        _begin = 0;
+    }
+
+    if(_buffer.size() < _end + size)
+    {
+        _buffer.resize(std::max(_end + size, _buffer.size() * 2));
+    }
+    std::memcpy(_buffer.data() + _end, data, size);
+    _end += size;
+}
+
+bool Framer::next(Frame& frame)
+{
+    switch(_settings.mode)
+    {
+    case MODE::DELIMITER:
+        return next_delimited(frame);
+    case MODE::NMEA:
+        return next_nmea(frame);
+    case MODE::LENGTH:
+        return next_length(frame);
+    case MODE::SLIP:
+        return next_slip(frame);
+    case MODE::COBS:
+        return next_cobs(frame);
+    default:
+        // passthrough, every push is one frame
+        if(_begin == _end)
+        {
+            return false;
+        }
+        finish(frame, _buffer.data() + _begin, _end - _begin, STATUS::UNCHECKED);
+        _begin = _end;
+        return true;
+    }
+}
+
+Framer::Stats Framer::stats() const
+{
+    return _stats;
+}
+
+bool Framer::next_delimited(Frame& frame)
+{
+    const QByteArray& delimiter = _settings.delimiter;
+    const std::size_t length = static_cast<std::size_t>(delimiter.size());
+
+    while(true)
+    {
+        std::size_t found = find(delimiter[0]);
+        while(found < _end)
+        {
+            if(found + length > _end)
+            {
+                // delimiter may be completed by the next read
+                _scan = found;
+                found = _end;
+                break;
+            }
+            if(std::memcmp(_buffer.data() + found, delimiter.constData(), length) == 0)
+            {
+                break;
+            }
+            _scan = found + 1;
+            found = find(delimiter[0]);
+        }
+
+        if(found >= _end)
+        {
+            return oversized(frame);
+        }
+
+        const std::size_t begin = _begin;
+        _begin = found + length;
+        _scan = _begin;
+        if(found > begin)
+        {
+            finish(frame, _buffer.data() + begin, found - begin, STATUS::UNCHECKED);
+            return true;
+        }
+    }
+}
+
+bool Framer::next_nmea(Frame& frame)
+{
+    while(true)
+    {
+        // skip to start of sentence, line breaks between sentences are not noise
+        while(_begin < _end && _buffer[_begin] != '$' && _buffer[_begin] != '!')
+        {
+            if(_buffer[_begin] != '\r' && _buffer[_begin] != '\n')
+            {
+                ++_stats.skipped_bytes;
+            }
+            ++_begin;
+        }
+        _scan = std::max(_scan, _begin + 1);
+        if(_begin >= _end)
+        {
+            return false;
+        }
+
+        std::size_t position = _scan;
+        for(; position < _end; ++position)
+        {
+            const char byte = _buffer[position];
+            if(byte == '*' || byte == '\r' || byte == '\n' || byte == '$' || byte == '!')
+            {
+                break;
+            }
+        }
+        if(position >= _end)
+        {
+            _scan = _end;
+            return oversized(frame);
+        }
+
+        const char byte = _buffer[position];
+        if(byte == '*')
+        {
+            if(position + 2 >= _end)
+            {
+                _scan = position;
+                return false;
+            }
+            const std::size_t begin = _begin;
+            const std::size_t size = position + 3 - begin;
+            _begin = position + 3;
+            _scan = _begin;
+            finish(frame, _buffer.data() + begin, size, verify_nmea(_buffer.data() + begin, size));
+            return true;
+        }
+
+        // sentence without checksum, or cut short by the next one
+        const std::size_t begin = _begin;
+        _begin = position;
+        _scan = _begin + 1;
+        if(byte == '$' || byte == '!')
+        {
+            finish(frame, _buffer.data() + begin, position - begin, STATUS::MALFORMED);
+        }
+        else
+        {
+            finish(frame, _buffer.data() + begin, position - begin, STATUS::UNCHECKED);
+        }
+        return true;
+    }
+}
+
+bool Framer::next_length(Frame& frame)
+{
+    const std::size_t header = static_cast<std::size_t>(_settings.length_offset + _settings.length_size);
+    while(_end - _begin >= header)
+    {
+        const unsigned char* field = reinterpret_cast<const unsigned char*>(_buffer.data() + _begin + _settings.length_offset);
+        std::int64_t length = 0;
+        for(int i = 0; i < _settings.length_size; ++i)
+        {
+            const int index = _settings.big_endian ? i : _settings.length_size - 1 - i;
+            length = (length << 8) | field[index];
+        }
+
+        const std::int64_t total = static_cast<std::int64_t>(header) + length + _settings.length_adjust;
+        if(total < static_cast<std::int64_t>(header) || total > static_cast<std::int64_t>(_settings.max_frame))
+        {
+            // lost sync, try one byte later, the whole run counts as one malformed frame
+            if(!_resyncing)
+            {
+                ++_stats.malformed;
+                _resyncing = true;
+            }
+            ++_stats.skipped_bytes;
+            ++_begin;
+            continue;
+        }
+        _resyncing = false;
+        if(_end - _begin < static_cast<std::size_t>(total))
+        {
+            return false;
+        }
+
+        const std::size_t begin = _begin;
+        _begin += static_cast<std::size_t>(total);
+        _scan = _begin;
+        finish(frame, _buffer.data() + begin, static_cast<std::size_t>(total), STATUS::UNCHECKED);
+        return true;
+    }
+    return false;
+}
+
+bool Framer::next_slip(Frame& frame)
+{
+    while(true)
+    {
+        const std::size_t found = find(slip_end);
+        if(found >= _end)
+        {
+            return oversized(frame);
+        }
+
+        char* const begin = _buffer.data() + _begin;
+        const char* in = begin;
+        const char* const end = _buffer.data() + found;
+        _begin = found + 1;
+        _scan = _begin;
+        if(in == end)
+        {
+            continue;
+        }
+
+        char* out = begin;
+        STATUS status = STATUS::UNCHECKED;
+        while(in < end)
+        {
+            const char byte = *in++;
+            if(byte != slip_esc)
+            {
+                *out++ = byte;
+            }
+            else if(in < end && (*in == slip_esc_end || *in == slip_esc_esc))
+            {
+                *out++ = *in++ == slip_esc_end ? slip_end : slip_esc;
+            }
+            else
+            {
+                status = STATUS::MALFORMED;
+            }
+        }
+        finish(frame, begin, static_cast<std::size_t>(out - begin), status);
+        return true;
+    }
+}
+
+bool Framer::next_cobs(Frame& frame)
+{
+    while(true)
+    {
+        const std::size_t found = find('\0');
+        if(found >= _end)
+        {
+            return oversized(frame);
+        }
+
+        char* const begin = _buffer.data() + _begin;
+        const char* in = begin;
+        const char* const end = _buffer.data() + found;
+        _begin = found + 1;
+        _scan = _begin;
+        if(in == end)
+        {
+            continue;
+        }
+
+        // output never overtakes input, every block loses its code byte
+        char* out = begin;
+        STATUS status = STATUS::UNCHECKED;
+        while(in < end)
+        {
+            const unsigned code = static_cast<unsigned char>(*in++);
+            const std::size_t count = code - 1;
+            if(static_cast<std::size_t>(end - in) < count)
+            {
+                status = STATUS::MALFORMED;
+                break;
+            }
+            std::memmove(out, in, count);
+            out += count;
+            in += count;
+            if(code != 0xFF && in < end)
+            {
+                *out++ = '\0';
+            }
+        }
+        finish(frame, begin, static_cast<std::size_t>(out - begin), status);
+        return true;
+    }
+}
+
+std::size_t Framer::find(char byte)
+{
+    _scan = std::max(_scan, _begin);
+    const void* found = std::memchr(_buffer.data() + _scan, byte, _end - _scan);
+    return found ? static_cast<std::size_t>(static_cast<const char*>(found) - _buffer.data()) : _end;
+}
+
+bool Framer::oversized(Frame& frame)
+{
+    if(_end - _begin <= _settings.max_frame)
+    {
+        return false;
+    }
+    // no end in sight, hand out what we have so the buffer stays bounded
+    const std::size_t begin = _begin;
+    _begin += _settings.max_frame;
+    _scan = _begin;
+    finish(frame, _buffer.data() + begin, _settings.max_frame, STATUS::MALFORMED);
+    return true;
+}
+
+void Framer::finish(Frame& frame, char* data, std::size_t size, STATUS status)
+{
+    frame.data = data;
+    frame.size = size;
+    frame.status = status;
+    ++_stats.frames;
+
+    if(status == STATUS::MALFORMED)
+    {
+        ++_stats.malformed;
+        return;
+    }
+
+    const Checksum::TYPE type = _settings.checksum;
+    if(_settings.mode == MODE::NMEA || _settings.mode == MODE::NONE || type == Checksum::TYPE::NONE)
+    {
+        if(status == STATUS::BAD_CHECKSUM)
+        {
+            ++_stats.bad_checksum;
+        }
+        return;
+    }
+
+    if(type == Checksum::TYPE::NMEA_XOR)
+    {
+        frame.status = verify_nmea(data, size);
+        if(frame.status == STATUS::UNCHECKED)
+        {
+            frame.status = STATUS::BAD_CHECKSUM;
+        }
+    }
+    else
+    {
+        const std::size_t length = static_cast<std::size_t>(Checksum::appended_size(type));
+        if(size < length)
+        {
+            frame.status = STATUS::MALFORMED;
+            ++_stats.malformed;
+            return;
+        }
+        char expected[4];
+        Checksum::encode(type, Checksum::compute(type, data, size - length), expected);
+        frame.status = std::memcmp(expected, data + size - length, length) == 0 ? STATUS::VALID : STATUS::BAD_CHECKSUM;
+    }
+    if(frame.status == STATUS::BAD_CHECKSUM)
+    {
+        ++_stats.bad_checksum;
+    }
+}
+
+Framer::STATUS Framer::verify_nmea(const char* data, std::size_t size) const
+{
+    if(size < 3 || data[size - 3] != '*')
+    {
+        return STATUS::UNCHECKED;
+    }
+    const int high = hex_value(data[size - 2]);
+    const int low = hex_value(data[size - 1]);
+    if(high < 0 || low < 0)
+    {
+        return STATUS::BAD_CHECKSUM;
+    }
+    // $ or ! is not covered
+    const std::size_t skip = size > 3 && (data[0] == '$' || data[0] == '!') ? 1 : 0;
+    const std::uint8_t crc = Checksum::nmea_xor(data + skip, size - 3 - skip);
+    return crc == ((high << 4) | low) ? STATUS::VALID : STATUS::BAD_CHECKSUM;
+}
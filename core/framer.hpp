@@ -0,0 +1,125 @@
+#ifndef FRAMER_HPP
+#define FRAMER_HPP
+
+/*
+Incremental frame parser between the port and everything that consumes
+received data. Bytes are pushed as they arrive, whole frames come out
+regardless of how reads split or packed them. Frames are slices of the
+internal buffer, SLIP and COBS are decoded in place, so nothing is copied
+or allocated per frame. Checksums are checked while framing.
+
+    DELIMITER   frame ends with delimiter, delimiter not included
+    NMEA        $ or ! up to *hh or end of line, checksum checked when present
+    LENGTH      header with length field, frame is
+                length_offset + length_size + length + length_adjust bytes
+    SLIP        RFC 1055, END separated
+    COBS        zero separated
+
+Text form used for settings and command line, e.g. "delimiter \r\n",
+"nmea", "length 1 2 be 2 crc-16/modbus", "cobs crc-32".
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+
+#include "checksum.hpp"
+
+class Framer
+{
+public:
+
+    enum class MODE : std::uint8_t
+    {
+        NONE = 0,
+        DELIMITER,
+        NMEA,
+        LENGTH,
+        SLIP,
+        COBS
+    };
+
+    enum class STATUS : std::uint8_t
+    {
+        UNCHECKED = 0,  // no checksum configured or present
+        VALID,
+        BAD_CHECKSUM,
+        MALFORMED       // oversized, bad escape or length
+    };
+
+    struct Settings
+    {
+        MODE mode = MODE::NONE;
+        QByteArray delimiter = "\r\n";
+        int length_offset = 0;
+        int length_size = 1;
+        bool big_endian = true;
+        int length_adjust = 0;
+        // trailing checksum over the rest of the frame, NMEA always uses *hh
+        Checksum::TYPE checksum = Checksum::TYPE::NONE;
+        std::size_t max_frame = 64 * 1024;
+
+        QString to_string() const;
+        static bool from_string(const QString& text, Settings& settings, QString* error = nullptr);
+    };
+
+    struct Frame
+    {
+        const char* data;
+        std::size_t size;
+        STATUS status;
+    };
+
+    struct Stats
+    {
+        std::uint64_t frames;
+        std::uint64_t bad_checksum;
+        std::uint64_t malformed;
+        std::uint64_t skipped_bytes;    // noise between frames
+    };
+
+    Framer();
+    explicit Framer(const Settings& settings);
+
+    // lower case name used in the text form of Settings
+    static QString name(const MODE& mode);
+
+    // drops buffered data and statistics
+    void set_settings(const Settings& settings);
+    const Settings& settings() const;
+    bool enabled() const;
+    void reset();
+
+    // frames from next() stay valid until the following push()
+    void push(const char* data, std::size_t size);
+    bool next(Frame& frame);
+
+    Stats stats() const;
+
+private:
+
+    bool next_delimited(Frame& frame);
+    bool next_nmea(Frame& frame);
+    bool next_length(Frame& frame);
+    bool next_slip(Frame& frame);
+    bool next_cobs(Frame& frame);
+
+    // searches for byte from _scan, remembers where to resume
+    std::size_t find(char byte);
+    bool oversized(Frame& frame);
+    void finish(Frame& frame, char* data, std::size_t size, STATUS status);
+    STATUS verify_nmea(const char* data, std::size_t size) const;
+
+    Settings _settings;
+    std::vector<char> _buffer;
+    std::size_t _begin;     // first unconsumed byte
+    std::size_t _end;       // end of valid data
+    std::size_t _scan;      // searched up to here for current frame
+    bool _resyncing;        // skipping bytes after a bad length field
+    Stats _stats;
+};
+
+#endif
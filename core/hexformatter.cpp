@@ -0,0 +1,96 @@
+#include "hexformatter.hpp"
+
+#include <cstring>
+
+namespace
+{
+    const std::size_t token_length = 6;
+    const std::size_t store_slack = 8 - token_length;
+    const char digits[] = "0123456789abcdef";
+
+    bool is_alphanumeric(unsigned value)
+    {
+        return (value >= '0' && value <= '9') || (value >= 'A' && value <= 'Z') || (value >= 'a' && value <= 'z');
+    }
+
+    bool is_extended(unsigned value)
+    {
+        return value >= 33 && value <= 126;
+    }
+}
+
+HexFormatter::HexFormatter(bool protect_alphanumeric, bool protect_extended) :
+    _protect_alphanumeric(protect_alphanumeric), _protect_extended(protect_extended), _text(), _length()
+{
+    build_table();
+}
+
+void HexFormatter::set_protect_alphanumeric(bool protect)
+{
+    if(_protect_alphanumeric != protect)
+    {
+        _protect_alphanumeric = protect;
+        build_table();
+    }
+}
+
+bool HexFormatter::protect_alphanumeric() const
+{
+    return _protect_alphanumeric;
+}
+
+void HexFormatter::set_protect_extended(bool protect)
+{
+    if(_protect_extended != protect)
+    {
+        _protect_extended = protect;
+        build_table();
+    }
+}
+
+bool HexFormatter::protect_extended() const
+{
+    return _protect_extended;
+}
+
+std::size_t HexFormatter::output_capacity(std::size_t size)
+{
+    return size * token_length + store_slack;
+}
+
+std::size_t HexFormatter::format(const char* data, std::size_t size, char* out) const
+{
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(data);
+    char* position = out;
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        std::memcpy(position, &_text[in[i]], sizeof(std::uint64_t));
+        position += _length[in[i]];
+    }
+    return static_cast<std::size_t>(position - out);
+}
+
+void HexFormatter::build_table()
+{
+    for(unsigned value = 0; value < 256; ++value)
+    {
+        char text[8] = {};
+        std::uint8_t length;
+        if((_protect_alphanumeric && is_alphanumeric(value)) || (_protect_extended && is_extended(value)))
+        {
+            text[0] = static_cast<char>(value);
+            length = 1;
+        }
+        else
+        {
+            std::memcpy(text, " 0x", 3);
+            text[3] = digits[value >> 4];
+            text[4] = digits[value & 0xF];
+            text[5] = ' ';
+            length = token_length;
+        }
+
+        std::memcpy(&_text[value], text, sizeof(text));
+        _length[value] = length;
+    }
+}
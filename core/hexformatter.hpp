@@ -0,0 +1,47 @@
+#ifndef HEXFORMATTER_HPP
+#define HEXFORMATTER_HPP
+
+/*
+Table driven formatter for hex display mode. Every byte is rendered as
+" 0xNN " unless protected, in which case it is copied as is. Output goes
+into a single caller provided buffer, one table lookup and one 8 byte store
+per input byte.
+*/
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+class HexFormatter
+{
+public:
+
+    explicit HexFormatter(bool protect_alphanumeric = false, bool protect_extended = false);
+
+    // keep [0-9A-Za-z] as characters
+    void set_protect_alphanumeric(bool protect);
+    bool protect_alphanumeric() const;
+
+    // keep printable ASCII (33 - 126) as characters
+    void set_protect_extended(bool protect);
+    bool protect_extended() const;
+
+    // size of buffer format() needs for size input bytes, includes store slack
+    static std::size_t output_capacity(std::size_t size);
+
+    // formats data into out and returns number of characters written
+    std::size_t format(const char* data, std::size_t size, char* out) const;
+
+private:
+
+    void build_table();
+
+    bool _protect_alphanumeric;
+    bool _protect_extended;
+
+    // token text padded to 8 bytes so it is written with a single store
+    std::array<std::uint64_t, 256> _text;
+    std::array<std::uint8_t, 256> _length;
+};
+
+#endif
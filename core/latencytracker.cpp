@@ -0,0 +1,290 @@
+#include "latencytracker.hpp"
+
+#include <algorithm>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+
+namespace
+{
+    // received data kept while looking for a pattern
+    const int response_limit = 64 * 1024;
+    // commands listed by text()
+    const int text_commands = 8;
+
+    QString milliseconds(std::int64_t ns)
+    {
+        return QString::number(static_cast<double>(ns) / 1e6, 'f', 3);
+    }
+}
+
+LatencyTracker::LatencyTracker() :
+    _pattern(), _timeout(1000000000), _pending(), _written(0), _written_at(0), _response(), _records()
+{
+
+}
+
+bool LatencyTracker::set_pattern(const QString& pattern, QString* error)
+{
+    QRegularExpression expression(pattern);
+    if(!pattern.isEmpty() && !expression.isValid())
+    {
+        if(error)
+        {
+            *error = expression.errorString();
+        }
+        return false;
+    }
+    _pattern = pattern.isEmpty() ? QRegularExpression() : expression;
+    _response.clear();
+    return true;
+}
+
+void LatencyTracker::set_timeout(std::int64_t timeout)
+{
+    _timeout = std::max<std::int64_t>(timeout, 1);
+}
+
+std::int64_t LatencyTracker::timeout() const
+{
+    return _timeout;
+}
+
+void LatencyTracker::sent(const QString& command, std::uint64_t end, std::int64_t now)
+{
+    _pending.push_back(Pending{command, end, now, end <= _written ? _written_at : 0});
+}
+
+void LatencyTracker::written(std::uint64_t end, std::int64_t timestamp)
+{
+    _written = end;
+    _written_at = timestamp;
+    for(Pending& pending : _pending)
+    {
+        if(pending.end > end)
+        {
+            break;
+        }
+        if(pending.written == 0)
+        {
+            pending.written = timestamp;
+        }
+    }
+}
+
+void LatencyTracker::received(const QByteArray& data, std::int64_t timestamp)
+{
+    // data older than the command in front answers something else
+    if(_pending.empty() || _pending.front().written == 0 || _pending.front().written > timestamp)
+    {
+        _response.clear();
+        return;
+    }
+
+    if(_pattern.pattern().isEmpty())
+    {
+        complete(timestamp);
+        return;
+    }
+
+    _response.append(data);
+    if(_response.size() > response_limit)
+    {
+        _response.remove(0, _response.size() - response_limit);
+    }
+    while(!_pending.empty() && _pending.front().written != 0 && _pending.front().written <= timestamp)
+    {
+        const QRegularExpressionMatch match = _pattern.match(QString::fromLatin1(_response));
+        if(!match.hasMatch())
+        {
+            return;
+        }
+        complete(timestamp);
+        _response.remove(0, match.capturedEnd());
+    }
+    if(_pending.empty())
+    {
+        _response.clear();
+    }
+}
+
+void LatencyTracker::expire(std::int64_t now)
+{
+    while(!_pending.empty())
+    {
+        const Pending& pending = _pending.front();
+        const std::int64_t since = pending.written != 0 ? pending.written : pending.queued;
+        if(now - since <= _timeout)
+        {
+            return;
+        }
+        time_out();
+    }
+}
+
+void LatencyTracker::cancel()
+{
+    _pending.clear();
+    _response.clear();
+}
+
+void LatencyTracker::clear()
+{
+    _pending.clear();
+    _response.clear();
+    _records.clear();
+}
+
+std::size_t LatencyTracker::pending() const
+{
+    return _pending.size();
+}
+
+std::vector<LatencyTracker::Summary> LatencyTracker::summaries() const
+{
+    std::vector<Summary> result;
+    result.reserve(_records.size());
+    for(const auto& record : _records)
+    {
+        result.push_back(summary(record.first, record.second));
+    }
+    return result;
+}
+
+QString LatencyTracker::text() const
+{
+    std::vector<Summary> all = summaries();
+    std::sort(all.begin(), all.end(), [](const Summary& a, const Summary& b)
+    {
+        return a.count + a.timeouts > b.count + b.timeouts;
+    });
+
+    QStringList lines;
+    lines << QString("%1 commands, %2 waiting for a response").arg(all.size()).arg(_pending.size());
+    for(std::size_t i = 0; i < all.size() && i < static_cast<std::size_t>(text_commands); ++i)
+    {
+        const Summary& command = all[i];
+        if(command.count == 0)
+        {
+            lines << QString("%1: %2 timeouts").arg(command.command).arg(command.timeouts);
+            continue;
+        }
+        lines << QString("%1: %2 x, min %3 avg %4 p99 %5 max %6 ms, %7 timeouts")
+                 .arg(command.command).arg(command.count)
+                 .arg(milliseconds(command.min), milliseconds(command.mean), milliseconds(command.p99), milliseconds(command.max))
+                 .arg(command.timeouts);
+    }
+    if(all.size() > static_cast<std::size_t>(text_commands))
+    {
+        lines << QString("and %1 more").arg(all.size() - static_cast<std::size_t>(text_commands));
+    }
+    return lines.join('\n');
+}
+
+QString LatencyTracker::csv() const
+{
+    QStringList rows;
+    rows << "command,sent_ns,latency_ns";
+    for(const auto& record : _records)
+    {
+        QString command = record.first;
+        command.replace('"', "\"\"");
+        command = "\"" + command + "\"";
+        for(const auto& sample : record.second.samples)
+        {
+            rows << QString("%1,%2,%3").arg(command).arg(sample.first)
+                    .arg(sample.second >= 0 ? QString::number(sample.second) : QString());
+        }
+    }
+    return rows.join('\n') + '\n';
+}
+
+QByteArray LatencyTracker::json() const
+{
+    QJsonArray commands;
+    for(const auto& record : _records)
+    {
+        const Summary total = summary(record.first, record.second);
+        QJsonObject object;
+        object["command"] = total.command;
+        object["count"] = static_cast<double>(total.count);
+        object["timeouts"] = static_cast<double>(total.timeouts);
+        object["min_ns"] = static_cast<double>(total.min);
+        object["max_ns"] = static_cast<double>(total.max);
+        object["mean_ns"] = static_cast<double>(total.mean);
+        object["p99_ns"] = static_cast<double>(total.p99);
+        QJsonArray samples;
+        for(const auto& sample : record.second.samples)
+        {
+            samples.append(QJsonArray{static_cast<double>(sample.first),
+                                      sample.second >= 0 ? QJsonValue(static_cast<double>(sample.second)) : QJsonValue()});
+        }
+        object["samples"] = samples;
+        commands.append(object);
+    }
+    QJsonObject root;
+    root["pattern"] = _pattern.pattern();
+    root["timeout_ns"] = static_cast<double>(_timeout);
+    root["commands"] = commands;
+    return QJsonDocument(root).toJson();
+}
+
+void LatencyTracker::complete(std::int64_t timestamp)
+{
+    const Pending pending = _pending.front();
+    _pending.pop_front();
+
+    const std::int64_t latency = timestamp - pending.written;
+    Record& record = _records[pending.command];
+    record.min = record.count == 0 ? latency : std::min(record.min, latency);
+    record.max = record.count == 0 ? latency : std::max(record.max, latency);
+    record.sum += latency;
+    ++record.count;
+    if(record.samples.size() < sample_limit)
+    {
+        record.samples.emplace_back(pending.written, latency);
+    }
+}
+
+void LatencyTracker::time_out()
+{
+    const Pending pending = _pending.front();
+    _pending.pop_front();
+    _response.clear();
+
+    Record& record = _records[pending.command];
+    ++record.timeouts;
+    if(record.samples.size() < sample_limit)
+    {
+        record.samples.emplace_back(pending.written != 0 ? pending.written : pending.queued, -1);
+    }
+}
+
+LatencyTracker::Summary LatencyTracker::summary(const QString& command, const Record& record)
+{
+    Summary result{command, record.count, record.timeouts, record.min, record.max, 0, 0};
+    if(record.count == 0)
+    {
+        return result;
+    }
+    result.mean = record.sum / static_cast<std::int64_t>(record.count);
+
+    std::vector<std::int64_t> latencies;
+    latencies.reserve(record.samples.size());
+    for(const auto& sample : record.samples)
+    {
+        if(sample.second >= 0)
+        {
+            latencies.push_back(sample.second);
+        }
+    }
+    if(!latencies.empty())
+    {
+        const std::size_t rank = (latencies.size() * 99 + 99) / 100 - 1;
+        std::nth_element(latencies.begin(), latencies.begin() + static_cast<std::ptrdiff_t>(rank), latencies.end());
+        result.p99 = latencies[rank];
+    }
+    return result;
+}
@@ -0,0 +1,105 @@
+#ifndef LATENCYTRACKER_HPP
+#define LATENCYTRACKER_HPP
+
+/*
+Pairs every sent command with the first response after it and keeps the
+latency per command. Commands wait in order of sending, a command is only
+timed once the port worker reports the block holding its last byte handed
+to the driver, so queueing in the GUI and the TX queue does not count.
+
+A response is any received data, or with a pattern the first match in data
+received since the previous response. Commands without a response within
+the timeout count as timeouts and are not part of the statistics.
+*/
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <vector>
+
+#include <QByteArray>
+#include <QRegularExpression>
+#include <QString>
+
+class LatencyTracker
+{
+public:
+
+    struct Summary
+    {
+        QString command;
+        std::uint64_t count;
+        std::uint64_t timeouts;
+        // nanoseconds
+        std::int64_t min;
+        std::int64_t max;
+        std::int64_t mean;
+        std::int64_t p99;
+    };
+
+    // samples kept per command for the percentile, count, min, max and mean cover all of them
+    static const std::size_t sample_limit = 100000;
+
+    LatencyTracker();
+
+    // empty pattern takes any data as the response, false and error when it does not compile
+    bool set_pattern(const QString& pattern, QString* error = nullptr);
+    void set_timeout(std::int64_t timeout);
+    std::int64_t timeout() const;
+
+    // end is the position of the command's last byte in the port's TX stream, now when it was queued
+    void sent(const QString& command, std::uint64_t end, std::int64_t now);
+    // the port handed everything before end to the driver at timestamp
+    void written(std::uint64_t end, std::int64_t timestamp);
+    void received(const QByteArray& data, std::int64_t timestamp);
+    // drops commands that waited longer than the timeout
+    void expire(std::int64_t now);
+    // forgets commands still waiting, they count neither as answered nor as timed out
+    void cancel();
+    void clear();
+
+    std::size_t pending() const;
+    std::vector<Summary> summaries() const;
+    QString text() const;
+
+    // one row per answered or timed out command, latency_ns is empty for timeouts
+    QString csv() const;
+    // summaries and samples
+    QByteArray json() const;
+
+private:
+
+    struct Pending
+    {
+        QString command;
+        std::uint64_t end;
+        std::int64_t queued;
+        std::int64_t written;   // 0 until the worker reports it
+    };
+
+    struct Record
+    {
+        std::uint64_t count = 0;
+        std::uint64_t timeouts = 0;
+        std::int64_t min = 0;
+        std::int64_t max = 0;
+        std::int64_t sum = 0;
+        // send time and latency, latency -1 for a timeout
+        std::vector<std::pair<std::int64_t, std::int64_t> > samples;
+    };
+
+    void complete(std::int64_t timestamp);
+    void time_out();
+    static Summary summary(const QString& command, const Record& record);
+
+    QRegularExpression _pattern;
+    std::int64_t _timeout;
+    std::deque<Pending> _pending;
+    std::uint64_t _written;
+    std::int64_t _written_at;
+    // received since the last response, only with a pattern
+    QByteArray _response;
+    std::map<QString, Record> _records;
+};
+
+#endif
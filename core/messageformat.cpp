@@ -0,0 +1,97 @@
+#include "messageformat.hpp"
+
+MessageFormat::MessageFormat() :
+    _checksum(Checksum::TYPE::NONE), _dollar(false), _line_ending(LINE_ENDING::RN)
+{
+
+}
+
+void MessageFormat::set_checksum(const Checksum::TYPE& checksum)
+{
+    _checksum = checksum;
+}
+
+Checksum::TYPE MessageFormat::checksum() const
+{
+    return _checksum;
+}
+
+void MessageFormat::set_dollar(bool dollar)
+{
+    _dollar = dollar;
+}
+
+bool MessageFormat::dollar() const
+{
+    return _dollar;
+}
+
+void MessageFormat::set_line_ending(const LINE_ENDING& ending)
+{
+    _line_ending = ending;
+}
+
+MessageFormat::LINE_ENDING MessageFormat::line_ending() const
+{
+    return _line_ending;
+}
+
+QByteArray MessageFormat::frame(const QString& message) const
+{
+    const QByteArray text = message.toLatin1();
+
+    QByteArray out;
+    out.reserve(text.size() + 1 + Checksum::appended_size(_checksum) + 2);
+    if(_dollar)
+    {
+        out += '$';
+    }
+    const int start = out.size();
+
+    const char* in = text.constData();
+    const char* end = in + text.size();
+    while(in < end)
+    {
+        if(*in == '\\' && in + 1 < end && (in[1] == 'r' || in[1] == 'n' || in[1] == 't'))
+        {
+            out += in[1] == 'r' ? '\r' : in[1] == 'n' ? '\n' : '\t';
+            in += 2;
+        }
+        else
+        {
+            out += *in++;
+        }
+    }
+
+    if(_checksum != Checksum::TYPE::NONE)
+    {
+        const std::uint32_t value = Checksum::compute(_checksum, out.constData() + start,
+                                                      static_cast<std::size_t>(out.size() - start));
+        Checksum::append(_checksum, value, out);
+    }
+    if(_line_ending == LINE_ENDING::N)
+    {
+        out += '\n';
+    }
+    else if(_line_ending == LINE_ENDING::RN)
+    {
+        out += "\r\n";
+    }
+    return out;
+}
+
+QString MessageFormat::unescape(QString message)
+{
+    message.replace("\\r", QChar('\r'));
+    message.replace("\\n", QChar('\n'));
+    message.replace("\\t", QChar('\t'));
+    return message;
+}
+
+QString MessageFormat::escape(QString message)
+{
+    message.replace(QChar('\r'), "\\r");
+    message.replace(QChar('\n'), "\\n");
+    message.replace(QChar('\t'), "\\t");
+    return message;
+}
@@ -0,0 +1,52 @@
+#ifndef MESSAGEFORMAT_HPP
+#define MESSAGEFORMAT_HPP
+
+/*
+Turns a command as typed by the user into bytes sent to the port: escape
+sequences, checksum, leading $ and line ending. Framing works on bytes in a
+single pass into a buffer sized up front; callers sending the same command
+repeatedly keep the result instead of framing again.
+*/
+
+#include <QByteArray>
+#include <QString>
+
+#include "checksum.hpp"
+
+class MessageFormat
+{
+public:
+
+    enum class LINE_ENDING
+    {
+        NONE = 0,
+        N,
+        RN
+    };
+
+    MessageFormat();
+
+    // checksum covers the command after unescaping, without $ and line ending
+    void set_checksum(const Checksum::TYPE& checksum);
+    Checksum::TYPE checksum() const;
+
+    void set_dollar(bool dollar);
+    bool dollar() const;
+
+    void set_line_ending(const LINE_ENDING& ending);
+    LINE_ENDING line_ending() const;
+
+    QByteArray frame(const QString& message) const;
+
+    // \r, \n and \t as typed in the console and stored in command files
+    static QString unescape(QString message);
+    static QString escape(QString message);
+
+private:
+
+    Checksum::TYPE _checksum;
+    bool _dollar;
+    LINE_ENDING _line_ending;
+};
+
+#endif
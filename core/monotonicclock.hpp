@@ -0,0 +1,29 @@
+#ifndef MONOTONICCLOCK_HPP
+#define MONOTONICCLOCK_HPP
+
+/*
+Nanosecond timestamps from monotonic clock, used to stamp port traffic.
+On POSIX systems this is CLOCK_MONOTONIC read directly, the same clock the
+scheduler's timerfd runs on, elsewhere steady_clock.
+*/
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <time.h>
+#endif
+
+inline std::int64_t monotonic_ns()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<std::int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+#endif
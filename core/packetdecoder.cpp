@@ -0,0 +1,520 @@
+#include "packetdecoder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include <QRegularExpression>
+
+namespace
+{
+    bool set_error(QString* error, const QString& text)
+    {
+        if(error)
+        {
+            *error = text;
+        }
+        return false;
+    }
+
+    struct TypeName
+    {
+        const char* name;
+        PacketDecoder::TYPE type;
+    };
+
+    const TypeName type_names[] = {
+        {"u8", PacketDecoder::TYPE::U8}, {"i8", PacketDecoder::TYPE::I8},
+        {"u16", PacketDecoder::TYPE::U16}, {"i16", PacketDecoder::TYPE::I16},
+        {"u32", PacketDecoder::TYPE::U32}, {"i32", PacketDecoder::TYPE::I32},
+        {"u64", PacketDecoder::TYPE::U64}, {"i64", PacketDecoder::TYPE::I64},
+        {"f32", PacketDecoder::TYPE::F32}, {"f64", PacketDecoder::TYPE::F64}
+    };
+
+    bool is_float(PacketDecoder::TYPE type)
+    {
+        return type == PacketDecoder::TYPE::F32 || type == PacketDecoder::TYPE::F64;
+    }
+
+    template<typename T, bool BIG>
+    std::uint64_t load_bits(const unsigned char* data)
+    {
+        // constant trip count, compilers turn this into a load and a byte swap
+        std::uint64_t bits = 0;
+        for(std::size_t i = 0; i < sizeof(T); ++i)
+        {
+            bits |= static_cast<std::uint64_t>(data[i]) << (8 * (BIG ? sizeof(T) - 1 - i : i));
+        }
+        return bits;
+    }
+
+    template<typename T, bool BIG>
+    double load_integer(const unsigned char* data, std::int64_t& raw)
+    {
+        const T value = static_cast<T>(load_bits<T, BIG>(data));
+        raw = static_cast<std::int64_t>(value);
+        return static_cast<double>(value);
+    }
+
+    template<typename T, bool BIG>
+    double load_float(const unsigned char* data, std::int64_t& raw)
+    {
+        using Bits = typename std::conditional<sizeof(T) == 4, std::uint32_t, std::uint64_t>::type;
+        const Bits bits = static_cast<Bits>(load_bits<T, BIG>(data));
+        T value;
+        std::memcpy(&value, &bits, sizeof(value));
+        const bool representable = std::isfinite(value) && std::fabs(value) < 9.2e18;
+        raw = representable ? static_cast<std::int64_t>(value) : 0;
+        return static_cast<double>(value);
+    }
+
+    using Load = double (*)(const unsigned char* data, std::int64_t& raw);
+
+    // by TYPE, little and big endian
+    const Load loads[][2] = {
+        {load_integer<std::uint8_t, false>, load_integer<std::uint8_t, true>},
+        {load_integer<std::int8_t, false>, load_integer<std::int8_t, true>},
+        {load_integer<std::uint16_t, false>, load_integer<std::uint16_t, true>},
+        {load_integer<std::int16_t, false>, load_integer<std::int16_t, true>},
+        {load_integer<std::uint32_t, false>, load_integer<std::uint32_t, true>},
+        {load_integer<std::int32_t, false>, load_integer<std::int32_t, true>},
+        {load_integer<std::uint64_t, false>, load_integer<std::uint64_t, true>},
+        {load_integer<std::int64_t, false>, load_integer<std::int64_t, true>},
+        {load_float<float, false>, load_float<float, true>},
+        {load_float<double, false>, load_float<double, true>}
+    };
+
+    // offsets and lengths in a schema stay below this, sums of them never wrap
+    const std::uint32_t max_packet = 64 * 1024;
+
+    bool to_number(const QString& text, std::uint32_t& number, std::uint32_t maximum)
+    {
+        bool ok = false;
+        const qulonglong value = text.toULongLong(&ok, 0);
+        number = static_cast<std::uint32_t>(value);
+        return ok && value <= maximum;
+    }
+
+    // one past the last byte, saturated for packets set up without parse()
+    std::uint32_t end_of(std::uint32_t offset, std::uint64_t size)
+    {
+        return static_cast<std::uint32_t>(std::min<std::uint64_t>(offset + size, std::numeric_limits<std::uint32_t>::max()));
+    }
+}
+
+bool PacketDecoder::Field::from_string(const QString& line, Field& field, QString* error)
+{
+    const QStringList tokens = line.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+    field = Field();
+    if(tokens.size() < 3)
+    {
+        return set_error(error, QString("\"%1\": expected <name> <offset> <type>").arg(line));
+    }
+    field.name = tokens[0];
+    if(!to_number(tokens[1], field.offset, max_packet - 1))
+    {
+        return set_error(error, QString("\"%1\": bad offset %2").arg(line, tokens[1]));
+    }
+
+    QString type = tokens[2].toLower();
+    if(type.endsWith("be") || type.endsWith("le"))
+    {
+        field.big_endian = type.endsWith("be");
+        type.chop(2);
+    }
+    const auto found = std::find_if(std::begin(type_names), std::end(type_names), [&type](const TypeName& entry)
+    {
+        return type == entry.name;
+    });
+    if(found == std::end(type_names))
+    {
+        return set_error(error, QString("\"%1\": unknown type %2").arg(line, tokens[2]));
+    }
+    field.type = found->type;
+
+    for(int i = 3; i < tokens.size(); ++i)
+    {
+        const QString option = tokens[i].toLower();
+        bool ok = true;
+        if(option == "scale")
+        {
+            field.scale = tokens.value(++i).toDouble(&ok);
+        }
+        else if(option == "add")
+        {
+            field.add = tokens.value(++i).toDouble(&ok);
+        }
+        else if(option == "unit")
+        {
+            field.unit = tokens.value(++i);
+            ok = !field.unit.isEmpty();
+        }
+        else if(option == "hex")
+        {
+            field.hex = true;
+        }
+        else if(option == "bits")
+        {
+            bool count_ok = false;
+            field.first_bit = tokens.value(++i).toInt(&ok);
+            field.bits = tokens.value(++i).toInt(&count_ok);
+            const int width = static_cast<int>(field.width()) * 8;
+            ok = ok && count_ok && !is_float(field.type) && field.first_bit >= 0 && field.bits > 0 &&
+                    field.first_bit + field.bits <= width;
+        }
+        else if(option == "enum")
+        {
+            // the names are the rest of the line
+            while(i + 1 < tokens.size() && tokens[i + 1].contains('='))
+            {
+                const QString entry = tokens[++i];
+                const int separator = entry.indexOf('=');
+                const std::int64_t raw = entry.left(separator).toLongLong(&ok, 0);
+                if(!ok || separator + 1 == entry.size())
+                {
+                    return set_error(error, QString("\"%1\": bad enum entry %2").arg(line, entry));
+                }
+                field.names.emplace_back(raw, entry.mid(separator + 1));
+            }
+            ok = !field.names.empty() && !is_float(field.type);
+        }
+        else
+        {
+            return set_error(error, QString("\"%1\": unknown option %2").arg(line, tokens[i]));
+        }
+        if(!ok)
+        {
+            return set_error(error, QString("\"%1\": bad %2").arg(line, option));
+        }
+    }
+    return true;
+}
+
+std::uint32_t PacketDecoder::Field::width() const
+{
+    static const std::uint32_t widths[] = {1, 1, 2, 2, 4, 4, 8, 8, 4, 8};
+    return widths[static_cast<int>(type)];
+}
+
+bool PacketDecoder::Packet::from_string(const QString& line, Packet& packet, QString* error)
+{
+    const QStringList tokens = line.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+    packet = Packet();
+    if(tokens.size() < 2 || tokens[0].toLower() != "packet")
+    {
+        return set_error(error, QString("\"%1\": expected packet <name>").arg(line));
+    }
+    packet.name = tokens[1];
+
+    static const QRegularExpression hex("^0[xX][0-9A-Fa-f]{2}$");
+    for(int i = 2; i < tokens.size(); ++i)
+    {
+        const QString option = tokens[i].toLower();
+        if(hex.match(tokens[i]).hasMatch())
+        {
+            packet.match.append(static_cast<char>(tokens[i].mid(2).toUInt(nullptr, 16)));
+        }
+        else if(option == "at")
+        {
+            if(!to_number(tokens.value(++i), packet.match_offset, max_packet - 1))
+            {
+                return set_error(error, QString("\"%1\": bad at").arg(line));
+            }
+        }
+        else if(option == "length")
+        {
+            if(!to_number(tokens.value(++i), packet.length, max_packet) || packet.length == 0)
+            {
+                return set_error(error, QString("\"%1\": bad length").arg(line));
+            }
+        }
+        else
+        {
+            return set_error(error, QString("\"%1\": unknown option %2").arg(line, tokens[i]));
+        }
+    }
+    return true;
+}
+
+PacketDecoder::PacketDecoder() :
+    _packets(), _compiled(), _ops(), _key_offset(0), _dispatch(), _candidates(), _short_candidates(), _match_extent(0)
+{
+    build();
+}
+
+bool PacketDecoder::parse(const QStringList& lines, std::vector<Packet>& packets, QString* error)
+{
+    packets.clear();
+    for(const QString& line : lines)
+    {
+        const QString trimmed = line.trimmed();
+        if(trimmed.isEmpty() || trimmed.startsWith('#'))
+        {
+            continue;
+        }
+        static const QRegularExpression packet_line("^packet(\\s|$)", QRegularExpression::CaseInsensitiveOption);
+        if(packet_line.match(trimmed).hasMatch())
+        {
+            Packet packet;
+            if(!Packet::from_string(trimmed, packet, error))
+            {
+                return false;
+            }
+            packets.push_back(packet);
+            continue;
+        }
+        if(packets.empty())
+        {
+            return set_error(error, QString("\"%1\": field before the first packet").arg(trimmed));
+        }
+        Field field;
+        if(!Field::from_string(trimmed, field, error))
+        {
+            return false;
+        }
+        const Packet& packet = packets.back();
+        if(packet.length > 0 && end_of(field.offset, field.width()) > packet.length)
+        {
+            return set_error(error, QString("\"%1\": past the end of packet %2").arg(trimmed, packet.name));
+        }
+        packets.back().fields.push_back(field);
+    }
+    return true;
+}
+
+void PacketDecoder::set_packets(const std::vector<Packet>& packets)
+{
+    _packets = packets;
+    build();
+}
+
+const std::vector<PacketDecoder::Packet>& PacketDecoder::packets() const
+{
+    return _packets;
+}
+
+bool PacketDecoder::empty() const
+{
+    return _packets.empty();
+}
+
+std::size_t PacketDecoder::match_extent() const
+{
+    return _match_extent;
+}
+
+int PacketDecoder::match(const char* data, std::size_t size) const
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    if(size <= _key_offset)
+    {
+        for(const int packet : _short_candidates)
+        {
+            if(matches(packet, bytes, size))
+            {
+                return packet;
+            }
+        }
+        return -1;
+    }
+    const unsigned char key = bytes[_key_offset];
+    for(std::uint32_t i = _dispatch[key]; i < _dispatch[key + 1u]; ++i)
+    {
+        if(matches(_candidates[i], bytes, size))
+        {
+            return _candidates[i];
+        }
+    }
+    return -1;
+}
+
+int PacketDecoder::decode(const char* data, std::size_t size, std::vector<Value>& values) const
+{
+    const int packet = match(data, size);
+    if(packet < 0)
+    {
+        values.clear();
+        return -1;
+    }
+
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    const Compiled& compiled = _compiled[static_cast<std::size_t>(packet)];
+    values.resize(compiled.ops_end - compiled.ops_begin);
+    Value* out = values.data();
+    for(std::uint32_t i = compiled.ops_begin; i < compiled.ops_end; ++i)
+    {
+        const Op& op = _ops[i];
+        Value& value = *out++;
+        value.value = op.load(bytes + op.offset, value.raw);
+        if(op.flags & BITS)
+        {
+            value.raw = static_cast<std::int64_t>((static_cast<std::uint64_t>(value.raw) >> op.shift) & op.mask);
+            value.value = static_cast<double>(value.raw);
+        }
+        if(op.flags & SCALED)
+        {
+            value.value = value.value * op.scale + op.add;
+        }
+    }
+    return packet;
+}
+
+QString PacketDecoder::format(const char* data, std::size_t size) const
+{
+    std::vector<Value> values;
+    const int index = decode(data, size, values);
+    if(index < 0)
+    {
+        return QString();
+    }
+
+    const Packet& packet = _packets[static_cast<std::size_t>(index)];
+    QString row = packet.name;
+    for(std::size_t i = 0; i < values.size(); ++i)
+    {
+        const Field& field = packet.fields[i];
+        const Value& value = values[i];
+        const auto name = std::find_if(field.names.cbegin(), field.names.cend(), [&value](const std::pair<std::int64_t, QString>& entry)
+        {
+            return entry.first == value.raw;
+        });
+
+        QString text;
+        if(name != field.names.cend())
+        {
+            text = name->second;
+        }
+        else if(field.hex)
+        {
+            const int digits = field.bits > 0 ? (field.bits + 3) / 4 : static_cast<int>(field.width()) * 2;
+            const std::uint64_t mask = digits >= 16 ? ~std::uint64_t(0) : (std::uint64_t(1) << (4 * digits)) - 1;
+            text = "0x" + QString("%1").arg(static_cast<quint64>(value.raw) & mask, digits, 16, QChar('0')).toUpper();
+        }
+        else if(is_float(field.type) || field.scale != 1.0 || field.add != 0.0)
+        {
+            text = QString::number(value.value, 'g', field.type == TYPE::F32 ? 7 : 12);
+        }
+        else if(field.type == TYPE::U64 && field.bits == 0)
+        {
+            text = QString::number(static_cast<quint64>(value.raw));
+        }
+        else
+        {
+            text = QString::number(static_cast<qint64>(value.raw));
+        }
+
+        row += "  " + field.name + '=' + text;
+        if(!field.unit.isEmpty())
+        {
+            row += ' ' + field.unit;
+        }
+    }
+    return row;
+}
+
+void PacketDecoder::build()
+{
+    _compiled.clear();
+    _ops.clear();
+    _candidates.clear();
+    _short_candidates.clear();
+    _match_extent = 0;
+
+    // the match offset most packets share is the one worth dispatching on
+    std::vector<std::uint32_t> offsets;
+    for(const Packet& packet : _packets)
+    {
+        if(!packet.match.isEmpty())
+        {
+            offsets.push_back(packet.match_offset);
+        }
+    }
+    _key_offset = 0;
+    std::size_t best = 0;
+    for(const std::uint32_t offset : offsets)
+    {
+        const std::size_t count = static_cast<std::size_t>(std::count(offsets.cbegin(), offsets.cend(), offset));
+        if(count > best)
+        {
+            best = count;
+            _key_offset = offset;
+        }
+    }
+    _match_extent = static_cast<std::size_t>(_key_offset) + 1;
+
+    for(const Packet& packet : _packets)
+    {
+        Compiled compiled;
+        compiled.ops_begin = static_cast<std::uint32_t>(_ops.size());
+        compiled.min_size = end_of(packet.match_offset, static_cast<std::uint64_t>(packet.match.size()));
+        compiled.length = packet.length;
+        _match_extent = std::max<std::size_t>(_match_extent, compiled.min_size);
+
+        for(const Field& field : packet.fields)
+        {
+            Op op;
+            op.load = loads[static_cast<int>(field.type)][field.big_endian ? 1 : 0];
+            op.offset = field.offset;
+            op.flags = 0;
+            op.shift = static_cast<std::uint8_t>(field.first_bit);
+            op.mask = field.bits >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << field.bits) - 1;
+            op.scale = field.scale;
+            op.add = field.add;
+            if(field.bits > 0)
+            {
+                op.flags |= BITS;
+            }
+            if(field.scale != 1.0 || field.add != 0.0)
+            {
+                op.flags |= SCALED;
+            }
+            _ops.push_back(op);
+            compiled.min_size = std::max(compiled.min_size, end_of(field.offset, field.width()));
+        }
+        compiled.ops_end = static_cast<std::uint32_t>(_ops.size());
+        _compiled.push_back(compiled);
+    }
+
+    // a packet not matching on the key byte is a candidate for every value of it
+    const auto key_byte = [this](const Packet& packet)
+    {
+        if(_key_offset < packet.match_offset || _key_offset >= end_of(packet.match_offset, static_cast<std::uint64_t>(packet.match.size())))
+        {
+            return -1;
+        }
+        return static_cast<int>(static_cast<unsigned char>(packet.match[static_cast<int>(_key_offset - packet.match_offset)]));
+    };
+    for(int byte = 0; byte < 256; ++byte)
+    {
+        _dispatch[static_cast<std::size_t>(byte)] = static_cast<std::uint32_t>(_candidates.size());
+        for(std::size_t i = 0; i < _packets.size(); ++i)
+        {
+            const int key = key_byte(_packets[i]);
+            if(key < 0 || key == byte)
+            {
+                _candidates.push_back(static_cast<int>(i));
+            }
+        }
+    }
+    _dispatch[256] = static_cast<std::uint32_t>(_candidates.size());
+    for(std::size_t i = 0; i < _packets.size(); ++i)
+    {
+        if(key_byte(_packets[i]) < 0)
+        {
+            _short_candidates.push_back(static_cast<int>(i));
+        }
+    }
+}
+
+bool PacketDecoder::matches(int packet, const unsigned char* data, std::size_t size) const
+{
+    const Compiled& compiled = _compiled[static_cast<std::size_t>(packet)];
+    if(size < compiled.min_size || (compiled.length > 0 && size != compiled.length))
+    {
+        return false;
+    }
+    const Packet& spec = _packets[static_cast<std::size_t>(packet)];
+    return std::memcmp(data + spec.match_offset, spec.match.constData(), static_cast<std::size_t>(spec.match.size())) == 0;
+}
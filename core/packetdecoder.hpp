@@ -0,0 +1,162 @@
+#ifndef PACKETDECODER_HPP
+#define PACKETDECODER_HPP
+
+/*
+Decodes fixed layout binary packets described by a schema. Every schema is
+compiled once into flat tables: a packet is picked through a 256 entry
+dispatch on one of its identifying bytes, its fields are a list of
+operations each holding a load function instantiated for the field's type
+and byte order. Decoding a packet is then one table lookup, a compare of
+the identifying bytes and one indirect call per field.
+
+A schema is a packet line followed by its fields, packets are tried in the
+order they are written:
+
+    # comment
+    packet status 0xAA 0x01 length 12
+        temperature 2 i16 scale 0.1 unit C
+        voltage 4 u16be scale 0.001 unit V
+        mode 6 u8 enum 0=idle 1=run 2=fault
+        ready 7 u8 bits 0 1
+        flags 7 u8 hex
+        uptime 8 u32 unit s
+
+The packet line lists the bytes the packet starts with, "at <n>" moves
+them to offset n, "length <n>" requires the exact size. A field is its
+name, byte offset and type: u8 i8 u16 i16 u32 i32 u64 i64 f32 f64, little
+endian unless the type ends in be. Options are scale <x>, add <x> (value
+is raw * scale + add), bits <first> <count> taken from the raw integer,
+unit <text>, hex and enum <raw>=<name>... Offsets and lengths stay below
+64 KB. A packet shorter than the end of its last field is not decoded.
+*/
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+class PacketDecoder
+{
+public:
+
+    enum class TYPE : std::uint8_t
+    {
+        U8 = 0,
+        I8,
+        U16,
+        I16,
+        U32,
+        I32,
+        U64,
+        I64,
+        F32,
+        F64
+    };
+
+    struct Field
+    {
+        QString name;
+        std::uint32_t offset = 0;
+        TYPE type = TYPE::U8;
+        bool big_endian = false;
+        int first_bit = 0;
+        int bits = 0;           // 0 for the whole value
+        double scale = 1.0;
+        double add = 0.0;
+        QString unit;
+        bool hex = false;
+        std::vector<std::pair<std::int64_t, QString> > names;  // enum
+
+        static bool from_string(const QString& line, Field& field, QString* error = nullptr);
+        // bytes the field takes
+        std::uint32_t width() const;
+    };
+
+    struct Packet
+    {
+        QString name;
+        std::uint32_t match_offset = 0;
+        QByteArray match;
+        std::uint32_t length = 0;   // 0 for any length long enough for the fields
+        std::vector<Field> fields;
+
+        static bool from_string(const QString& line, Packet& packet, QString* error = nullptr);
+    };
+
+    struct Value
+    {
+        std::int64_t raw;       // bits of the integer after bits is applied, floats truncated
+        double value;           // scaled
+    };
+
+    PacketDecoder();
+
+    // empty lines and lines starting with # are skipped, error names the first bad line
+    static bool parse(const QStringList& lines, std::vector<Packet>& packets, QString* error = nullptr);
+
+    void set_packets(const std::vector<Packet>& packets);
+    const std::vector<Packet>& packets() const;
+    bool empty() const;
+
+    // leading bytes match() may look at
+    std::size_t match_extent() const;
+
+    // index of the first packet data is, -1 for none, only the first
+    // match_extent() bytes are looked at so data may hold just those
+    int match(const char* data, std::size_t size) const;
+    // one value per field of the matched packet, -1 and no values for none
+    int decode(const char* data, std::size_t size, std::vector<Value>& values) const;
+    // packet name and its fields as one row, empty for an unknown packet
+    QString format(const char* data, std::size_t size) const;
+
+private:
+
+    using Load = double (*)(const unsigned char* data, std::int64_t& raw);
+
+    enum OP_FLAG : std::uint8_t
+    {
+        SCALED = 1,
+        BITS = 2
+    };
+
+    struct Op
+    {
+        Load load;
+        std::uint32_t offset;
+        std::uint8_t flags;
+        std::uint8_t shift;
+        std::uint64_t mask;
+        double scale;
+        double add;
+    };
+
+    struct Compiled
+    {
+        std::uint32_t ops_begin;
+        std::uint32_t ops_end;
+        std::uint32_t min_size;     // past the match bytes and every field
+        std::uint32_t length;
+    };
+
+    void build();
+    bool matches(int packet, const unsigned char* data, std::size_t size) const;
+
+    std::vector<Packet> _packets;
+
+    std::vector<Compiled> _compiled;
+    std::vector<Op> _ops;
+
+    // packets to try by the byte at _key_offset, ranges of _candidates
+    std::uint32_t _key_offset;
+    std::array<std::uint32_t, 257> _dispatch;
+    std::vector<int> _candidates;
+    // packets to try when data ends before _key_offset
+    std::vector<int> _short_candidates;
+    std::size_t _match_extent;
+};
+
+#endif
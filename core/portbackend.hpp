@@ -0,0 +1,69 @@
+#ifndef PORTBACKEND_HPP
+#define PORTBACKEND_HPP
+
+/*
+Device side of a PortWorker. A backend owns the open port and the thread
+serving it, PortWorker keeps the queues, statistics and capture on top.
+Everything except post() and run() is called on the backend's thread and
+callbacks are made there, the same way QSerialPort signals arrive on the
+thread it lives on.
+
+    SerialBackend   QSerialPort on a thread of its own, every platform
+    ReactorBackend  non-blocking descriptor on one of the threads of a
+                    shared PortReactor, Linux only
+*/
+
+#include <functional>
+
+#include <QByteArray>
+#include <QSerialPort>
+#include <QString>
+
+class PortBackend
+{
+public:
+
+    struct Callbacks
+    {
+        std::function<void()> ready_read;
+        std::function<void(qint64)> bytes_written;
+        std::function<void(QSerialPort::SerialPortError)> error;
+    };
+
+    virtual ~PortBackend() = default;
+
+    // set once before open()
+    virtual void set_callbacks(const Callbacks& callbacks) = 0;
+
+    // any thread, task runs on the backend's thread, run() waits for it
+    virtual void post(std::function<void()> task) = 0;
+    virtual void run(std::function<void()> task) = 0;
+
+    virtual QString name() const = 0;
+    virtual bool open() = 0;
+    virtual void close() = 0;
+    virtual bool is_open() const = 0;
+
+    // received data is held up to limit, reading stops while that much is waiting
+    virtual void set_read_buffer_size(qint64 limit) = 0;
+    virtual qint64 bytes_available() const = 0;
+    virtual QByteArray read_all() = 0;
+
+    // -1 when the port is not open, progress comes through bytes_written
+    virtual qint64 write(const QByteArray& data) = 0;
+    virtual qint64 bytes_to_write() const = 0;
+
+    virtual bool set_baud_rate(int baud_rate) = 0;
+    virtual int baud_rate() const = 0;
+
+    virtual bool set_rts(bool rts) = 0;
+    virtual bool rts() const = 0;
+
+    virtual bool set_dtr(bool dtr) = 0;
+    virtual bool dtr() const = 0;
+
+    virtual bool set_flow_control(QSerialPort::FlowControl flow) = 0;
+    virtual QSerialPort::FlowControl flow_control() const = 0;
+};
+
+#endif
@@ -0,0 +1,205 @@
+#include "portreactor.hpp"
+
+#include <algorithm>
+#include <future>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace
+{
+    const int max_events = 64;
+    const std::size_t read_buffer_bytes = 64 * 1024;
+}
+
+PortReactor::PortReactor(int threads) :
+    _loops(), _running(true), _assign_mutex()
+{
+    for(int i = 0; i < std::max(1, threads); ++i)
+    {
+        std::unique_ptr<Loop> loop = std::make_unique<Loop>();
+        loop->epoll = epoll_create1(EPOLL_CLOEXEC);
+        loop->wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        loop->buffer.resize(read_buffer_bytes);
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.ptr = nullptr;
+        epoll_ctl(loop->epoll, EPOLL_CTL_ADD, loop->wakeup, &event);
+
+        Loop& served = *loop;
+        loop->thread = std::thread([this, &served]()
+        {
+            serve(served);
+        });
+        _loops.push_back(std::move(loop));
+    }
+}
+
+PortReactor::~PortReactor()
+{
+    _running = false;
+    for(std::unique_ptr<Loop>& loop : _loops)
+    {
+        const std::uint64_t one = 1;
+        ssize_t written = ::write(loop->wakeup, &one, sizeof(one));
+        static_cast<void>(written);
+    }
+    for(std::unique_ptr<Loop>& loop : _loops)
+    {
+        loop->thread.join();
+        ::close(loop->wakeup);
+        ::close(loop->epoll);
+    }
+}
+
+int PortReactor::threads() const
+{
+    return static_cast<int>(_loops.size());
+}
+
+int PortReactor::assign()
+{
+    std::lock_guard<std::mutex> lock(_assign_mutex);
+    int best = 0;
+    for(int i = 1; i < threads(); ++i)
+    {
+        if(_loops[static_cast<std::size_t>(i)]->ports < _loops[static_cast<std::size_t>(best)]->ports)
+        {
+            best = i;
+        }
+    }
+    ++_loops[static_cast<std::size_t>(best)]->ports;
+    return best;
+}
+
+void PortReactor::release(int loop)
+{
+    std::lock_guard<std::mutex> lock(_assign_mutex);
+    --_loops[static_cast<std::size_t>(loop)]->ports;
+}
+
+bool PortReactor::add(int loop, int fd, std::uint32_t events, Handler* handler)
+{
+    epoll_event event{};
+    event.events = events;
+    event.data.ptr = handler;
+    return epoll_ctl(_loops[static_cast<std::size_t>(loop)]->epoll, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+bool PortReactor::modify(int loop, int fd, std::uint32_t events, Handler* handler)
+{
+    epoll_event event{};
+    event.events = events;
+    event.data.ptr = handler;
+    return epoll_ctl(_loops[static_cast<std::size_t>(loop)]->epoll, EPOLL_CTL_MOD, fd, &event) == 0;
+}
+
+void PortReactor::remove(int loop, int fd)
+{
+    epoll_event event{};
+    epoll_ctl(_loops[static_cast<std::size_t>(loop)]->epoll, EPOLL_CTL_DEL, fd, &event);
+}
+
+char* PortReactor::read_buffer(int loop)
+{
+    return _loops[static_cast<std::size_t>(loop)]->buffer.data();
+}
+
+std::size_t PortReactor::read_buffer_size() const
+{
+    return read_buffer_bytes;
+}
+
+void PortReactor::post(int loop, std::function<void()> task)
+{
+    Loop& target = *_loops[static_cast<std::size_t>(loop)];
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(target.mutex);
+        // the loop takes all tasks at once, only the first of a batch has to wake it
+        wake = target.tasks.empty();
+        target.tasks.push_back(std::move(task));
+    }
+    if(wake)
+    {
+        const std::uint64_t one = 1;
+        ssize_t written = ::write(target.wakeup, &one, sizeof(one));
+        static_cast<void>(written);
+    }
+}
+
+void PortReactor::run(int loop, std::function<void()> task)
+{
+    if(in_loop(loop))
+    {
+        task();
+        return;
+    }
+    std::promise<void> done;
+    post(loop, [&task, &done]()
+    {
+        task();
+        done.set_value();
+    });
+    done.get_future().wait();
+}
+
+bool PortReactor::in_loop(int loop) const
+{
+    return _loops[static_cast<std::size_t>(loop)]->thread.get_id() == std::this_thread::get_id();
+}
+
+PortReactor::Stats PortReactor::stats() const
+{
+    Stats stats{0, 0, 0};
+    for(const std::unique_ptr<Loop>& loop : _loops)
+    {
+        stats.wakeups += loop->wakeups.load(std::memory_order_relaxed);
+        stats.events += loop->events.load(std::memory_order_relaxed);
+        stats.tasks += loop->tasks_run.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+void PortReactor::serve(Loop& loop)
+{
+    epoll_event events[max_events];
+    std::vector<std::function<void()> > tasks;
+    while(_running)
+    {
+        const int ready = epoll_wait(loop.epoll, events, max_events, -1);
+        loop.wakeups.store(loop.wakeups.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        for(int i = 0; i < ready; ++i)
+        {
+            Handler* handler = static_cast<Handler*>(events[i].data.ptr);
+            if(handler)
+            {
+                handler->io_ready(events[i].events);
+            }
+            else
+            {
+                std::uint64_t count = 0;
+                ssize_t size = ::read(loop.wakeup, &count, sizeof(count));
+                static_cast<void>(size);
+            }
+        }
+        if(ready > 0)
+        {
+            loop.events.store(loop.events.load(std::memory_order_relaxed) + static_cast<std::uint64_t>(ready), std::memory_order_relaxed);
+        }
+
+        // after the events, a task deleting a handler never races one of its events
+        {
+            std::lock_guard<std::mutex> lock(loop.mutex);
+            tasks.swap(loop.tasks);
+        }
+        for(std::function<void()>& task : tasks)
+        {
+            task();
+        }
+        loop.tasks_run.store(loop.tasks_run.load(std::memory_order_relaxed) + tasks.size(), std::memory_order_relaxed);
+        tasks.clear();
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef PORTREACTOR_HPP
+#define PORTREACTOR_HPP
+
+/*
+A few threads serving many port descriptors through epoll. Each port is
+assigned to the loop with the fewest ports and stays there, so everything
+about one port happens on one thread and needs no locking. A loop sleeps in
+epoll_wait until one of its descriptors is ready or a task is posted, one
+wakeup handles every port that became ready meanwhile. Reads go into a
+scratch buffer owned by the loop and shared by all its ports, a port only
+keeps what it has not handed on yet.
+
+Linux only.
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class PortReactor
+{
+public:
+
+    class Handler
+    {
+    public:
+        virtual ~Handler() = default;
+        // epoll events of the handler's descriptor, on the loop thread
+        virtual void io_ready(std::uint32_t events) = 0;
+    };
+
+    struct Stats
+    {
+        std::uint64_t wakeups;      // returns from epoll_wait
+        std::uint64_t events;       // descriptor events handled
+        std::uint64_t tasks;        // posted tasks run
+    };
+
+    // threads is clamped to at least one
+    explicit PortReactor(int threads = 1);
+    ~PortReactor();
+
+    PortReactor(const PortReactor&) = delete;
+    PortReactor& operator=(const PortReactor&) = delete;
+
+    int threads() const;
+
+    // loop serving the fewest ports, give it back with release()
+    int assign();
+    void release(int loop);
+
+    // loop thread only, a removed handler gets no further events
+    bool add(int loop, int fd, std::uint32_t events, Handler* handler);
+    bool modify(int loop, int fd, std::uint32_t events, Handler* handler);
+    void remove(int loop, int fd);
+
+    // loop thread only, valid until the handler returns
+    char* read_buffer(int loop);
+    std::size_t read_buffer_size() const;
+
+    // any thread, run() waits for the task and runs it directly on the loop thread
+    void post(int loop, std::function<void()> task);
+    void run(int loop, std::function<void()> task);
+    bool in_loop(int loop) const;
+
+    // all loops together
+    Stats stats() const;
+
+private:
+
+    struct Loop
+    {
+        int epoll = -1;
+        int wakeup = -1;    // eventfd, registered with a null handler
+        std::thread thread;
+
+        std::mutex mutex;
+        std::vector<std::function<void()> > tasks;
+        int ports = 0;      // guarded by _assign_mutex
+
+        std::vector<char> buffer;
+        std::atomic<std::uint64_t> wakeups{0};
+        std::atomic<std::uint64_t> events{0};
+        std::atomic<std::uint64_t> tasks_run{0};
+    };
+
+    void serve(Loop& loop);
+
+    std::vector<std::unique_ptr<Loop> > _loops;
+    std::atomic<bool> _running;
+    std::mutex _assign_mutex;
+};
+
+#endif
@@ -0,0 +1,194 @@
+#include "portstats.hpp"
+
+#include <QJsonArray>
+#include <QStringList>
+
+namespace
+{
+    struct Rates
+    {
+        double rx_rate;
+        double tx_rate;
+        double callback_rate;
+        double frame_rate;
+        double bytes_per_callback;
+        double writes_per_flush;
+        double tx_blocked;          // fraction of the interval
+        double flush_us;
+        double paint_us;
+    };
+
+    Rates rates(const PortStats& current, const PortStats& previous)
+    {
+        const double seconds = static_cast<double>(current.timestamp - previous.timestamp) / 1e9;
+        const std::uint64_t callbacks = current.read_callbacks - previous.read_callbacks;
+        const std::uint64_t flushes = current.flushes - previous.flushes;
+        const std::uint64_t paints = current.paints - previous.paints;
+        const std::uint64_t tx_flushes = current.tx_flushes - previous.tx_flushes;
+
+        Rates result{};
+        if(seconds > 0)
+        {
+            result.rx_rate = static_cast<double>(current.rx_bytes - previous.rx_bytes) / seconds;
+            result.tx_rate = static_cast<double>(current.tx_bytes - previous.tx_bytes) / seconds;
+            result.callback_rate = static_cast<double>(callbacks) / seconds;
+            // framing restarts its count when reconfigured
+            const std::uint64_t frames = current.frames >= previous.frames ? current.frames - previous.frames : current.frames;
+            result.frame_rate = static_cast<double>(frames) / seconds;
+            result.tx_blocked = static_cast<double>(current.tx_blocked_time - previous.tx_blocked_time) / 1e9 / seconds;
+        }
+        if(callbacks > 0)
+        {
+            result.bytes_per_callback = static_cast<double>(current.rx_bytes - previous.rx_bytes) / static_cast<double>(callbacks);
+        }
+        if(tx_flushes > 0)
+        {
+            result.writes_per_flush = static_cast<double>(current.tx_writes - previous.tx_writes) / static_cast<double>(tx_flushes);
+        }
+        if(flushes > 0)
+        {
+            result.flush_us = static_cast<double>(current.flush_time - previous.flush_time) / static_cast<double>(flushes) / 1000.0;
+        }
+        if(paints > 0)
+        {
+            result.paint_us = static_cast<double>(current.paint_time - previous.paint_time) / static_cast<double>(paints) / 1000.0;
+        }
+        return result;
+    }
+}
+
+int PortStats::size_bucket(std::size_t bytes)
+{
+    int bucket = 0;
+    while(bytes > 1 && bucket < size_buckets - 1)
+    {
+        bytes >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+QString PortStats::csv_header()
+{
+    QStringList columns{"timestamp_ns", "rx_bytes", "tx_bytes", "rx_bytes_s", "tx_bytes_s",
+                        "read_callbacks", "callbacks_s", "bytes_per_callback",
+                        "queue_depth", "queue_peak", "queue_capacity", "stalls", "dropped_bytes",
+                        "tx_writes", "tx_flushes", "writes_per_flush", "tx_rejected_bytes",
+                        "tx_queued", "tx_queue_peak", "tx_high_water", "tx_blocked_ns", "tx_blocked_fraction",
+                        "frames", "frames_s", "bad_frames", "malformed_frames", "skipped_bytes",
+                        "flushes", "flush_avg_us", "flush_max_us", "paints", "paint_avg_us", "paint_max_us"};
+    for(int i = 0; i < size_buckets; ++i)
+    {
+        columns.append(QString("reads_%1").arg(std::uint64_t(1) << i));
+    }
+    return columns.join(',');
+}
+
+QString PortStats::csv(const PortStats& previous) const
+{
+    const Rates r = rates(*this, previous);
+    QStringList values;
+    values << QString::number(timestamp) << QString::number(rx_bytes) << QString::number(tx_bytes)
+           << QString::number(r.rx_rate, 'f', 1) << QString::number(r.tx_rate, 'f', 1)
+           << QString::number(read_callbacks) << QString::number(r.callback_rate, 'f', 1)
+           << QString::number(r.bytes_per_callback, 'f', 1)
+           << QString::number(queue_depth) << QString::number(queue_peak) << QString::number(queue_capacity)
+           << QString::number(stalls) << QString::number(dropped_bytes)
+           << QString::number(tx_writes) << QString::number(tx_flushes) << QString::number(r.writes_per_flush, 'f', 1)
+           << QString::number(tx_rejected_bytes) << QString::number(tx_queued) << QString::number(tx_queue_peak)
+           << QString::number(tx_high_water) << QString::number(tx_blocked_time) << QString::number(r.tx_blocked, 'f', 3)
+           << QString::number(frames) << QString::number(r.frame_rate, 'f', 1) << QString::number(bad_frames)
+           << QString::number(malformed_frames) << QString::number(skipped_bytes)
+           << QString::number(flushes) << QString::number(r.flush_us, 'f', 1) << QString::number(flush_max / 1000.0, 'f', 1)
+           << QString::number(paints) << QString::number(r.paint_us, 'f', 1) << QString::number(paint_max / 1000.0, 'f', 1);
+    for(const std::uint64_t count : read_sizes)
+    {
+        values << QString::number(count);
+    }
+    return values.join(',');
+}
+
+QJsonObject PortStats::json(const PortStats& previous) const
+{
+    const Rates r = rates(*this, previous);
+    QJsonArray sizes;
+    for(const std::uint64_t count : read_sizes)
+    {
+        sizes.append(static_cast<double>(count));
+    }
+
+    QJsonObject object;
+    object["timestamp_ns"] = static_cast<double>(timestamp);
+    object["rx_bytes"] = static_cast<double>(rx_bytes);
+    object["tx_bytes"] = static_cast<double>(tx_bytes);
+    object["rx_bytes_s"] = r.rx_rate;
+    object["tx_bytes_s"] = r.tx_rate;
+    object["read_callbacks"] = static_cast<double>(read_callbacks);
+    object["callbacks_s"] = r.callback_rate;
+    object["bytes_per_callback"] = r.bytes_per_callback;
+    object["read_sizes"] = sizes;
+    object["queue_depth"] = static_cast<double>(queue_depth);
+    object["queue_peak"] = static_cast<double>(queue_peak);
+    object["queue_capacity"] = static_cast<double>(queue_capacity);
+    object["stalls"] = static_cast<double>(stalls);
+    object["dropped_bytes"] = static_cast<double>(dropped_bytes);
+    object["tx_writes"] = static_cast<double>(tx_writes);
+    object["tx_flushes"] = static_cast<double>(tx_flushes);
+    object["writes_per_flush"] = r.writes_per_flush;
+    object["tx_rejected_bytes"] = static_cast<double>(tx_rejected_bytes);
+    object["tx_queued"] = static_cast<double>(tx_queued);
+    object["tx_queue_peak"] = static_cast<double>(tx_queue_peak);
+    object["tx_high_water"] = static_cast<double>(tx_high_water);
+    object["tx_blocked_ns"] = static_cast<double>(tx_blocked_time);
+    object["tx_blocked_fraction"] = r.tx_blocked;
+    object["frames"] = static_cast<double>(frames);
+    object["frames_s"] = r.frame_rate;
+    object["bad_frames"] = static_cast<double>(bad_frames);
+    object["malformed_frames"] = static_cast<double>(malformed_frames);
+    object["skipped_bytes"] = static_cast<double>(skipped_bytes);
+    object["flushes"] = static_cast<double>(flushes);
+    object["flush_avg_us"] = r.flush_us;
+    object["flush_max_us"] = flush_max / 1000.0;
+    object["paints"] = static_cast<double>(paints);
+    object["paint_avg_us"] = r.paint_us;
+    object["paint_max_us"] = paint_max / 1000.0;
+    return object;
+}
+
+QString PortStats::text(const PortStats& previous) const
+{
+    const Rates r = rates(*this, previous);
+
+    // most common read size
+    int common = 0;
+    for(int i = 1; i < size_buckets; ++i)
+    {
+        if(read_sizes[i] - previous.read_sizes[i] > read_sizes[common] - previous.read_sizes[common])
+        {
+            common = i;
+        }
+    }
+
+    QStringList lines;
+    lines << QString("RX %1 B/s, %2 bytes total").arg(r.rx_rate, 0, 'f', 0).arg(rx_bytes);
+    lines << QString("TX %1 B/s, %2 bytes total").arg(r.tx_rate, 0, 'f', 0).arg(tx_bytes);
+    lines << QString("%1 reads/s, %2 B per read, mostly %3-%4 B")
+             .arg(r.callback_rate, 0, 'f', 0).arg(r.bytes_per_callback, 0, 'f', 1)
+             .arg(std::uint64_t(1) << common).arg((std::uint64_t(2) << common) - 1);
+    lines << QString("Queue %1/%2, peak %3, %4 stalls, %5 bytes dropped")
+             .arg(queue_depth).arg(queue_capacity).arg(queue_peak).arg(stalls).arg(dropped_bytes);
+    lines << QString("TX queue %1/%2 B, peak %3, %4 writes per flush, %5 bytes rejected")
+             .arg(tx_queued).arg(tx_high_water).arg(tx_queue_peak)
+             .arg(r.writes_per_flush, 0, 'f', 1).arg(tx_rejected_bytes);
+    lines << QString("TX blocked %1% of the time, %2 s total")
+             .arg(r.tx_blocked * 100.0, 0, 'f', 1).arg(tx_blocked_time / 1e9, 0, 'f', 2);
+    if(frames > 0)
+    {
+        lines << QString("%1 frames/s, %2 bad, %3 malformed, %4 bytes skipped")
+                 .arg(r.frame_rate, 0, 'f', 0)
+                 .arg(bad_frames).arg(malformed_frames).arg(skipped_bytes);
+    }
+    lines << QString("Flush %1 us avg, %2 us max").arg(r.flush_us, 0, 'f', 1).arg(flush_max / 1000.0, 0, 'f', 1);
+    lines << QString("Paint %1 us avg, %2 us max").arg(r.paint_us, 0, 'f', 1).arg(paint_max / 1000.0, 0, 'f', 1);
+    return lines.join('\n');
+}
@@ -0,0 +1,66 @@
+#ifndef PORTSTATS_HPP
+#define PORTSTATS_HPP
+
+/*
+Snapshot of the performance counters of one console. Counters only ever
+grow, rates come from the difference of two snapshots. Worker counters tell
+how the device and driver deliver data, flush and paint counters how much
+the GUI spends on it.
+*/
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <QJsonObject>
+#include <QString>
+
+struct PortStats
+{
+    // bucket n counts reads of 2^n to 2^(n+1) - 1 bytes, the last one everything above
+    static const int size_buckets = 16;
+
+    static int size_bucket(std::size_t bytes);
+
+    std::int64_t timestamp = 0;
+
+    // worker thread
+    std::uint64_t rx_bytes = 0;
+    std::uint64_t tx_bytes = 0;
+    std::uint64_t read_callbacks = 0;
+    std::array<std::uint64_t, size_buckets> read_sizes = {};
+    std::size_t queue_depth = 0;
+    std::size_t queue_peak = 0;
+    std::size_t queue_capacity = 0;
+    std::uint64_t stalls = 0;
+    std::uint64_t dropped_bytes = 0;
+    std::uint64_t tx_writes = 0;            // writes accepted into the TX queue
+    std::uint64_t tx_flushes = 0;           // coalesced blocks handed to the port
+    std::uint64_t tx_rejected_bytes = 0;    // refused above the high-water mark
+    std::size_t tx_queued = 0;
+    std::size_t tx_queue_peak = 0;
+    std::size_t tx_high_water = 0;
+    std::int64_t tx_blocked_time = 0;       // held back beyond line rate, nanoseconds
+
+    // framing on the GUI thread
+    std::uint64_t frames = 0;
+    std::uint64_t bad_frames = 0;
+    std::uint64_t malformed_frames = 0;
+    std::uint64_t skipped_bytes = 0;
+
+    // GUI thread, nanoseconds
+    std::uint64_t flushes = 0;
+    std::int64_t flush_time = 0;
+    std::int64_t flush_max = 0;
+    std::uint64_t paints = 0;
+    std::int64_t paint_time = 0;
+    std::int64_t paint_max = 0;
+
+    // rates and averages since previous, per second and microseconds
+    static QString csv_header();
+    QString csv(const PortStats& previous) const;
+    QJsonObject json(const PortStats& previous) const;
+    QString text(const PortStats& previous) const;
+};
+
+#endif
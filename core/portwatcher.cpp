@@ -0,0 +1,126 @@
+#include "portwatcher.hpp"
+
+#include <QDir>
+#include <QSerialPortInfo>
+
+#include <algorithm>
+#include <iterator>
+
+namespace
+{
+    const char device_directory[] = "/dev";
+
+    // a device usually creates several nodes at once, enumerate once for all of them
+    const int debounce_interval = 50;
+
+    const int poll_interval = 1000;
+}
+
+PortWatcher::PortWatcher(QObject *parent) :
+    QObject(parent), _watcher(), _debounce(), _nodes(), _ports(), _scan(), _scanning(false), _rescan(false)
+{
+    _debounce.setSingleShot(true);
+    connect(&_debounce, &QTimer::timeout, this, &PortWatcher::rescan);
+
+    if(_watcher.addPath(device_directory))
+    {
+        _debounce.setInterval(debounce_interval);
+        connect(&_watcher, &QFileSystemWatcher::directoryChanged, this, &PortWatcher::directory_changed);
+        _nodes = device_nodes();
+    }
+    else
+    {
+        _debounce.setSingleShot(false);
+        _debounce.setInterval(poll_interval);
+        _debounce.start();
+    }
+
+    rescan();
+}
+
+PortWatcher::~PortWatcher()
+{
+    // its result is posted to this object and dropped with it
+    if(_scan.joinable())
+    {
+        _scan.join();
+    }
+}
+
+QStringList PortWatcher::ports() const
+{
+    return _ports;
+}
+
+void PortWatcher::directory_changed()
+{
+    // nodes of other devices come and go too, those need no enumeration
+    QStringList nodes = device_nodes();
+    if(nodes == _nodes)
+    {
+        return;
+    }
+    _nodes.swap(nodes);
+    _debounce.start();
+}
+
+void PortWatcher::rescan()
+{
+    if(_scanning)
+    {
+        _rescan = true;
+        return;
+    }
+    _scanning = true;
+    if(_scan.joinable())
+    {
+        _scan.join();
+    }
+    _scan = std::thread([this]()
+    {
+        const QStringList ports = available_ports();
+        QMetaObject::invokeMethod(this, [this, ports]()
+        {
+            scanned(ports);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void PortWatcher::scanned(QStringList ports)
+{
+    _scanning = false;
+    if(_rescan)
+    {
+        _rescan = false;
+        rescan();
+    }
+
+    QStringList added;
+    QStringList removed;
+    std::set_difference(ports.begin(), ports.end(), _ports.begin(), _ports.end(), std::back_inserter(added));
+    std::set_difference(_ports.begin(), _ports.end(), ports.begin(), ports.end(), std::back_inserter(removed));
+    if(!added.isEmpty() || !removed.isEmpty())
+    {
+        _ports.swap(ports);
+        emit ports_changed(added, removed);
+    }
+    emit enumerated();
+}
+
+QStringList PortWatcher::device_nodes()
+{
+    QDir directory(device_directory);
+    QStringList nodes = directory.entryList({"tty*", "cu.*", "rfcomm*"}, QDir::System | QDir::Files, QDir::Name);
+    return nodes;
+}
+
+QStringList PortWatcher::available_ports()
+{
+    QStringList ports;
+    for(const QSerialPortInfo& info : QSerialPortInfo::availablePorts())
+    {
+        ports.append(info.portName());
+    }
+    ports.sort();
+    return ports;
+}
@@ -0,0 +1,61 @@
+#ifndef PORTWATCHER_HPP
+#define PORTWATCHER_HPP
+
+/*
+Keeps the list of serial ports up to date without polling. Where devices
+show up as nodes in /dev the directory is watched (inotify, kqueue) and
+ports are enumerated only when a tty-like node appears or disappears.
+Windows has no such directory and falls back to polling, still reporting
+only the difference.
+
+Enumeration asks the system about every port and can take a while, so it
+runs on a thread of its own and never holds up the event loop. The first
+one starts with the watcher, until it finishes there are no ports.
+*/
+
+#include <thread>
+
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QStringList>
+#include <QTimer>
+
+class PortWatcher : public QObject
+{
+    Q_OBJECT
+
+signals:
+
+    void ports_changed(const QStringList& added, const QStringList& removed);
+    // after every enumeration, changed or not
+    void enumerated();
+
+public:
+
+    explicit PortWatcher(QObject *parent = nullptr);
+    ~PortWatcher() override;
+
+    // ports as of last change, sorted
+    QStringList ports() const;
+
+private:
+
+    void directory_changed();
+    // one enumeration at a time, a request during one runs again after it
+    void rescan();
+    void scanned(QStringList ports);
+
+    static QStringList device_nodes();
+    static QStringList available_ports();
+
+    QFileSystemWatcher _watcher;
+    QTimer _debounce;
+    QStringList _nodes;
+    QStringList _ports;
+
+    std::thread _scan;
+    bool _scanning;
+    bool _rescan;
+};
+
+#endif
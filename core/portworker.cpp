@@ -0,0 +1,497 @@
+#include "portworker.hpp"
+
+#include <algorithm>
+
+#include "monotonicclock.hpp"
+#include "serialbackend.hpp"
+
+namespace
+{
+    const std::size_t queue_capacity = 1024;
+    const std::size_t tx_stamp_capacity = 1024;
+
+    // data kept in the backend while the queue is full, beyond it reads are dropped
+    const qint64 read_buffer_limit = 4 * 1024 * 1024;
+
+    const std::size_t default_tx_high_water = 1024 * 1024;
+
+    // small writes are merged up to this size, larger ones pass as they are
+    const int tx_block_size = 16 * 1024;
+
+    // the backend gets more only when it has less than this left to write
+    const qint64 tx_port_limit = 2 * tx_block_size;
+
+    // scheduling noise that does not count as being held back
+    const std::int64_t tx_stall_slack = 1000000;
+
+    // nanoseconds the line needs for the bytes, start, 8 data and stop bit
+    std::int64_t line_time(std::size_t bytes, int baud_rate)
+    {
+        return baud_rate > 0 ? static_cast<std::int64_t>(bytes) * 10 * 1000000000 / baud_rate : 0;
+    }
+
+    // single writer, a plain load and store is enough and avoids a locked add
+    template<typename T>
+    void count(std::atomic<T>& counter, T value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+}
+
+PortWorker::PortWorker(const QString& name, QObject *parent) :
+    PortWorker(std::make_unique<SerialBackend>(name), parent)
+{
+
+}
+
+PortWorker::PortWorker(std::unique_ptr<PortBackend> backend, QObject *parent) :
+    QObject(parent), _name(backend->name()), _backend(std::move(backend)),
+    _queue(queue_capacity), _capture(), _notify_pending(false), _stalled(false), _open(false),
+    _baud_rate(0), _rts(false), _dtr(false), _flow(QSerialPort::NoFlowControl),
+    _tx_mutex(), _tx_blocks(), _tx_flush_pending(false), _tx_accepted(0), _tx_queued(0), _tx_high_water(default_tx_high_water),
+    _tx_queue_peak(0), _tx_writes(0), _tx_rejected_bytes(0),
+    _rx_bytes(0), _tx_bytes(0), _read_callbacks(0), _read_sizes(), _queue_peak(0),
+    _tx_flushes(0), _tx_blocked_time(0), _tx_waiting_since(0), _tx_port_bytes(0),
+    _tx_handed(0), _tx_stamps(tx_stamp_capacity),
+    _stalls(0), _dropped_bytes(0), _capture_active(false), _capture_paused(false), _capture_bytes(0), _capture_files(0)
+{
+    PortBackend::Callbacks callbacks;
+    callbacks.ready_read = [this]()
+    {
+        read_port();
+    };
+    callbacks.bytes_written = [this](qint64 bytes)
+    {
+        tx_written(bytes);
+    };
+    callbacks.error = [this](QSerialPort::SerialPortError error)
+    {
+        port_error(error);
+    };
+    _backend->set_callbacks(callbacks);
+    _backend->run([this]()
+    {
+        _backend->set_read_buffer_size(read_buffer_limit);
+    });
+}
+
+PortWorker::~PortWorker()
+{
+    _backend->run([this]()
+    {
+        _backend->close();
+        _capture.reset();
+    });
+    _backend.reset();
+}
+
+bool PortWorker::open()
+{
+    bool opened = false;
+    _backend->run([this, &opened]()
+    {
+        opened = _backend->open();
+        _open = opened;
+        update_settings();
+    });
+    return opened;
+}
+
+bool PortWorker::is_open() const
+{
+    return _open;
+}
+
+QString PortWorker::port_name() const
+{
+    return _name;
+}
+
+bool PortWorker::write(const QByteArray& data, std::uint64_t* end)
+{
+    const std::size_t size = static_cast<std::size_t>(data.size());
+
+    std::lock_guard<std::mutex> lock(_tx_mutex);
+    if(data.isEmpty())
+    {
+        if(end)
+        {
+            *end = _tx_accepted;
+        }
+        return true;
+    }
+    const std::size_t queued = _tx_queued.load();
+    if(queued > 0 && queued + size > _tx_high_water.load(std::memory_order_relaxed))
+    {
+        _tx_rejected_bytes.store(_tx_rejected_bytes.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+        return false;
+    }
+
+    if(!_tx_blocks.empty() && _tx_blocks.back().size() + data.size() <= tx_block_size)
+    {
+        _tx_blocks.back().append(data);
+    }
+    else
+    {
+        _tx_blocks.push_back(data);
+    }
+    _tx_accepted += size;
+    if(end)
+    {
+        *end = _tx_accepted;
+    }
+    const std::size_t depth = _tx_queued.fetch_add(size) + size;
+    if(depth > _tx_queue_peak.load(std::memory_order_relaxed))
+    {
+        _tx_queue_peak.store(depth, std::memory_order_relaxed);
+    }
+    _tx_writes.store(_tx_writes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    // one pending flush picks up everything appended until it runs
+    if(!_tx_flush_pending)
+    {
+        _tx_flush_pending = true;
+        _backend->post([this]()
+        {
+            flush_tx();
+        });
+    }
+    return true;
+}
+
+void PortWorker::set_tx_high_water(std::size_t bytes)
+{
+    _tx_high_water = bytes;
+}
+
+std::size_t PortWorker::tx_high_water() const
+{
+    return _tx_high_water;
+}
+
+void PortWorker::set_baud_rate(int baud_rate)
+{
+    _backend->post([this, baud_rate]()
+    {
+        _backend->set_baud_rate(baud_rate);
+        update_settings();
+    });
+}
+
+int PortWorker::baud_rate() const
+{
+    return _baud_rate;
+}
+
+void PortWorker::set_rts(bool rts)
+{
+    _backend->post([this, rts]()
+    {
+        _backend->set_rts(rts);
+        update_settings();
+    });
+}
+
+bool PortWorker::rts() const
+{
+    return _rts;
+}
+
+void PortWorker::set_dtr(bool dtr)
+{
+    _backend->post([this, dtr]()
+    {
+        _backend->set_dtr(dtr);
+        update_settings();
+    });
+}
+
+bool PortWorker::dtr() const
+{
+    return _dtr;
+}
+
+bool PortWorker::set_flow_control(QSerialPort::FlowControl flow)
+{
+    bool set = false;
+    _backend->run([this, flow, &set]()
+    {
+        set = _backend->set_flow_control(flow);
+        update_settings();
+    });
+    return set;
+}
+
+QSerialPort::FlowControl PortWorker::flow_control() const
+{
+    return static_cast<QSerialPort::FlowControl>(_flow.load());
+}
+
+bool PortWorker::pop_tx_stamp(TxStamp& stamp)
+{
+    return _tx_stamps.pop(stamp);
+}
+
+bool PortWorker::pop(Chunk& chunk)
+{
+    if(_queue.pop(chunk))
+    {
+        return true;
+    }
+
+    // queue looks empty, allow next notification and look once more so a
+    // chunk pushed in between is not left behind
+    _notify_pending = false;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(_queue.pop(chunk))
+    {
+        return true;
+    }
+
+    if(_stalled.exchange(false))
+    {
+        _backend->post([this]()
+        {
+            read_port();
+        });
+    }
+    return false;
+}
+
+PortWorker::QueueStats PortWorker::queue_stats() const
+{
+    return QueueStats{_queue.size(), _queue.capacity(), _stalls, _dropped_bytes};
+}
+
+void PortWorker::traffic_stats(PortStats& stats) const
+{
+    stats.rx_bytes = _rx_bytes.load(std::memory_order_relaxed);
+    stats.tx_bytes = _tx_bytes.load(std::memory_order_relaxed);
+    stats.read_callbacks = _read_callbacks.load(std::memory_order_relaxed);
+    for(int i = 0; i < PortStats::size_buckets; ++i)
+    {
+        stats.read_sizes[i] = _read_sizes[i].load(std::memory_order_relaxed);
+    }
+    stats.queue_depth = _queue.size();
+    stats.queue_peak = _queue_peak.load(std::memory_order_relaxed);
+    stats.queue_capacity = _queue.capacity();
+    stats.stalls = _stalls;
+    stats.dropped_bytes = _dropped_bytes;
+
+    stats.tx_writes = _tx_writes.load(std::memory_order_relaxed);
+    stats.tx_flushes = _tx_flushes.load(std::memory_order_relaxed);
+    stats.tx_rejected_bytes = _tx_rejected_bytes.load(std::memory_order_relaxed);
+    stats.tx_queued = _tx_queued.load(std::memory_order_relaxed);
+    stats.tx_queue_peak = _tx_queue_peak.load(std::memory_order_relaxed);
+    stats.tx_high_water = _tx_high_water.load(std::memory_order_relaxed);
+    stats.tx_blocked_time = _tx_blocked_time.load(std::memory_order_relaxed);
+
+    // a stall still going on counts too, the line needs at least this long for what is left
+    const std::int64_t waiting_since = _tx_waiting_since.load(std::memory_order_relaxed);
+    if(waiting_since > 0)
+    {
+        const std::int64_t excess = monotonic_ns() - waiting_since - line_time(_tx_port_bytes, _baud_rate) - tx_stall_slack;
+        if(excess > 0)
+        {
+            stats.tx_blocked_time += excess;
+        }
+    }
+}
+
+bool PortWorker::start_capture(const QString& base, qint64 file_limit, QString* error)
+{
+    bool started = false;
+    _backend->run([this, base, file_limit, error, &started]()
+    {
+        _capture = std::make_unique<CaptureWriter>(base, file_limit);
+        started = _capture->open();
+        if(!started)
+        {
+            if(error)
+            {
+                *error = _capture->error_string();
+            }
+            _capture.reset();
+        }
+        _capture_active = started;
+        _capture_paused = false;
+        _capture_bytes = 0;
+        _capture_files = started ? 1 : 0;
+    });
+    return started;
+}
+
+void PortWorker::stop_capture()
+{
+    _backend->run([this]()
+    {
+        _capture.reset();
+        _capture_active = false;
+    });
+}
+
+void PortWorker::set_capture_paused(bool paused)
+{
+    _capture_paused = paused;
+}
+
+PortWorker::CaptureStats PortWorker::capture_stats() const
+{
+    return CaptureStats{_capture_active, _capture_paused, _capture_bytes, _capture_files};
+}
+
+void PortWorker::read_port()
+{
+    const std::int64_t timestamp = monotonic_ns();
+    if(_queue.full())
+    {
+        if(_backend->bytes_available() < read_buffer_limit)
+        {
+            // leave data in the port until GUI catches up
+            if(!_stalled.exchange(true))
+            {
+                ++_stalls;
+            }
+            return;
+        }
+        // GUI is too far behind, the capture still gets every byte
+        const QByteArray dropped = _backend->read_all();
+        count_read(dropped.size());
+        capture(SENDER::DEVICE, timestamp, dropped);
+        _dropped_bytes += static_cast<std::uint64_t>(dropped.size());
+        return;
+    }
+
+    Chunk chunk{_backend->read_all(), timestamp};
+    if(chunk.data.isEmpty())
+    {
+        return;
+    }
+    count_read(chunk.data.size());
+    capture(SENDER::DEVICE, timestamp, chunk.data);
+    _queue.push(std::move(chunk));
+
+    const std::size_t depth = _queue.size();
+    if(depth > _queue_peak.load(std::memory_order_relaxed))
+    {
+        _queue_peak.store(depth, std::memory_order_relaxed);
+    }
+
+    if(!_notify_pending.exchange(true))
+    {
+        emit received();
+    }
+}
+
+void PortWorker::flush_tx()
+{
+    while(_backend->is_open() && _backend->bytes_to_write() < tx_port_limit)
+    {
+        QByteArray block;
+        {
+            std::lock_guard<std::mutex> lock(_tx_mutex);
+            if(_tx_blocks.empty())
+            {
+                _tx_flush_pending = false;
+                return;
+            }
+            block = std::move(_tx_blocks.front());
+            _tx_blocks.pop_front();
+        }
+
+        const std::int64_t timestamp = monotonic_ns();
+        capture(SENDER::USER, timestamp, block);
+        if(_backend->bytes_to_write() == 0)
+        {
+            _tx_waiting_since = timestamp;
+        }
+        _tx_handed += static_cast<std::uint64_t>(block.size());
+        _tx_stamps.push(TxStamp{_tx_handed, timestamp});
+        if(_backend->write(block) < 0)
+        {
+            _tx_queued -= static_cast<std::size_t>(block.size());
+        }
+        _tx_port_bytes = static_cast<std::size_t>(_backend->bytes_to_write());
+        count<std::uint64_t>(_tx_flushes, 1);
+    }
+    // the rest goes out from tx_written()
+}
+
+void PortWorker::tx_written(qint64 bytes)
+{
+    const std::int64_t now = monotonic_ns();
+    count<std::uint64_t>(_tx_bytes, static_cast<std::uint64_t>(bytes));
+    _tx_queued -= static_cast<std::size_t>(bytes);
+
+    // time beyond what the line needs for these bytes was spent held back,
+    // by flow control or a driver that does not keep up
+    const std::int64_t waiting_since = _tx_waiting_since.load(std::memory_order_relaxed);
+    if(waiting_since > 0)
+    {
+        const std::int64_t excess = now - waiting_since - line_time(static_cast<std::size_t>(bytes), _baud_rate);
+        if(excess > tx_stall_slack)
+        {
+            count<std::int64_t>(_tx_blocked_time, excess - tx_stall_slack);
+        }
+    }
+    _tx_port_bytes = static_cast<std::size_t>(_backend->bytes_to_write());
+    _tx_waiting_since = _tx_port_bytes > 0 ? now : 0;
+
+    flush_tx();
+}
+
+void PortWorker::count_read(int size)
+{
+    count<std::uint64_t>(_rx_bytes, static_cast<std::uint64_t>(size));
+    count<std::uint64_t>(_read_callbacks, 1);
+    count<std::uint64_t>(_read_sizes[PortStats::size_bucket(static_cast<std::size_t>(size))], 1);
+}
+
+void PortWorker::port_error(QSerialPort::SerialPortError error)
+{
+    if(error == QSerialPort::ResourceError)
+    {
+        // device went away
+        _backend->close();
+        _open = false;
+
+        // nothing left to write to, dropped blocks still move the stream position
+        {
+            std::lock_guard<std::mutex> lock(_tx_mutex);
+            for(const QByteArray& block : _tx_blocks)
+            {
+                _tx_handed += static_cast<std::uint64_t>(block.size());
+            }
+            _tx_blocks.clear();
+            _tx_flush_pending = false;
+            _tx_queued = 0;
+        }
+        _tx_waiting_since = 0;
+        emit closed();
+    }
+}
+
+void PortWorker::update_settings()
+{
+    _baud_rate = _backend->baud_rate();
+    _rts = _backend->rts();
+    _dtr = _backend->dtr();
+    _flow = _backend->flow_control();
+}
+
+void PortWorker::capture(const SENDER& sender, std::int64_t timestamp, const QByteArray& data)
+{
+    if(!_capture || _capture_paused.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    if(!_capture->write(sender, timestamp, data.constData(), static_cast<std::size_t>(data.size())))
+    {
+        // disk full or similar, stop instead of failing on every read
+        _capture.reset();
+        _capture_active = false;
+        return;
+    }
+    _capture_bytes = _capture->bytes_written();
+    _capture_files = _capture->files();
+}
@@ -0,0 +1,182 @@
+#ifndef PORTWORKER_HPP
+#define PORTWORKER_HPP
+
+/*
+Serial port served off the GUI thread. Received data is stamped right after
+the read and handed to the GUI through a bounded lock-free queue, so reads
+never wait for the GUI. Port settings are applied on the backend's thread,
+getters return the last applied value. The backend decides which thread
+that is, see PortBackend: a thread per port, or a PortReactor thread shared
+by many ports.
+
+Writes go through a TX queue bounded by a high-water mark. Small writes are
+coalesced into blocks and the backend only ever holds a couple of them, the
+rest waits in the queue until bytes_written reports progress. Every block is
+stamped right before it is handed to the backend and the stamp goes back to
+the GUI through a second lock-free queue, positions in the TX stream tell
+which writes it covers.
+*/
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include <QObject>
+#include <QByteArray>
+#include <QSerialPort>
+
+#include "portbackend.hpp"
+#include "spscqueue.hpp"
+#include "capturewriter.hpp"
+#include "portstats.hpp"
+
+class PortWorker : public QObject
+{
+    Q_OBJECT
+
+signals:
+
+    // emitted when queue stops being empty, drain it with pop()
+    void received();
+
+    // device went away, emitted on the backend thread
+    void closed();
+
+public:
+
+    struct Chunk
+    {
+        QByteArray data;
+        std::int64_t timestamp;
+    };
+
+    // everything written before end went to the driver at timestamp
+    struct TxStamp
+    {
+        std::uint64_t end;
+        std::int64_t timestamp;
+    };
+
+    struct QueueStats
+    {
+        std::size_t depth;
+        std::size_t capacity;
+        std::uint64_t stalls;        // reads held back because queue was full
+        std::uint64_t dropped_bytes; // bytes discarded after port buffer filled up
+    };
+
+    struct CaptureStats
+    {
+        bool active;
+        bool paused;
+        std::uint64_t bytes;
+        int files;
+    };
+
+    // name as listed by QSerialPortInfo or full device path, served by a SerialBackend
+    explicit PortWorker(const QString& name, QObject *parent = nullptr);
+    explicit PortWorker(std::unique_ptr<PortBackend> backend, QObject *parent = nullptr);
+    ~PortWorker() override;
+
+    bool open();
+    bool is_open() const;
+    QString port_name() const;
+
+    // callable from any thread, false when the TX queue is above its high-water mark,
+    // end is set to the position right after data in the TX stream
+    bool write(const QByteArray& data, std::uint64_t* end = nullptr);
+
+    // bytes accepted but not written yet, a single larger write still fits an empty queue
+    void set_tx_high_water(std::size_t bytes);
+    std::size_t tx_high_water() const;
+
+    void set_baud_rate(int baud_rate);
+    int baud_rate() const;
+
+    void set_rts(bool rts);
+    bool rts() const;
+
+    void set_dtr(bool dtr);
+    bool dtr() const;
+
+    bool set_flow_control(QSerialPort::FlowControl flow);
+    QSerialPort::FlowControl flow_control() const;
+
+    // GUI side of the queue
+    bool pop(Chunk& chunk);
+    // stamps of blocks handed to the driver, oldest first, dropped when nobody reads them
+    bool pop_tx_stamp(TxStamp& stamp);
+    QueueStats queue_stats() const;
+
+    // fills the worker side counters of a snapshot
+    void traffic_stats(PortStats& stats) const;
+
+    // records all traffic on the backend thread, see CaptureWriter
+    bool start_capture(const QString& base, qint64 file_limit, QString* error = nullptr);
+    void stop_capture();
+    // keeps the capture files open, traffic meanwhile is not recorded
+    void set_capture_paused(bool paused);
+    CaptureStats capture_stats() const;
+
+private:
+
+    // backend thread
+    void read_port();
+    void flush_tx();
+    void tx_written(qint64 bytes);
+    void count_read(int size);
+    void port_error(QSerialPort::SerialPortError error);
+    void update_settings();
+    void capture(const SENDER& sender, std::int64_t timestamp, const QByteArray& data);
+
+    QString _name;
+    std::unique_ptr<PortBackend> _backend;
+    SpscQueue<Chunk> _queue;
+    std::unique_ptr<CaptureWriter> _capture;
+
+    std::atomic<bool> _notify_pending;
+    std::atomic<bool> _stalled;
+    std::atomic<bool> _open;
+    std::atomic<int> _baud_rate;
+    std::atomic<bool> _rts;
+    std::atomic<bool> _dtr;
+    std::atomic<int> _flow;
+
+    // blocks waiting for the port, appended to from any thread
+    std::mutex _tx_mutex;
+    std::deque<QByteArray> _tx_blocks;
+    bool _tx_flush_pending;
+    std::uint64_t _tx_accepted;
+    std::atomic<std::size_t> _tx_queued;
+    std::atomic<std::size_t> _tx_high_water;
+    std::atomic<std::size_t> _tx_queue_peak;
+    std::atomic<std::uint64_t> _tx_writes;
+    std::atomic<std::uint64_t> _tx_rejected_bytes;
+
+    // written by the backend thread only
+    std::atomic<std::uint64_t> _rx_bytes;
+    std::atomic<std::uint64_t> _tx_bytes;
+    std::atomic<std::uint64_t> _read_callbacks;
+    std::array<std::atomic<std::uint64_t>, PortStats::size_buckets> _read_sizes;
+    std::atomic<std::size_t> _queue_peak;
+    std::atomic<std::uint64_t> _tx_flushes;
+    std::atomic<std::int64_t> _tx_blocked_time;
+    // last progress while the backend has data to write, 0 when it is idle
+    std::atomic<std::int64_t> _tx_waiting_since;
+    std::atomic<std::size_t> _tx_port_bytes;
+    std::uint64_t _tx_handed;
+    SpscQueue<TxStamp> _tx_stamps;
+
+    std::atomic<std::uint64_t> _stalls;
+    std::atomic<std::uint64_t> _dropped_bytes;
+    std::atomic<bool> _capture_active;
+    std::atomic<bool> _capture_paused;
+    std::atomic<std::uint64_t> _capture_bytes;
+    std::atomic<int> _capture_files;
+};
+
+#endif
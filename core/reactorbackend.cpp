@@ -0,0 +1,394 @@
+#include "reactorbackend.hpp"
+
+#include <cerrno>
+
+#include <QFile>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace
+{
+    struct Speed
+    {
+        int baud_rate;
+        speed_t speed;
+    };
+
+    const Speed speeds[] = {
+        {50, B50}, {75, B75}, {110, B110}, {134, B134}, {150, B150}, {200, B200}, {300, B300},
+        {600, B600}, {1200, B1200}, {1800, B1800}, {2400, B2400}, {4800, B4800}, {9600, B9600},
+        {19200, B19200}, {38400, B38400}, {57600, B57600}, {115200, B115200}, {230400, B230400},
+        {460800, B460800}, {500000, B500000}, {576000, B576000}, {921600, B921600},
+        {1000000, B1000000}, {1152000, B1152000}, {1500000, B1500000}, {2000000, B2000000},
+        {2500000, B2500000}, {3000000, B3000000}, {3500000, B3500000}, {4000000, B4000000}
+    };
+
+    bool to_speed(int baud_rate, speed_t& speed)
+    {
+        for(const Speed& entry : speeds)
+        {
+            if(entry.baud_rate == baud_rate)
+            {
+                speed = entry.speed;
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+ReactorBackend::ReactorBackend(const QString& name, PortReactor* reactor) :
+    _name(name), _reactor(reactor), _loop(reactor->assign()), _fd(-1), _events(0), _callbacks(),
+    _rx(), _rx_limit(0), _tx(), _tx_written(0),
+    _baud_rate(QSerialPort::Baud9600), _rts(false), _dtr(false), _flow(QSerialPort::NoFlowControl)
+{
+
+}
+
+ReactorBackend::~ReactorBackend()
+{
+    run([this]()
+    {
+        close();
+    });
+    _reactor->release(_loop);
+}
+
+void ReactorBackend::set_callbacks(const Callbacks& callbacks)
+{
+    _callbacks = callbacks;
+}
+
+void ReactorBackend::post(std::function<void()> task)
+{
+    _reactor->post(_loop, std::move(task));
+}
+
+void ReactorBackend::run(std::function<void()> task)
+{
+    _reactor->run(_loop, std::move(task));
+}
+
+QString ReactorBackend::name() const
+{
+    return _name;
+}
+
+bool ReactorBackend::open()
+{
+    if(_fd >= 0)
+    {
+        return false;
+    }
+    const QString path = _name.startsWith('/') ? _name : "/dev/" + _name;
+    _fd = ::open(QFile::encodeName(path).constData(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if(_fd < 0)
+    {
+        return false;
+    }
+    if(!apply_settings(_baud_rate, _flow) || !_reactor->add(_loop, _fd, EPOLLIN, this))
+    {
+        ::close(_fd);
+        _fd = -1;
+        return false;
+    }
+    _events = EPOLLIN;
+
+    // lines keep whatever state the driver gave them on open
+    int lines = 0;
+    if(ioctl(_fd, TIOCMGET, &lines) == 0)
+    {
+        _rts = lines & TIOCM_RTS;
+        _dtr = lines & TIOCM_DTR;
+    }
+    return true;
+}
+
+void ReactorBackend::close()
+{
+    if(_fd < 0)
+    {
+        return;
+    }
+    _reactor->remove(_loop, _fd);
+    ::close(_fd);
+    _fd = -1;
+    _events = 0;
+    _rx.clear();
+    _tx.clear();
+    _tx_written = 0;
+}
+
+bool ReactorBackend::is_open() const
+{
+    return _fd >= 0;
+}
+
+void ReactorBackend::set_read_buffer_size(qint64 limit)
+{
+    _rx_limit = limit;
+    update_events();
+}
+
+qint64 ReactorBackend::bytes_available() const
+{
+    return _rx.size();
+}
+
+QByteArray ReactorBackend::read_all()
+{
+    QByteArray data;
+    data.swap(_rx);
+    update_events();
+    return data;
+}
+
+qint64 ReactorBackend::write(const QByteArray& data)
+{
+    if(_fd < 0)
+    {
+        return -1;
+    }
+    // written from io_ready, reporting progress from in here would reenter the caller
+    _tx.append(data);
+    update_events();
+    return data.size();
+}
+
+qint64 ReactorBackend::bytes_to_write() const
+{
+    return _tx.size() - _tx_written;
+}
+
+bool ReactorBackend::set_baud_rate(int baud_rate)
+{
+    speed_t speed;
+    if(!to_speed(baud_rate, speed))
+    {
+        return false;
+    }
+    if(_fd < 0)
+    {
+        _baud_rate = baud_rate;
+        return true;
+    }
+    return apply_settings(baud_rate, _flow);
+}
+
+int ReactorBackend::baud_rate() const
+{
+    return _baud_rate;
+}
+
+bool ReactorBackend::set_rts(bool rts)
+{
+    if(_fd >= 0 && !set_line(TIOCM_RTS, rts))
+    {
+        return false;
+    }
+    _rts = rts;
+    return true;
+}
+
+bool ReactorBackend::rts() const
+{
+    return _rts;
+}
+
+bool ReactorBackend::set_dtr(bool dtr)
+{
+    if(_fd >= 0 && !set_line(TIOCM_DTR, dtr))
+    {
+        return false;
+    }
+    _dtr = dtr;
+    return true;
+}
+
+bool ReactorBackend::dtr() const
+{
+    return _dtr;
+}
+
+bool ReactorBackend::set_flow_control(QSerialPort::FlowControl flow)
+{
+    if(_fd < 0)
+    {
+        _flow = flow;
+        return true;
+    }
+    return apply_settings(_baud_rate, flow);
+}
+
+QSerialPort::FlowControl ReactorBackend::flow_control() const
+{
+    return _flow;
+}
+
+void ReactorBackend::io_ready(std::uint32_t events)
+{
+    // data that arrived with a hangup is still delivered
+    if(_fd >= 0 && (events & EPOLLIN))
+    {
+        read_device();
+    }
+    if(_fd >= 0 && (events & EPOLLOUT))
+    {
+        write_device();
+    }
+    if(_fd >= 0 && (events & (EPOLLERR | EPOLLHUP)))
+    {
+        fail(QSerialPort::ResourceError);
+    }
+}
+
+void ReactorBackend::read_device()
+{
+    char* buffer = _reactor->read_buffer(_loop);
+    const std::size_t capacity = _reactor->read_buffer_size();
+    bool received = false;
+    bool failed = false;
+    while(_rx_limit == 0 || _rx.size() < _rx_limit)
+    {
+        const ssize_t size = ::read(_fd, buffer, capacity);
+        if(size > 0)
+        {
+            _rx.append(buffer, static_cast<int>(size));
+            received = true;
+            if(static_cast<std::size_t>(size) < capacity)
+            {
+                break;
+            }
+        }
+        else if(size < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else
+        {
+            failed = size < 0 && errno != EAGAIN && errno != EWOULDBLOCK;
+            break;
+        }
+    }
+    update_events();
+    if(received)
+    {
+        _callbacks.ready_read();
+    }
+    if(failed && _fd >= 0)
+    {
+        fail(QSerialPort::ResourceError);
+    }
+}
+
+void ReactorBackend::write_device()
+{
+    qint64 total = 0;
+    while(_tx_written < _tx.size())
+    {
+        const ssize_t size = ::write(_fd, _tx.constData() + _tx_written, static_cast<std::size_t>(_tx.size() - _tx_written));
+        if(size > 0)
+        {
+            _tx_written += static_cast<int>(size);
+            total += size;
+        }
+        else if(size < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if(size < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            fail(QSerialPort::ResourceError);
+            return;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if(_tx_written == _tx.size())
+    {
+        _tx.clear();
+        _tx_written = 0;
+    }
+    update_events();
+    if(total > 0)
+    {
+        _callbacks.bytes_written(total);
+    }
+}
+
+void ReactorBackend::update_events()
+{
+    if(_fd < 0)
+    {
+        return;
+    }
+    std::uint32_t events = 0;
+    if(_rx_limit == 0 || _rx.size() < _rx_limit)
+    {
+        events |= EPOLLIN;
+    }
+    if(_tx_written < _tx.size())
+    {
+        events |= EPOLLOUT;
+    }
+    if(events != _events && _reactor->modify(_loop, _fd, events, this))
+    {
+        _events = events;
+    }
+}
+
+bool ReactorBackend::apply_settings(int baud_rate, QSerialPort::FlowControl flow)
+{
+    speed_t speed;
+    termios attributes;
+    if(!to_speed(baud_rate, speed) || tcgetattr(_fd, &attributes) != 0)
+    {
+        return false;
+    }
+
+    // 8N1 without any line processing, reads return whatever is there
+    cfmakeraw(&attributes);
+    attributes.c_cflag |= CLOCAL | CREAD;
+    attributes.c_cflag &= ~static_cast<tcflag_t>(CSTOPB | PARENB | CRTSCTS);
+    attributes.c_iflag &= ~static_cast<tcflag_t>(IXON | IXOFF | IXANY);
+    if(flow == QSerialPort::HardwareControl)
+    {
+        attributes.c_cflag |= CRTSCTS;
+    }
+    else if(flow == QSerialPort::SoftwareControl)
+    {
+        attributes.c_iflag |= IXON | IXOFF;
+    }
+    attributes.c_cc[VMIN] = 0;
+    attributes.c_cc[VTIME] = 0;
+    cfsetispeed(&attributes, speed);
+    cfsetospeed(&attributes, speed);
+    if(tcsetattr(_fd, TCSANOW, &attributes) != 0)
+    {
+        return false;
+    }
+    _baud_rate = baud_rate;
+    _flow = flow;
+    return true;
+}
+
+bool ReactorBackend::set_line(int line, bool on)
+{
+    return ioctl(_fd, on ? TIOCMBIS : TIOCMBIC, &line) == 0;
+}
+
+void ReactorBackend::fail(QSerialPort::SerialPortError error)
+{
+    _callbacks.error(error);
+    // a descriptor left open after a hangup would be reported again on every wakeup
+    if(error == QSerialPort::ResourceError)
+    {
+        close();
+    }
+}
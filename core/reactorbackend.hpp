@@ -0,0 +1,87 @@
+#ifndef REACTORBACKEND_HPP
+#define REACTORBACKEND_HPP
+
+/*
+Port backend on a raw termios descriptor served by a PortReactor loop, so
+dozens of ports share a few threads instead of one each. Behaves like
+QSerialPort does for PortWorker: received data waits here until read_all()
+up to the read buffer size, beyond it the descriptor is no longer polled
+for input, and writes are buffered and reported through bytes_written as
+the driver takes them.
+
+Baud rates are the ones termios has a constant for, others are refused.
+Linux only.
+*/
+
+#include <cstdint>
+
+#include "portbackend.hpp"
+#include "portreactor.hpp"
+
+class ReactorBackend : public PortBackend, private PortReactor::Handler
+{
+public:
+
+    // name as listed by QSerialPortInfo or full device path, reactor must outlive the backend
+    ReactorBackend(const QString& name, PortReactor* reactor);
+    ~ReactorBackend() override;
+
+    void set_callbacks(const Callbacks& callbacks) override;
+
+    void post(std::function<void()> task) override;
+    void run(std::function<void()> task) override;
+
+    QString name() const override;
+    bool open() override;
+    void close() override;
+    bool is_open() const override;
+
+    void set_read_buffer_size(qint64 limit) override;
+    qint64 bytes_available() const override;
+    QByteArray read_all() override;
+
+    qint64 write(const QByteArray& data) override;
+    qint64 bytes_to_write() const override;
+
+    bool set_baud_rate(int baud_rate) override;
+    int baud_rate() const override;
+
+    bool set_rts(bool rts) override;
+    bool rts() const override;
+
+    bool set_dtr(bool dtr) override;
+    bool dtr() const override;
+
+    bool set_flow_control(QSerialPort::FlowControl flow) override;
+    QSerialPort::FlowControl flow_control() const override;
+
+private:
+
+    void io_ready(std::uint32_t events) override;
+    void read_device();
+    void write_device();
+    // polls for input while the read buffer has room and for output while data waits
+    void update_events();
+    bool apply_settings(int baud_rate, QSerialPort::FlowControl flow);
+    bool set_line(int line, bool on);
+    void fail(QSerialPort::SerialPortError error);
+
+    QString _name;
+    PortReactor* _reactor;
+    int _loop;
+    int _fd;
+    std::uint32_t _events;
+    Callbacks _callbacks;
+
+    QByteArray _rx;
+    qint64 _rx_limit;
+    QByteArray _tx;
+    int _tx_written;    // leading part of _tx already taken by the driver
+
+    int _baud_rate;
+    bool _rts;
+    bool _dtr;
+    QSerialPort::FlowControl _flow;
+};
+
+#endif
@@ -0,0 +1,249 @@
+#include "replayengine.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "capturereader.hpp"
+
+namespace
+{
+    // how often a blocked engine looks at the stop flag
+    const std::chrono::milliseconds stop_check(50);
+
+    void make_raw(int fd)
+    {
+        termios attributes;
+        if(tcgetattr(fd, &attributes) == 0)
+        {
+            cfmakeraw(&attributes);
+            tcsetattr(fd, TCSANOW, &attributes);
+        }
+    }
+}
+
+ReplayEngine::ReplayEngine(const QStringList& files, double speed, bool loop) :
+    _files(files), _speed(std::max(0.0, speed)), _loop(loop), _master(-1), _slave(-1),
+    _port_name(), _error(), _thread(), _running(false), _records(0), _bytes(0),
+    _max_lag(0), _finished(false)
+{
+
+}
+
+ReplayEngine::~ReplayEngine()
+{
+    stop();
+    if(_slave >= 0)
+    {
+        ::close(_slave);
+    }
+    if(_master >= 0)
+    {
+        ::close(_master);
+    }
+}
+
+bool ReplayEngine::open()
+{
+    _master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if(_master < 0 || grantpt(_master) != 0 || unlockpt(_master) != 0)
+    {
+        _error = QString::fromLocal8Bit(std::strerror(errno));
+        return false;
+    }
+    const char* name = ptsname(_master);
+    if(!name)
+    {
+        _error = QString::fromLocal8Bit(std::strerror(errno));
+        return false;
+    }
+    _port_name = QString::fromLocal8Bit(name);
+
+    // holding the slave open keeps the pty alive until the console opens it
+    _slave = ::open(name, O_RDWR | O_NOCTTY);
+    if(_slave < 0)
+    {
+        _error = QString::fromLocal8Bit(std::strerror(errno));
+        return false;
+    }
+    make_raw(_slave);
+    return true;
+}
+
+void ReplayEngine::start()
+{
+    if(_running || _master < 0)
+    {
+        return;
+    }
+    _running = true;
+    _finished = false;
+    _thread = std::thread(&ReplayEngine::run, this);
+}
+
+void ReplayEngine::stop()
+{
+    _running = false;
+    if(_thread.joinable())
+    {
+        _thread.join();
+    }
+}
+
+QString ReplayEngine::port_name() const
+{
+    return _port_name;
+}
+
+QStringList ReplayEngine::files() const
+{
+    return _files;
+}
+
+QString ReplayEngine::error_string() const
+{
+    return _error;
+}
+
+ReplayEngine::Stats ReplayEngine::stats() const
+{
+    return Stats{_records, _bytes, _max_lag, _finished};
+}
+
+void ReplayEngine::run()
+{
+    do
+    {
+        bool first = true;
+        std::int64_t first_timestamp = 0;
+        const clock::time_point start = clock::now();
+
+        for(const QString& path : _files)
+        {
+            CaptureReader reader(path);
+            if(!reader.open())
+            {
+                continue;
+            }
+
+            CaptureReader::Record record;
+            while(_running && reader.next(record))
+            {
+                if(record.sender != SENDER::DEVICE)
+                {
+                    continue;
+                }
+                if(first)
+                {
+                    first_timestamp = record.timestamp;
+                    first = false;
+                }
+
+                if(_speed > 0)
+                {
+                    const auto offset = std::chrono::nanoseconds(
+                                static_cast<std::int64_t>(static_cast<double>(record.timestamp - first_timestamp) / _speed));
+                    const clock::time_point deadline = start + std::chrono::duration_cast<clock::duration>(offset);
+                    if(!wait_until(deadline))
+                    {
+                        return;
+                    }
+                    const std::int64_t lag = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - deadline).count();
+                    if(lag > _max_lag)
+                    {
+                        _max_lag = lag;
+                    }
+                }
+
+                if(!write_all(record.data, record.length))
+                {
+                    return;
+                }
+                ++_records;
+                _bytes += record.length;
+            }
+        }
+    }
+    while(_running && _loop);
+
+    _finished = true;
+
+    // keep consuming what the console sends until stopped
+    while(_running)
+    {
+        wait_until(clock::now() + stop_check);
+    }
+}
+
+bool ReplayEngine::wait_until(clock::time_point deadline)
+{
+    while(_running)
+    {
+        const clock::time_point now = clock::now();
+        if(now >= deadline)
+        {
+            return true;
+        }
+
+        const auto remaining = std::min<clock::duration>(deadline - now, stop_check);
+        const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(remaining);
+        if(milliseconds.count() == 0)
+        {
+            // below poll resolution
+            std::this_thread::sleep_for(remaining);
+            continue;
+        }
+
+        pollfd fd{_master, POLLIN, 0};
+        if(poll(&fd, 1, static_cast<int>(milliseconds.count())) > 0)
+        {
+            drain_input();
+        }
+    }
+    return false;
+}
+
+bool ReplayEngine::write_all(const char* data, std::size_t size)
+{
+    while(size > 0)
+    {
+        const ssize_t written = ::write(_master, data, size);
+        if(written > 0)
+        {
+            data += written;
+            size -= static_cast<std::size_t>(written);
+            continue;
+        }
+        if(written < 0 && errno != EAGAIN && errno != EINTR)
+        {
+            return false;
+        }
+
+        // pty buffer is full, wait for the reader
+        pollfd fd{_master, POLLIN | POLLOUT, 0};
+        if(poll(&fd, 1, static_cast<int>(stop_check.count())) > 0 && (fd.revents & POLLIN))
+        {
+            drain_input();
+        }
+        if(!_running)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ReplayEngine::drain_input()
+{
+    char discard[4096];
+    while(::read(_master, discard, sizeof(discard)) > 0)
+    {
+
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef REPLAYENGINE_HPP
+#define REPLAYENGINE_HPP
+
+/*
+Plays captured device traffic into a pseudo terminal. The slave side of the
+pty behaves like a serial port and can be opened like any other port,
+the engine plays the device on the master side. Data sent to the device is
+read and discarded. Unix only.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include <QString>
+#include <QStringList>
+
+class ReplayEngine
+{
+public:
+
+    struct Stats
+    {
+        std::uint64_t records;
+        std::uint64_t bytes;
+        std::int64_t max_lag;   // nanoseconds behind schedule, worst case
+        bool finished;
+    };
+
+    // speed multiplies original pace, 0 replays as fast as possible
+    explicit ReplayEngine(const QStringList& files, double speed = 1.0, bool loop = false);
+    ~ReplayEngine();
+
+    ReplayEngine(const ReplayEngine&) = delete;
+    ReplayEngine& operator=(const ReplayEngine&) = delete;
+
+    // creates the pty pair
+    bool open();
+    void start();
+    void stop();
+
+    // path of the pty slave, e.g. /dev/pts/3
+    QString port_name() const;
+    QStringList files() const;
+    QString error_string() const;
+    Stats stats() const;
+
+private:
+
+    using clock = std::chrono::steady_clock;
+
+    void run();
+    bool wait_until(clock::time_point deadline);
+    bool write_all(const char* data, std::size_t size);
+    void drain_input();
+
+    QStringList _files;
+    double _speed;
+    bool _loop;
+
+    int _master;
+    int _slave;
+    QString _port_name;
+    QString _error;
+
+    std::thread _thread;
+    std::atomic<bool> _running;
+    std::atomic<std::uint64_t> _records;
+    std::atomic<std::uint64_t> _bytes;
+    std::atomic<std::int64_t> _max_lag;
+    std::atomic<bool> _finished;
+};
+
+#endif
@@ -0,0 +1,224 @@
+#include "scrollbackbuffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    const std::size_t minimum_capacity = 4096;
+}
+
+ScrollbackBuffer::ScrollbackBuffer(std::size_t capacity) :
+    _data(std::max(capacity, minimum_capacity)), _chunks(), _blocks(), _first_block(0), _begin(0), _end(0)
+{
+
+}
+
+void ScrollbackBuffer::set_capacity(std::size_t capacity)
+{
+    capacity = std::max(capacity, minimum_capacity);
+    if(capacity == _data.size())
+    {
+        return;
+    }
+
+    std::vector<char> retained(size());
+    copy(_begin, retained.size(), retained.data());
+    const std::uint64_t retained_begin = _begin;
+
+    _data.assign(capacity, 0);
+    trim();
+
+    for(std::uint64_t offset = _begin; offset < _end; ++offset)
+    {
+        _data[offset % capacity] = retained[offset - retained_begin];
+    }
+}
+
+std::size_t ScrollbackBuffer::capacity() const
+{
+    return _data.size();
+}
+
+void ScrollbackBuffer::append(const char* data, std::size_t size, SENDER sender, std::int64_t timestamp, std::uint8_t flags)
+{
+    if(size == 0)
+    {
+        return;
+    }
+
+    const std::size_t capacity = _data.size();
+    const std::uint64_t offset = _end;
+
+    // only the tail of an oversized chunk can ever be retained
+    std::size_t skip = size > capacity ? size - capacity : 0;
+    std::uint64_t position = offset + skip;
+    while(skip < size)
+    {
+        const std::size_t index = position % capacity;
+        const std::size_t count = std::min(size - skip, capacity - index);
+        std::memcpy(_data.data() + index, data + skip, count);
+        skip += count;
+        position += count;
+    }
+
+    skip = size > capacity ? size - capacity : 0;
+    index(data + skip, size - skip, offset + skip);
+
+    _end += size;
+    _chunks.push_back(Chunk{offset, static_cast<std::uint32_t>(size), sender, flags, timestamp});
+    trim();
+}
+
+void ScrollbackBuffer::clear()
+{
+    _chunks.clear();
+    _blocks.clear();
+    _first_block = _end / index_block;
+    _begin = _end;
+}
+
+std::uint64_t ScrollbackBuffer::begin_offset() const
+{
+    return _begin;
+}
+
+std::uint64_t ScrollbackBuffer::end_offset() const
+{
+    return _end;
+}
+
+std::size_t ScrollbackBuffer::size() const
+{
+    return static_cast<std::size_t>(_end - _begin);
+}
+
+bool ScrollbackBuffer::empty() const
+{
+    return _begin == _end;
+}
+
+void ScrollbackBuffer::copy(std::uint64_t offset, std::size_t size, char* out) const
+{
+    const std::size_t capacity = _data.size();
+    while(size > 0)
+    {
+        const std::size_t index = offset % capacity;
+        const std::size_t count = std::min(size, capacity - index);
+        std::memcpy(out, _data.data() + index, count);
+        out += count;
+        offset += count;
+        size -= count;
+    }
+}
+
+char ScrollbackBuffer::at(std::uint64_t offset) const
+{
+    return _data[offset % _data.size()];
+}
+
+std::uint64_t ScrollbackBuffer::find(std::uint64_t from, std::uint64_t to, char byte) const
+{
+    const std::size_t capacity = _data.size();
+    while(from < to)
+    {
+        const std::size_t index = from % capacity;
+        const std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(to - from, capacity - index));
+        const void* found = std::memchr(_data.data() + index, byte, count);
+        if(found)
+        {
+            return from + static_cast<std::uint64_t>(static_cast<const char*>(found) - (_data.data() + index));
+        }
+        from += count;
+    }
+    return to;
+}
+
+bool ScrollbackBuffer::block_contains(std::uint64_t offset, unsigned char byte) const
+{
+    const std::uint64_t block = offset / index_block;
+    if(block < _first_block || block - _first_block >= _blocks.size())
+    {
+        return true;
+    }
+    const ByteSet& set = _blocks[static_cast<std::size_t>(block - _first_block)];
+    return (set[byte >> 6] >> (byte & 63)) & 1;
+}
+
+const std::deque<ScrollbackBuffer::Chunk>& ScrollbackBuffer::chunks() const
+{
+    return _chunks;
+}
+
+std::size_t ScrollbackBuffer::chunk_index(std::uint64_t offset) const
+{
+    if(offset < _begin || offset >= _end)
+    {
+        return _chunks.size();
+    }
+    auto it = std::upper_bound(_chunks.begin(), _chunks.end(), offset,
+                               [](std::uint64_t value, const Chunk& chunk)
+    {
+        return value < chunk.offset;
+    });
+    return static_cast<std::size_t>(std::distance(_chunks.begin(), it)) - 1;
+}
+
+std::size_t ScrollbackBuffer::used() const
+{
+    return size() + _chunks.size() * sizeof(Chunk);
+}
+
+void ScrollbackBuffer::trim()
+{
+    const std::size_t capacity = _data.size();
+    while(_chunks.size() > 1 && used() > capacity)
+    {
+        _chunks.pop_front();
+        _begin = _chunks.front().offset;
+    }
+    if(_chunks.size() == 1 && used() > capacity)
+    {
+        // single chunk larger than the whole buffer, keep its tail
+        Chunk& chunk = _chunks.front();
+        const std::uint64_t keep = capacity - sizeof(Chunk);
+        chunk.offset = chunk.end() - keep;
+        chunk.length = static_cast<std::uint32_t>(keep);
+    }
+    if(!_chunks.empty())
+    {
+        _begin = _chunks.front().offset;
+    }
+
+    while(!_blocks.empty() && (_first_block + 1) * index_block <= _begin)
+    {
+        _blocks.pop_front();
+        ++_first_block;
+    }
+}
+
+void ScrollbackBuffer::index(const char* data, std::size_t size, std::uint64_t offset)
+{
+    if(_blocks.empty())
+    {
+        _first_block = offset / index_block;
+    }
+    while(size > 0)
+    {
+        const std::uint64_t block = offset / index_block;
+        while(_first_block + _blocks.size() <= block)
+        {
+            _blocks.push_back(ByteSet{});
+        }
+        ByteSet& set = _blocks.back();
+        const std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(size, (block + 1) * index_block - offset));
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            const unsigned char byte = static_cast<unsigned char>(data[i]);
+            set[byte >> 6] |= std::uint64_t(1) << (byte & 63);
+        }
+        data += count;
+        offset += count;
+        size -= count;
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef SCROLLBACKBUFFER_HPP
+#define SCROLLBACKBUFFER_HPP
+
+/*
+Bounded ring buffer of raw bytes exchanged with serial port. Every appended
+chunk keeps its sender and timestamp. Offsets are absolute positions in the
+session stream, so they stay valid while old data is being dropped.
+
+For searching, every 64 KB block of the stream records which byte values it
+holds. A block without the first byte of a pattern is skipped unread.
+*/
+
+#include <cstddef>
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "sender.hpp"
+
+class ScrollbackBuffer
+{
+public:
+
+    enum CHUNK_FLAG : std::uint8_t
+    {
+        FRAME = 1,          // chunk is one whole frame
+        BAD_FRAME = 2       // frame failed its checksum or was malformed
+    };
+
+    struct Chunk
+    {
+        std::uint64_t offset;
+        std::uint32_t length;
+        SENDER sender;
+        std::uint8_t flags;
+        std::int64_t timestamp;
+
+        std::uint64_t end() const { return offset + length; }
+    };
+
+    static const std::size_t index_block = 64 * 1024;
+
+    explicit ScrollbackBuffer(std::size_t capacity = 16 * 1024 * 1024);
+
+    // capacity in bytes, chunk metadata is counted against it as well
+    void set_capacity(std::size_t capacity);
+    std::size_t capacity() const;
+
+    void append(const char* data, std::size_t size, SENDER sender, std::int64_t timestamp, std::uint8_t flags = 0);
+    void clear();
+
+    // absolute offsets of the oldest retained byte and one past the newest
+    std::uint64_t begin_offset() const;
+    std::uint64_t end_offset() const;
+    std::size_t size() const;
+    bool empty() const;
+
+    // copies retained bytes [offset, offset + size) into out
+    void copy(std::uint64_t offset, std::size_t size, char* out) const;
+    char at(std::uint64_t offset) const;
+
+    // first occurrence of byte in [from, to) or to if not found
+    std::uint64_t find(std::uint64_t from, std::uint64_t to, char byte) const;
+
+    // false only when the block starting at offset / index_block * index_block
+    // certainly lacks the byte, blocks outside the buffer may contain anything
+    bool block_contains(std::uint64_t offset, unsigned char byte) const;
+
+    const std::deque<Chunk>& chunks() const;
+    // index of chunk containing offset, chunks().size() if none
+    std::size_t chunk_index(std::uint64_t offset) const;
+
+private:
+
+    std::size_t used() const;
+    void trim();
+    void index(const char* data, std::size_t size, std::uint64_t offset);
+
+    // one bit per byte value
+    typedef std::array<std::uint64_t, 4> ByteSet;
+
+    std::vector<char> _data;
+    std::deque<Chunk> _chunks;
+    std::deque<ByteSet> _blocks;
+    std::uint64_t _first_block;
+    std::uint64_t _begin;
+    std::uint64_t _end;
+};
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef SENDER_HPP
+#define SENDER_HPP
+
+/*
+Origin of data passing through serial port
+*/
+
+#include <cstdint>
+
+enum class SENDER : std::uint8_t
+{
+    NONE = 0,
+    USER,
+    DEVICE
+};
+
+#endif
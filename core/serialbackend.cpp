@@ -0,0 +1,136 @@
+#include "serialbackend.hpp"
+
+SerialBackend::SerialBackend(const QString& name) :
+    _name(name), _thread(), _port(new QSerialPort(name)), _callbacks()
+{
+    _thread.setObjectName(_name);
+    _port->moveToThread(&_thread);
+
+    // _port as context makes these run on the port's thread
+    QObject::connect(_port, &QSerialPort::readyRead, _port, [this]()
+    {
+        _callbacks.ready_read();
+    });
+    QObject::connect(_port, &QSerialPort::bytesWritten, _port, [this](qint64 bytes)
+    {
+        _callbacks.bytes_written(bytes);
+    });
+    QObject::connect(_port, &QSerialPort::errorOccurred, _port, [this](QSerialPort::SerialPortError error)
+    {
+        _callbacks.error(error);
+    });
+
+    _thread.start();
+}
+
+SerialBackend::~SerialBackend()
+{
+    run([this]()
+    {
+        _port->close();
+    });
+
+    _thread.quit();
+    _thread.wait();
+    delete _port;
+}
+
+void SerialBackend::set_callbacks(const Callbacks& callbacks)
+{
+    _callbacks = callbacks;
+}
+
+void SerialBackend::post(std::function<void()> task)
+{
+    QMetaObject::invokeMethod(_port, std::move(task), Qt::QueuedConnection);
+}
+
+void SerialBackend::run(std::function<void()> task)
+{
+    QMetaObject::invokeMethod(_port, std::move(task), Qt::BlockingQueuedConnection);
+}
+
+QString SerialBackend::name() const
+{
+    return _name;
+}
+
+bool SerialBackend::open()
+{
+    return _port->open(QIODevice::ReadWrite);
+}
+
+void SerialBackend::close()
+{
+    _port->close();
+}
+
+bool SerialBackend::is_open() const
+{
+    return _port->isOpen();
+}
+
+void SerialBackend::set_read_buffer_size(qint64 limit)
+{
+    _port->setReadBufferSize(limit);
+}
+
+qint64 SerialBackend::bytes_available() const
+{
+    return _port->bytesAvailable();
+}
+
+QByteArray SerialBackend::read_all()
+{
+    return _port->readAll();
+}
+
+qint64 SerialBackend::write(const QByteArray& data)
+{
+    return _port->write(data);
+}
+
+qint64 SerialBackend::bytes_to_write() const
+{
+    return _port->bytesToWrite();
+}
+
+bool SerialBackend::set_baud_rate(int baud_rate)
+{
+    return _port->setBaudRate(baud_rate);
+}
+
+int SerialBackend::baud_rate() const
+{
+    return _port->baudRate();
+}
+
+bool SerialBackend::set_rts(bool rts)
+{
+    return _port->setRequestToSend(rts);
+}
+
+bool SerialBackend::rts() const
+{
+    return _port->isRequestToSend();
+}
+
+bool SerialBackend::set_dtr(bool dtr)
+{
+    return _port->setDataTerminalReady(dtr);
+}
+
+bool SerialBackend::dtr() const
+{
+    return _port->isDataTerminalReady();
+}
+
+bool SerialBackend::set_flow_control(QSerialPort::FlowControl flow)
+{
+    return _port->setFlowControl(flow);
+}
+
+QSerialPort::FlowControl SerialBackend::flow_control() const
+{
+    return _port->flowControl();
+}
@@ -0,0 +1,58 @@
+#ifndef SERIALBACKEND_HPP
+#define SERIALBACKEND_HPP
+
+/*
+Port backend on QSerialPort, moved to a thread of its own so its notifiers
+never share an event loop with the GUI. One thread per port.
+*/
+
+#include <QThread>
+
+#include "portbackend.hpp"
+
+class SerialBackend : public PortBackend
+{
+public:
+
+    // name as listed by QSerialPortInfo or full device path
+    explicit SerialBackend(const QString& name);
+    ~SerialBackend() override;
+
+    void set_callbacks(const Callbacks& callbacks) override;
+
+    void post(std::function<void()> task) override;
+    void run(std::function<void()> task) override;
+
+    QString name() const override;
+    bool open() override;
+    void close() override;
+    bool is_open() const override;
+
+    void set_read_buffer_size(qint64 limit) override;
+    qint64 bytes_available() const override;
+    QByteArray read_all() override;
+
+    qint64 write(const QByteArray& data) override;
+    qint64 bytes_to_write() const override;
+
+    bool set_baud_rate(int baud_rate) override;
+    int baud_rate() const override;
+
+    bool set_rts(bool rts) override;
+    bool rts() const override;
+
+    bool set_dtr(bool dtr) override;
+    bool dtr() const override;
+
+    bool set_flow_control(QSerialPort::FlowControl flow) override;
+    QSerialPort::FlowControl flow_control() const override;
+
+private:
+
+    QString _name;
+    QThread _thread;
+    QSerialPort* _port;
+    Callbacks _callbacks;
+};
+
+#endif
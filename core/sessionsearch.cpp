@@ -0,0 +1,321 @@
+#include "sessionsearch.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <vector>
+
+namespace
+{
+    // regex context carried over a block boundary
+    const std::uint64_t regex_overlap = 4096;
+
+    int hex_digit(QChar c)
+    {
+        const char ascii = c.toLatin1();
+        if(ascii >= '0' && ascii <= '9')
+        {
+            return ascii - '0';
+        }
+        if(ascii >= 'a' && ascii <= 'f')
+        {
+            return ascii - 'a' + 10;
+        }
+        if(ascii >= 'A' && ascii <= 'F')
+        {
+            return ascii - 'A' + 10;
+        }
+        return -1;
+    }
+
+    char fold(char c)
+    {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+}
+
+SessionSearch::SessionSearch() :
+    _mode(MODE::TEXT), _case_sensitive(true), _literal(), _regex(), _valid(false)
+{
+
+}
+
+bool SessionSearch::set_pattern(MODE mode, const QString& pattern, bool case_sensitive, QString* error)
+{
+    _mode = mode;
+    _case_sensitive = case_sensitive || mode == MODE::HEX;
+    _literal.clear();
+    _regex = QRegularExpression();
+    _valid = false;
+
+    if(pattern.isEmpty())
+    {
+        return false;
+    }
+
+    if(mode == MODE::TEXT)
+    {
+        const QByteArray bytes = pattern.toLatin1();
+        _literal.assign(bytes.constData(), static_cast<std::size_t>(bytes.size()));
+    }
+    else if(mode == MODE::HEX)
+    {
+        int high = -1;
+        for(const QChar c : pattern)
+        {
+            if(c.isSpace())
+            {
+                continue;
+            }
+            const int digit = hex_digit(c);
+            if(digit < 0)
+            {
+                if(error)
+                {
+                    *error = QString("'%1' is not a hex digit").arg(c);
+                }
+                return false;
+            }
+            if(high < 0)
+            {
+                high = digit;
+            }
+            else
+            {
+                _literal.push_back(static_cast<char>(high << 4 | digit));
+                high = -1;
+            }
+        }
+        if(high >= 0)
+        {
+            if(error)
+            {
+                *error = "Odd number of hex digits";
+            }
+            _literal.clear();
+            return false;
+        }
+    }
+    else
+    {
+        _regex.setPattern(pattern);
+        _regex.setPatternOptions(case_sensitive ? QRegularExpression::NoPatternOption : QRegularExpression::CaseInsensitiveOption);
+        if(!_regex.isValid())
+        {
+            if(error)
+            {
+                *error = _regex.errorString();
+            }
+            return false;
+        }
+        _regex.optimize();
+        _valid = true;
+        return true;
+    }
+
+    if(!_case_sensitive)
+    {
+        std::transform(_literal.begin(), _literal.end(), _literal.begin(), fold);
+    }
+    _valid = !_literal.empty();
+    return _valid;
+}
+
+bool SessionSearch::valid() const
+{
+    return _valid;
+}
+
+bool SessionSearch::find_next(const ScrollbackBuffer& buffer, std::uint64_t from, Match& match) const
+{
+    from = std::max(from, buffer.begin_offset());
+    return _valid && find_in(buffer, from, buffer.end_offset(), match);
+}
+
+bool SessionSearch::find_previous(const ScrollbackBuffer& buffer, std::uint64_t before, Match& match) const
+{
+    if(!_valid)
+    {
+        return false;
+    }
+    const std::uint64_t begin = buffer.begin_offset();
+    before = std::min(before, buffer.end_offset());
+
+    // walk back block by block, the last match of the first block that has one wins
+    std::vector<Match> matches;
+    std::uint64_t to = before;
+    while(to > begin)
+    {
+        const std::uint64_t from = std::max(begin, (to - 1) / ScrollbackBuffer::index_block * ScrollbackBuffer::index_block);
+        if(_mode != MODE::REGEX)
+        {
+            // literals step one byte past each match, so "aa" in "aaa" ends at 1
+            bool found = false;
+            Match next{};
+            for(std::uint64_t start = from; find_literal(buffer, start, to, next); start = next.offset + 1)
+            {
+                match = next;
+                found = true;
+            }
+            if(found)
+            {
+                return true;
+            }
+        }
+        else
+        {
+            matches.clear();
+            collect(buffer, from, to, matches, ScrollbackBuffer::index_block);
+            if(!matches.empty())
+            {
+                match = matches.back();
+                return true;
+            }
+        }
+        to = from;
+    }
+    return false;
+}
+
+std::size_t SessionSearch::count(const ScrollbackBuffer& buffer, std::size_t limit) const
+{
+    if(!_valid)
+    {
+        return 0;
+    }
+    std::vector<Match> matches;
+    collect(buffer, buffer.begin_offset(), buffer.end_offset(), matches, limit);
+    return matches.size();
+}
+
+bool SessionSearch::find_in(const ScrollbackBuffer& buffer, std::uint64_t from, std::uint64_t to, Match& match) const
+{
+    return _mode == MODE::REGEX ? find_regex(buffer, from, to, match) : find_literal(buffer, from, to, match);
+}
+
+bool SessionSearch::find_literal(const ScrollbackBuffer& buffer, std::uint64_t from, std::uint64_t to, Match& match) const
+{
+    const std::uint64_t size = _literal.size();
+    const std::uint64_t end = buffer.end_offset();
+    if(end < size)
+    {
+        return false;
+    }
+    to = std::min(to, end - size + 1);
+
+    const char first = _literal[0];
+    const char other = static_cast<char>(std::toupper(static_cast<unsigned char>(first)));
+    const bool two = !_case_sensitive && other != first;
+
+    while(from < to)
+    {
+        const std::uint64_t block_end = std::min(to, (from / ScrollbackBuffer::index_block + 1) * ScrollbackBuffer::index_block);
+        if(!buffer.block_contains(from, static_cast<unsigned char>(first)) &&
+           !(two && buffer.block_contains(from, static_cast<unsigned char>(other))))
+        {
+            from = block_end;
+            continue;
+        }
+
+        // next candidate of each case is remembered, so neither is scanned twice
+        std::uint64_t lower = buffer.find(from, block_end, first);
+        std::uint64_t upper = two ? buffer.find(from, block_end, other) : block_end;
+        while(lower < block_end || upper < block_end)
+        {
+            const std::uint64_t candidate = std::min(lower, upper);
+            if(matches_at(buffer, candidate))
+            {
+                match = Match{candidate, size};
+                return true;
+            }
+            if(candidate == lower)
+            {
+                lower = buffer.find(candidate + 1, block_end, first);
+            }
+            else
+            {
+                upper = buffer.find(candidate + 1, block_end, other);
+            }
+        }
+        from = block_end;
+    }
+    return false;
+}
+
+bool SessionSearch::find_regex(const ScrollbackBuffer& buffer, std::uint64_t from, std::uint64_t to, Match& match) const
+{
+    const std::uint64_t end = buffer.end_offset();
+    std::vector<char> bytes;
+    while(from < to)
+    {
+        const std::uint64_t block_end = std::min(to, (from / ScrollbackBuffer::index_block + 1) * ScrollbackBuffer::index_block);
+        const std::uint64_t read_end = std::min(end, block_end + regex_overlap);
+        bytes.resize(static_cast<std::size_t>(read_end - from));
+        buffer.copy(from, bytes.size(), bytes.data());
+
+        const QString text = QString::fromLatin1(bytes.data(), static_cast<int>(bytes.size()));
+        const QRegularExpressionMatch found = _regex.match(text);
+        if(found.hasMatch() && from + static_cast<std::uint64_t>(found.capturedStart()) < block_end)
+        {
+            match = Match{from + static_cast<std::uint64_t>(found.capturedStart()), static_cast<std::uint64_t>(found.capturedLength())};
+            return true;
+        }
+        from = block_end;
+    }
+    return false;
+}
+
+void SessionSearch::collect(const ScrollbackBuffer& buffer, std::uint64_t from, std::uint64_t to,
+                            std::vector<Match>& matches, std::size_t limit) const
+{
+    if(_mode != MODE::REGEX)
+    {
+        Match match{};
+        while(matches.size() < limit && find_literal(buffer, from, to, match))
+        {
+            matches.push_back(match);
+            from = match.offset + match.length;
+        }
+        return;
+    }
+
+    // one conversion per block instead of one per match
+    const std::uint64_t end = buffer.end_offset();
+    std::vector<char> bytes;
+    while(from < to && matches.size() < limit)
+    {
+        const std::uint64_t block_end = std::min(to, (from / ScrollbackBuffer::index_block + 1) * ScrollbackBuffer::index_block);
+        const std::uint64_t read_end = std::min(end, block_end + regex_overlap);
+        bytes.resize(static_cast<std::size_t>(read_end - from));
+        buffer.copy(from, bytes.size(), bytes.data());
+
+        const QString text = QString::fromLatin1(bytes.data(), static_cast<int>(bytes.size()));
+        std::uint64_t next = block_end;
+        QRegularExpressionMatchIterator it = _regex.globalMatch(text);
+        while(it.hasNext() && matches.size() < limit)
+        {
+            const QRegularExpressionMatch found = it.next();
+            const std::uint64_t offset = from + static_cast<std::uint64_t>(found.capturedStart());
+            if(offset >= block_end)
+            {
+                break;
+            }
+            matches.push_back(Match{offset, static_cast<std::uint64_t>(found.capturedLength())});
+            // a match reaching into the next block hides what it covers there
+            next = std::max(next, offset + static_cast<std::uint64_t>(found.capturedLength()));
+        }
+        from = next;
+    }
+}
+
+bool SessionSearch::matches_at(const ScrollbackBuffer& buffer, std::uint64_t offset) const
+{
+    for(std::size_t i = 1; i < _literal.size(); ++i)
+    {
+        const char c = buffer.at(offset + i);
+        if((_case_sensitive ? c : fold(c)) != _literal[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,69 @@
+#ifndef SESSIONSEARCH_HPP
+#define SESSIONSEARCH_HPP
+
+/*
+Search over the raw bytes of a scrollback buffer. Text and hex patterns are
+located with memchr on their first byte, verified in place, and whole 64 KB
+blocks whose index lacks the first byte are skipped. Regular expressions run
+block by block on Latin-1 text with a small overlap, so a regex match longer
+than the overlap can be missed where it crosses a block boundary.
+*/
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <QRegularExpression>
+#include <QString>
+
+#include "scrollbackbuffer.hpp"
+
+class SessionSearch
+{
+public:
+
+    enum class MODE
+    {
+        TEXT = 0,
+        HEX,
+        REGEX
+    };
+
+    struct Match
+    {
+        std::uint64_t offset;
+        std::uint64_t length;
+    };
+
+    SessionSearch();
+
+    // hex accepts pairs of digits, separated by spaces or not
+    bool set_pattern(MODE mode, const QString& pattern, bool case_sensitive, QString* error = nullptr);
+    bool valid() const;
+
+    // first match starting at or after from
+    bool find_next(const ScrollbackBuffer& buffer, std::uint64_t from, Match& match) const;
+    // last match starting before before
+    bool find_previous(const ScrollbackBuffer& buffer, std::uint64_t before, Match& match) const;
+    // counting stops at limit
+    std::size_t count(const ScrollbackBuffer& buffer, std::size_t limit) const;
+
+private:
+
+    // first match starting in [from, to), matches may extend past to
+    bool find_in(const ScrollbackBuffer& buffer, std::uint64_t from, std::uint64_t to, Match& match) const;
+    bool find_literal(const ScrollbackBuffer& buffer, std::uint64_t from, std::uint64_t to, Match& match) const;
+    bool find_regex(const ScrollbackBuffer& buffer, std::uint64_t from, std::uint64_t to, Match& match) const;
+    // non-overlapping matches starting in [from, to), up to limit
+    void collect(const ScrollbackBuffer& buffer, std::uint64_t from, std::uint64_t to,
+                 std::vector<Match>& matches, std::size_t limit) const;
+    bool matches_at(const ScrollbackBuffer& buffer, std::uint64_t offset) const;
+
+    MODE _mode;
+    bool _case_sensitive;
+    std::string _literal;
+    QRegularExpression _regex;
+    bool _valid;
+};
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef SPSCQUEUE_HPP
+#define SPSCQUEUE_HPP
+
+/*
+Bounded lock-free queue for exactly one producer thread and one consumer
+thread. Capacity is rounded up to a power of two.
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+template <typename T>
+class SpscQueue
+{
+public:
+
+    explicit SpscQueue(std::size_t capacity) :
+        _slots(round_up(capacity)), _mask(_slots.size() - 1), _head(0), _tail(0)
+    {
+
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // producer side, returns false when queue is full
+    bool push(T&& value)
+    {
+        const std::size_t tail = _tail.load(std::memory_order_relaxed);
+        if(tail - _head.load(std::memory_order_acquire) == _slots.size())
+        {
+            return false;
+        }
+        _slots[tail & _mask] = std::move(value);
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side, returns false when queue is empty
+    bool pop(T& value)
+    {
+        const std::size_t head = _head.load(std::memory_order_relaxed);
+        if(head == _tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        value = std::move(_slots[head & _mask]);
+        _slots[head & _mask] = T();
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // approximate when called from neither side
+    std::size_t size() const
+    {
+        return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+    }
+
+    bool full() const
+    {
+        return size() == _slots.size();
+    }
+
+    std::size_t capacity() const
+    {
+        return _slots.size();
+    }
+
+private:
+
+    static std::size_t round_up(std::size_t capacity)
+    {
+        std::size_t size = 1;
+        while(size < capacity)
+        {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    std::vector<T> _slots;
+    const std::size_t _mask;
+
+    // consumer and producer indexes on separate cache lines
+    alignas(64) std::atomic<std::size_t> _head;
+    alignas(64) std::atomic<std::size_t> _tail;
+};
+
+#endif
@@ -0,0 +1,182 @@
+#include "telemetrybuffer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    const unsigned level_shift = 6;
+
+    std::size_t round_up(std::size_t capacity)
+    {
+        std::size_t size = std::size_t(1) << (2 * level_shift);
+        while(size < capacity)
+        {
+            size <<= 1;
+        }
+        return size;
+    }
+}
+
+TelemetryBuffer::TelemetryBuffer(std::size_t capacity) :
+    _capacity(round_up(capacity)), _mask(_capacity - 1), _channels(0), _columns(), _end(0)
+{
+
+}
+
+void TelemetryBuffer::set_channels(int channels)
+{
+    _channels = channels < 0 ? 0 : channels > max_channels ? static_cast<int>(max_channels) : channels;
+    allocate();
+}
+
+int TelemetryBuffer::channels() const
+{
+    return _channels;
+}
+
+void TelemetryBuffer::set_capacity(std::size_t capacity)
+{
+    _capacity = round_up(capacity);
+    _mask = _capacity - 1;
+    allocate();
+}
+
+std::size_t TelemetryBuffer::capacity() const
+{
+    return _capacity;
+}
+
+void TelemetryBuffer::clear()
+{
+    allocate();
+}
+
+void TelemetryBuffer::append(const float* values, int count)
+{
+    const std::uint64_t sample = _end;
+    const std::size_t index = static_cast<std::size_t>(sample) & _mask;
+    for(int c = 0; c < _channels; ++c)
+    {
+        const float value = c < count ? values[c] : std::numeric_limits<float>::quiet_NaN();
+        Column& column = _columns[static_cast<std::size_t>(c)];
+        column.values[index] = value;
+        for(Level& level : column.levels)
+        {
+            const std::size_t block = index >> level.shift;
+            // first sample of a block overwrites what the ring held there before
+            if((sample & ((std::uint64_t(1) << level.shift) - 1)) == 0)
+            {
+                level.min[block] = value;
+                level.max[block] = value;
+            }
+            else
+            {
+                level.min[block] = std::fmin(level.min[block], value);
+                level.max[block] = std::fmax(level.max[block], value);
+            }
+        }
+    }
+    ++_end;
+}
+
+std::uint64_t TelemetryBuffer::begin() const
+{
+    return _end > _capacity ? _end - _capacity : 0;
+}
+
+std::uint64_t TelemetryBuffer::end() const
+{
+    return _end;
+}
+
+std::size_t TelemetryBuffer::size() const
+{
+    return static_cast<std::size_t>(_end - begin());
+}
+
+bool TelemetryBuffer::empty() const
+{
+    return _end == begin();
+}
+
+float TelemetryBuffer::at(int channel, std::uint64_t sample) const
+{
+    return _columns[static_cast<std::size_t>(channel)].values[static_cast<std::size_t>(sample) & _mask];
+}
+
+std::pair<float, float> TelemetryBuffer::range(int channel, std::uint64_t first, std::uint64_t last) const
+{
+    float low = std::numeric_limits<float>::quiet_NaN();
+    float high = low;
+    if(channel < 0 || channel >= _channels)
+    {
+        return {low, high};
+    }
+    const Column& column = _columns[static_cast<std::size_t>(channel)];
+    first = std::max(first, begin());
+    last = std::min(last, _end);
+
+    // largest aligned block that fits, raw samples where none does
+    while(first < last)
+    {
+        const Level* used = nullptr;
+        for(auto level = column.levels.rbegin(); level != column.levels.rend(); ++level)
+        {
+            const std::uint64_t block = std::uint64_t(1) << level->shift;
+            if((first & (block - 1)) == 0 && first + block <= last)
+            {
+                used = &*level;
+                break;
+            }
+        }
+        const std::size_t index = static_cast<std::size_t>(first) & _mask;
+        if(used)
+        {
+            low = std::fmin(low, used->min[index >> used->shift]);
+            high = std::fmax(high, used->max[index >> used->shift]);
+            first += std::uint64_t(1) << used->shift;
+        }
+        else
+        {
+            low = std::fmin(low, column.values[index]);
+            high = std::fmax(high, column.values[index]);
+            ++first;
+        }
+    }
+    return {low, high};
+}
+
+void TelemetryBuffer::decimate(int channel, std::uint64_t first, std::uint64_t last, int pixels,
+                               std::vector<std::pair<float, float> >& out) const
+{
+    out.clear();
+    if(pixels <= 0 || last <= first)
+    {
+        return;
+    }
+    out.reserve(static_cast<std::size_t>(pixels));
+    const std::uint64_t span = last - first;
+    for(int p = 0; p < pixels; ++p)
+    {
+        const std::uint64_t from = first + span * static_cast<std::uint64_t>(p) / static_cast<std::uint64_t>(pixels);
+        const std::uint64_t to = first + span * static_cast<std::uint64_t>(p + 1) / static_cast<std::uint64_t>(pixels);
+        out.push_back(range(channel, from, to));
+    }
+}
+
+void TelemetryBuffer::allocate()
+{
+    _end = 0;
+    _columns.assign(static_cast<std::size_t>(_channels), Column());
+    for(Column& column : _columns)
+    {
+        column.values.assign(_capacity, std::numeric_limits<float>::quiet_NaN());
+        // a level needs at least 64 blocks to be worth it
+        for(unsigned shift = level_shift; (_capacity >> shift) >= (std::size_t(1) << level_shift); shift += level_shift)
+        {
+            column.levels.push_back(Level{shift, std::vector<float>(_capacity >> shift), std::vector<float>(_capacity >> shift)});
+        }
+    }
+}
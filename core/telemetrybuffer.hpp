@@ -0,0 +1,80 @@
+#ifndef TELEMETRYBUFFER_HPP
+#define TELEMETRYBUFFER_HPP
+
+/*
+Numeric samples pulled out of the received stream, one column of floats per
+channel in a ring of fixed power of two capacity. Samples are numbered from
+the first one appended, a row that lacks a channel stores NaN there.
+
+Every column keeps a min/max pyramid next to it: level 1 summarises blocks
+of 64 samples, each further level blocks of 64 of the level below. Blocks
+are updated as samples arrive, so a min/max over any range is assembled
+from a handful of whole blocks plus raw samples at the unaligned ends, and
+drawing a window of millions of samples costs about the same as drawing a
+few thousand.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class TelemetryBuffer
+{
+public:
+
+    static const int max_channels = 8;
+
+    // capacity in samples per channel, rounded up to a power of two of at least 64 * 64
+    explicit TelemetryBuffer(std::size_t capacity = 4 * 1024 * 1024);
+
+    // drops everything, channel count is fixed until the next call
+    void set_channels(int channels);
+    int channels() const;
+    void set_capacity(std::size_t capacity);
+    std::size_t capacity() const;
+    void clear();
+
+    // one value per channel, missing ones are NaN
+    void append(const float* values, int count);
+
+    // sample numbers of the oldest retained sample and one past the newest
+    std::uint64_t begin() const;
+    std::uint64_t end() const;
+    std::size_t size() const;
+    bool empty() const;
+
+    float at(int channel, std::uint64_t sample) const;
+
+    // min and max of channel over [first, last), NaN when it holds no number
+    std::pair<float, float> range(int channel, std::uint64_t first, std::uint64_t last) const;
+
+    // [first, last) split into pixels equal parts, min and max of each
+    void decimate(int channel, std::uint64_t first, std::uint64_t last, int pixels,
+                  std::vector<std::pair<float, float> >& out) const;
+
+private:
+
+    struct Level
+    {
+        unsigned shift;             // log2 of samples per block
+        std::vector<float> min;
+        std::vector<float> max;
+    };
+
+    struct Column
+    {
+        std::vector<float> values;
+        std::vector<Level> levels;
+    };
+
+    void allocate();
+
+    std::size_t _capacity;
+    std::size_t _mask;
+    int _channels;
+    std::vector<Column> _columns;
+    std::uint64_t _end;
+};
+
+#endif
@@ -0,0 +1,309 @@
+#include "textdecoder.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    const char16_t replacement = 0xFFFD;
+
+    // bytes the sequence at data takes and its code point in point, 0 when
+    // data ends in a valid but incomplete sequence
+    std::size_t decode_one(const unsigned char* data, std::size_t size, char32_t& point)
+    {
+        const unsigned char lead = data[0];
+        if(lead < 0x80)
+        {
+            point = lead;
+            return 1;
+        }
+
+        // range of the second byte rules out overlong forms, surrogates and
+        // anything past U+10FFFF
+        std::size_t length;
+        unsigned char low = 0x80;
+        unsigned char high = 0xBF;
+        if(lead >= 0xC2 && lead <= 0xDF)
+        {
+            length = 2;
+            point = lead & 0x1F;
+        }
+        else if(lead >= 0xE0 && lead <= 0xEF)
+        {
+            length = 3;
+            point = lead & 0x0F;
+            if(lead == 0xE0)
+            {
+                low = 0xA0;
+            }
+            else if(lead == 0xED)
+            {
+                high = 0x9F;
+            }
+        }
+        else if(lead >= 0xF0 && lead <= 0xF4)
+        {
+            length = 4;
+            point = lead & 0x07;
+            if(lead == 0xF0)
+            {
+                low = 0x90;
+            }
+            else if(lead == 0xF4)
+            {
+                high = 0x8F;
+            }
+        }
+        else
+        {
+            point = replacement;
+            return 1;
+        }
+
+        for(std::size_t i = 1; i < length; ++i)
+        {
+            if(i == size)
+            {
+                return 0;
+            }
+            if(data[i] < low || data[i] > high)
+            {
+                point = replacement;
+                return i;
+            }
+            point = (point << 6) | (data[i] & 0x3F);
+            low = 0x80;
+            high = 0xBF;
+        }
+        return length;
+    }
+
+    char16_t* put(char16_t* out, char32_t point)
+    {
+        if(point < 0x10000)
+        {
+            *out++ = static_cast<char16_t>(point);
+        }
+        else
+        {
+            point -= 0x10000;
+            *out++ = static_cast<char16_t>(0xD800 + (point >> 10));
+            *out++ = static_cast<char16_t>(0xDC00 + (point & 0x3FF));
+        }
+        return out;
+    }
+
+#ifdef __SSE2__
+    // widens 16 bytes to 16 UTF-16 units
+    void widen(const unsigned char* data, char16_t* out)
+    {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        const __m128i zero = _mm_setzero_si128();
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(bytes, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpackhi_epi8(bytes, zero));
+    }
+
+    // one bit per byte above 127 of the 16 at data
+    int high_bytes(const unsigned char* data)
+    {
+        return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+    }
+#endif
+
+    // copies the ASCII run at the start of data, returns its length
+    std::size_t copy_ascii(const unsigned char* data, std::size_t size, char16_t* out)
+    {
+        std::size_t i = 0;
+#ifdef __SSE2__
+        for(; i + 16 <= size; i += 16)
+        {
+            const int mask = high_bytes(data + i);
+            if(mask != 0)
+            {
+                const std::size_t run = i + static_cast<std::size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+                for(; i < run; ++i)
+                {
+                    out[i] = data[i];
+                }
+                return i;
+            }
+            widen(data + i, out + i);
+        }
+#endif
+        for(; i < size && data[i] < 0x80; ++i)
+        {
+            out[i] = data[i];
+        }
+        return i;
+    }
+}
+
+TextDecoder::TextDecoder(ENCODING encoding) :
+    _encoding(encoding), _pending(), _pending_size(0)
+{
+}
+
+void TextDecoder::set_encoding(ENCODING encoding)
+{
+    _encoding = encoding;
+    reset();
+}
+
+TextDecoder::ENCODING TextDecoder::encoding() const
+{
+    return _encoding;
+}
+
+std::size_t TextDecoder::output_capacity(std::size_t size)
+{
+    // a byte ending a pending sequence it does not fit adds U+FFFD for the
+    // sequence, flush adds one for what is still pending
+    return size + 2;
+}
+
+std::size_t TextDecoder::decode(const char* data, std::size_t size, char16_t* out)
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    switch(_encoding)
+    {
+        case ENCODING::ASCII:
+        {
+            std::size_t i = 0;
+            while(i < size)
+            {
+                i += copy_ascii(bytes + i, size - i, out + i);
+                for(; i < size && bytes[i] >= 0x80; ++i)
+                {
+                    out[i] = replacement;
+                }
+            }
+            return size;
+        }
+        case ENCODING::LATIN1:
+        {
+            std::size_t i = 0;
+#ifdef __SSE2__
+            for(; i + 16 <= size; i += 16)
+            {
+                widen(bytes + i, out + i);
+            }
+#endif
+            for(; i < size; ++i)
+            {
+                out[i] = bytes[i];
+            }
+            return size;
+        }
+        case ENCODING::UTF8:
+            return decode_utf8(bytes, size, out);
+    }
+    return 0;
+}
+
+void TextDecoder::decode(const char* data, std::size_t size, QString& text)
+{
+    const int length = text.size();
+    text.resize(length + static_cast<int>(output_capacity(size)));
+    const std::size_t written = decode(data, size, reinterpret_cast<char16_t*>(text.data()) + length);
+    text.resize(length + static_cast<int>(written));
+}
+
+std::size_t TextDecoder::flush(char16_t* out)
+{
+    if(_pending_size == 0)
+    {
+        return 0;
+    }
+    _pending_size = 0;
+    *out = replacement;
+    return 1;
+}
+
+void TextDecoder::flush(QString& text)
+{
+    if(_pending_size != 0)
+    {
+        _pending_size = 0;
+        text.append(QChar(replacement));
+    }
+}
+
+void TextDecoder::reset()
+{
+    _pending_size = 0;
+}
+
+std::size_t TextDecoder::complete(const char* data, std::size_t size, ENCODING encoding)
+{
+    if(encoding != ENCODING::UTF8)
+    {
+        return size;
+    }
+
+    // only a lead byte in the last three can start an incomplete sequence
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    const std::size_t last = size < 3 ? 0 : size - 3;
+    for(std::size_t i = size; i > last; --i)
+    {
+        const std::size_t start = i - 1;
+        if((bytes[start] & 0xC0) != 0x80)
+        {
+            char32_t point;
+            return decode_one(bytes + start, size - start, point) == 0 ? start : size;
+        }
+    }
+    return size;
+}
+
+std::size_t TextDecoder::decode_utf8(const unsigned char* data, std::size_t size, char16_t* out)
+{
+    char16_t* const begin = out;
+    std::size_t i = 0;
+
+    if(_pending_size != 0)
+    {
+        // finish the sequence the last data ended in
+        unsigned char sequence[4];
+        std::memcpy(sequence, _pending, _pending_size);
+        const std::size_t taken = std::min(size, sizeof(sequence) - _pending_size);
+        std::memcpy(sequence + _pending_size, data, taken);
+
+        char32_t point;
+        const std::size_t used = decode_one(sequence, _pending_size + taken, point);
+        if(used == 0)
+        {
+            std::memcpy(_pending, sequence, _pending_size + taken);
+            _pending_size += taken;
+            return 0;
+        }
+        // pending bytes are a valid prefix so at least all of them are used
+        out = put(out, point);
+        i = used - _pending_size;
+        _pending_size = 0;
+    }
+
+    while(i < size)
+    {
+        const std::size_t run = copy_ascii(data + i, size - i, out);
+        i += run;
+        out += run;
+        while(i < size && data[i] >= 0x80)
+        {
+            char32_t point;
+            const std::size_t used = decode_one(data + i, size - i, point);
+            if(used == 0)
+            {
+                _pending_size = size - i;
+                std::memcpy(_pending, data + i, _pending_size);
+                return static_cast<std::size_t>(out - begin);
+            }
+            out = put(out, point);
+            i += used;
+        }
+    }
+    return static_cast<std::size_t>(out - begin);
+}
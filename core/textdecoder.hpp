@@ -0,0 +1,63 @@
+#ifndef TEXTDECODER_HPP
+#define TEXTDECODER_HPP
+
+/*
+Streaming decoder from received bytes to UTF-16. A UTF-8 sequence cut off
+at the end of the data is kept and finished by the next call, so the way
+reads split the stream never shows up as replacement characters. Invalid
+input becomes U+FFFD, one per maximal invalid subpart like QString does.
+ASCII maps bytes above 127 to U+FFFD, Latin-1 maps every byte to itself.
+
+Runs of ASCII are widened 16 bytes at a time with SSE2 where the compiler
+targets it, only bytes above 127 take the scalar path.
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+#include <QString>
+
+class TextDecoder
+{
+public:
+
+    enum class ENCODING : std::uint8_t
+    {
+        ASCII = 0,
+        LATIN1,
+        UTF8
+    };
+
+    explicit TextDecoder(ENCODING encoding = ENCODING::UTF8);
+
+    // drops an incomplete sequence
+    void set_encoding(ENCODING encoding);
+    ENCODING encoding() const;
+
+    // UTF-16 units decode() and flush() together may write for size bytes
+    static std::size_t output_capacity(std::size_t size);
+
+    // returns units written to out, an incomplete sequence at the end waits for the next call
+    std::size_t decode(const char* data, std::size_t size, char16_t* out);
+    // appends to text
+    void decode(const char* data, std::size_t size, QString& text);
+
+    // an incomplete sequence left over becomes U+FFFD
+    std::size_t flush(char16_t* out);
+    void flush(QString& text);
+    void reset();
+
+    // leading bytes of data that end on a character boundary
+    static std::size_t complete(const char* data, std::size_t size, ENCODING encoding);
+
+private:
+
+    std::size_t decode_utf8(const unsigned char* data, std::size_t size, char16_t* out);
+
+    ENCODING _encoding;
+    // valid start of a UTF-8 sequence the data ended in
+    unsigned char _pending[4];
+    std::size_t _pending_size;
+};
+
+#endif
@@ -0,0 +1,302 @@
+#include "triggerengine.hpp"
+
+#include <algorithm>
+#include <deque>
+
+#include <QRegularExpression>
+
+#include "messageformat.hpp"
+
+namespace
+{
+    const std::uint32_t state_mask = 0x7fffffffu;
+
+    bool set_error(QString* error, const QString& text)
+    {
+        if(error)
+        {
+            *error = text;
+        }
+        return false;
+    }
+}
+
+bool TriggerEngine::Rule::from_string(const QString& line, Rule& rule, QString* error)
+{
+    const int separator = line.indexOf(" | ");
+    if(separator < 0)
+    {
+        return set_error(error, QString("\"%1\": expected pattern | actions").arg(line));
+    }
+
+    const QString pattern = line.left(separator).trimmed();
+    static const QRegularExpression hex("^(0[xX][0-9A-Fa-f]{2}\\s*)+$");
+    rule = Rule();
+    if(hex.match(pattern).hasMatch())
+    {
+        for(const QString& token : pattern.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts))
+        {
+            rule.pattern.append(static_cast<char>(token.mid(2).toUInt(nullptr, 16)));
+        }
+    }
+    else
+    {
+        rule.pattern = MessageFormat::unescape(pattern).toUtf8();
+    }
+    if(rule.pattern.isEmpty())
+    {
+        return set_error(error, QString("\"%1\": empty pattern").arg(line));
+    }
+
+    const QStringList actions = line.mid(separator + 3).split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+    for(int i = 0; i < actions.size(); ++i)
+    {
+        const QString action = actions[i].toLower();
+        if(action == "highlight")
+        {
+            rule.actions |= HIGHLIGHT;
+        }
+        else if(action == "count")
+        {
+            rule.actions |= COUNT;
+        }
+        else if(action == "pause")
+        {
+            rule.actions |= PAUSE_CAPTURE;
+        }
+        else if(action == "send")
+        {
+            bool ok = false;
+            rule.delay = actions.value(i + 1).toInt(&ok);
+            rule.command = actions.mid(i + 2).join(' ');
+            if(!ok || rule.delay < 0 || rule.command.isEmpty())
+            {
+                return set_error(error, QString("\"%1\": expected send <ms> <command>").arg(line));
+            }
+            rule.actions |= SEND;
+            // the command is the rest of the line
+            break;
+        }
+        else
+        {
+            return set_error(error, QString("\"%1\": unknown action %2").arg(line, actions[i]));
+        }
+    }
+    if(rule.actions == 0)
+    {
+        return set_error(error, QString("\"%1\": no action").arg(line));
+    }
+    return true;
+}
+
+QString TriggerEngine::Rule::name() const
+{
+    const bool text = std::all_of(pattern.cbegin(), pattern.cend(), [](char c)
+    {
+        return (c >= 32 && c < 127) || c == '\r' || c == '\n' || c == '\t';
+    });
+    if(text)
+    {
+        return MessageFormat::escape(QString::fromLatin1(pattern));
+    }
+    QStringList bytes;
+    for(const char c : pattern)
+    {
+        bytes << QString("0x%1").arg(static_cast<unsigned char>(c), 2, 16, QChar('0')).toUpper().replace("0X", "0x");
+    }
+    return bytes.join(' ');
+}
+
+TriggerEngine::TriggerEngine() :
+    _rules(), _class(), _classes(1), _next(), _output_begin(), _outputs(), _row(0), _position(0), _counts()
+{
+    build();
+}
+
+bool TriggerEngine::parse(const QStringList& lines, std::vector<Rule>& rules, QString* error)
+{
+    rules.clear();
+    for(const QString& line : lines)
+    {
+        const QString trimmed = line.trimmed();
+        if(trimmed.isEmpty() || trimmed.startsWith('#'))
+        {
+            continue;
+        }
+        Rule rule;
+        if(!Rule::from_string(trimmed, rule, error))
+        {
+            return false;
+        }
+        rules.push_back(rule);
+    }
+    return true;
+}
+
+void TriggerEngine::set_rules(const std::vector<Rule>& rules)
+{
+    _rules = rules;
+    build();
+    reset();
+}
+
+const std::vector<TriggerEngine::Rule>& TriggerEngine::rules() const
+{
+    return _rules;
+}
+
+bool TriggerEngine::empty() const
+{
+    return _rules.empty();
+}
+
+void TriggerEngine::scan(const char* data, std::size_t size, std::vector<Match>& matches)
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    std::uint32_t row = _row;
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        const std::uint32_t next = _next[row + _class[bytes[i]]];
+        row = next & state_mask;
+        if(next & output_flag)
+        {
+            const std::uint32_t state = row / _classes;
+            for(std::uint32_t o = _output_begin[state]; o < _output_begin[state + 1]; ++o)
+            {
+                ++_counts[static_cast<std::size_t>(_outputs[o])];
+                matches.push_back(Match{_outputs[o], _position + i + 1});
+            }
+        }
+    }
+    _row = row;
+    _position += size;
+}
+
+void TriggerEngine::reset()
+{
+    _row = 0;
+    _position = 0;
+    _counts.assign(_rules.size(), 0);
+}
+
+const std::vector<std::uint64_t>& TriggerEngine::counts() const
+{
+    return _counts;
+}
+
+void TriggerEngine::find(const char* data, std::size_t size, std::uint8_t actions, std::vector<Match>& matches) const
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    std::uint32_t row = 0;
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        const std::uint32_t next = _next[row + _class[bytes[i]]];
+        row = next & state_mask;
+        if(next & output_flag)
+        {
+            const std::uint32_t state = row / _classes;
+            for(std::uint32_t o = _output_begin[state]; o < _output_begin[state + 1]; ++o)
+            {
+                const int rule = _outputs[o];
+                if((_rules[static_cast<std::size_t>(rule)].actions & actions) == actions)
+                {
+                    matches.push_back(Match{rule, i + 1});
+                }
+            }
+        }
+    }
+}
+
+void TriggerEngine::build()
+{
+    // bytes used by some pattern get a column each, all others share column 0
+    _class.fill(0);
+    _classes = 1;
+    for(const Rule& rule : _rules)
+    {
+        for(const char c : rule.pattern)
+        {
+            std::uint8_t& column = _class[static_cast<unsigned char>(c)];
+            if(column == 0 && _classes < 256)
+            {
+                column = static_cast<std::uint8_t>(_classes++);
+            }
+        }
+    }
+
+    // trie first, missing transitions marked with the mask value
+    std::vector<std::vector<int> > outputs(1);
+    _next.assign(_classes, state_mask);
+    for(std::size_t r = 0; r < _rules.size(); ++r)
+    {
+        std::uint32_t state = 0;
+        for(const char c : _rules[r].pattern)
+        {
+            std::uint32_t& next = _next[state * _classes + _class[static_cast<unsigned char>(c)]];
+            if(next == state_mask)
+            {
+                next = static_cast<std::uint32_t>(outputs.size());
+                outputs.emplace_back();
+                _next.resize(_next.size() + _classes, state_mask);
+            }
+            // resize may have moved the table
+            state = _next[state * _classes + _class[static_cast<unsigned char>(c)]];
+        }
+        outputs[state].push_back(static_cast<int>(r));
+    }
+    const std::uint32_t states = static_cast<std::uint32_t>(outputs.size());
+
+    // breadth first, a state's failure target is always complete before the state
+    std::vector<std::uint32_t> fail(states, 0);
+    std::deque<std::uint32_t> queue;
+    for(std::uint32_t c = 0; c < _classes; ++c)
+    {
+        std::uint32_t& next = _next[c];
+        if(next == state_mask)
+        {
+            next = 0;
+        }
+        else
+        {
+            queue.push_back(next);
+        }
+    }
+    while(!queue.empty())
+    {
+        const std::uint32_t state = queue.front();
+        queue.pop_front();
+        const std::vector<int>& inherited = outputs[fail[state]];
+        outputs[state].insert(outputs[state].end(), inherited.begin(), inherited.end());
+
+        for(std::uint32_t c = 0; c < _classes; ++c)
+        {
+            std::uint32_t& next = _next[state * _classes + c];
+            const std::uint32_t fallback = _next[fail[state] * _classes + c];
+            if(next == state_mask)
+            {
+                next = fallback;
+            }
+            else
+            {
+                fail[next] = fallback;
+                queue.push_back(next);
+            }
+        }
+    }
+
+    _output_begin.assign(states + 1, 0);
+    _outputs.clear();
+    for(std::uint32_t state = 0; state < states; ++state)
+    {
+        _output_begin[state] = static_cast<std::uint32_t>(_outputs.size());
+        _outputs.insert(_outputs.end(), outputs[state].begin(), outputs[state].end());
+    }
+    _output_begin[states] = static_cast<std::uint32_t>(_outputs.size());
+
+    // entries become row offsets, flagged when the target reports matches
+    for(std::uint32_t& next : _next)
+    {
+        const bool output = !outputs[next].empty();
+        next = next * _classes | (output ? output_flag : 0);
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef TRIGGERENGINE_HPP
+#define TRIGGERENGINE_HPP
+
+/*
+Multi-pattern matcher for the received byte stream. All rule patterns are
+compiled into one Aho-Corasick automaton with the failure links folded into
+a complete transition table, so every byte costs one table lookup no matter
+how many patterns there are. Bytes no pattern uses share a single column of
+the table, which keeps it small.
+
+scan() keeps its state between calls, a pattern split over two reads still
+matches and no byte is looked at twice. find() runs the same table over a
+piece of data on its own, the console view uses it to highlight visible
+lines.
+
+Rules are written one per line as "pattern | actions". A pattern made only
+of 0xNN tokens is raw bytes, anything else is text with \r, \n and \t
+escapes. Actions are any of highlight, count, pause and send <ms> <command>.
+*/
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+class TriggerEngine
+{
+public:
+
+    enum ACTION : std::uint8_t
+    {
+        HIGHLIGHT = 1,
+        COUNT = 2,
+        PAUSE_CAPTURE = 4,
+        SEND = 8
+    };
+
+    struct Rule
+    {
+        QByteArray pattern;
+        std::uint8_t actions = 0;
+        int delay = 0;          // milliseconds before command is sent
+        QString command;
+
+        static bool from_string(const QString& line, Rule& rule, QString* error = nullptr);
+        // pattern the way it is written in a rule
+        QString name() const;
+    };
+
+    struct Match
+    {
+        int rule;
+        std::uint64_t end;      // one past the last byte of the match
+    };
+
+    TriggerEngine();
+
+    // empty lines and lines starting with # are skipped, error names the first bad line
+    static bool parse(const QStringList& lines, std::vector<Rule>& rules, QString* error = nullptr);
+
+    void set_rules(const std::vector<Rule>& rules);
+    const std::vector<Rule>& rules() const;
+    bool empty() const;
+
+    // streaming, match ends count bytes since the last reset()
+    void scan(const char* data, std::size_t size, std::vector<Match>& matches);
+    void reset();
+    // matches of every rule so far
+    const std::vector<std::uint64_t>& counts() const;
+
+    // data on its own, match ends are offsets into it, only rules having all of actions
+    void find(const char* data, std::size_t size, std::uint8_t actions, std::vector<Match>& matches) const;
+
+private:
+
+    // transitions to a state with matches carry this bit
+    static const std::uint32_t output_flag = 0x80000000u;
+
+    void build();
+
+    std::vector<Rule> _rules;
+
+    std::array<std::uint8_t, 256> _class;
+    std::uint32_t _classes;
+    // rows of _classes entries, an entry is the offset of the next row
+    std::vector<std::uint32_t> _next;
+    // rules matching in a state, state is row offset / _classes
+    std::vector<std::uint32_t> _output_begin;
+    std::vector<int> _outputs;
+
+    std::uint32_t _row;
+    std::uint64_t _position;
+    std::vector<std::uint64_t> _counts;
+};
+
+#endif
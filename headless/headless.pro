@@ -0,0 +1,29 @@
+#-------------------------------------------------
+#
+# Serial Port Commander without GUI, for headless rigs and scripts
+#
+#-------------------------------------------------
+
+QT       += core serialport
+QT       -= gui
+
+TARGET = spcommander
+TEMPLATE = app
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+        main.cpp \
+    headlessconsole.cpp
+
+HEADERS += \
+    headlessconsole.hpp
+
+include(../core/core.pri)
+
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,237 @@
+#include "headlessconsole.hpp"
+
+#include <QCoreApplication>
+
+#include <cstdio>
+
+HeadlessConsole::HeadlessConsole(QObject *parent) :
+    QObject(parent), _port(), _output(), _error(),
+    _hex_mode(false), _hex(), _hex_buffer(),
+    _framer(), _format(), _commands(), _frames(), _command_idx(0), _command_timer(),
+    _scheduled(false), _schedule(), _scheduler(),
+    _duration(0)
+{
+    _command_timer.setTimerType(Qt::PreciseTimer);
+    connect(&_command_timer, &QTimer::timeout, this, &HeadlessConsole::send_next);
+}
+
+HeadlessConsole::~HeadlessConsole()
+{
+    _scheduler.reset();
+    _port.reset();
+    _output.flush();
+}
+
+bool HeadlessConsole::set_output(const QString& path)
+{
+    bool opened = false;
+    if(path == "-")
+    {
+        opened = _output.open(stdout, QIODevice::WriteOnly);
+    }
+    else
+    {
+        _output.setFileName(path);
+        opened = _output.open(QIODevice::WriteOnly | QIODevice::Append);
+    }
+    if(!opened)
+    {
+        _error = _output.errorString();
+    }
+    return opened;
+}
+
+void HeadlessConsole::set_hex_mode(bool hex)
+{
+    _hex_mode = hex;
+}
+
+void HeadlessConsole::set_protect_alphanumeric(bool protect)
+{
+    _hex.set_protect_alphanumeric(protect);
+}
+
+void HeadlessConsole::set_protect_extended(bool protect)
+{
+    _hex.set_protect_extended(protect);
+}
+
+void HeadlessConsole::set_format(const MessageFormat& format)
+{
+    _format = format;
+}
+
+void HeadlessConsole::set_framing(const Framer::Settings& settings)
+{
+    _framer.set_settings(settings);
+}
+
+Framer::Stats HeadlessConsole::framing_stats() const
+{
+    return _framer.stats();
+}
+
+void HeadlessConsole::set_commands(const QStringList& commands, int interval)
+{
+    _commands = commands;
+    _command_idx = 0;
+    _command_timer.setInterval(interval);
+}
+
+void HeadlessConsole::set_schedule(std::int64_t period, int burst, std::uint64_t repetitions)
+{
+    _scheduled = true;
+    _schedule.period = period;
+    _schedule.burst = burst;
+    _schedule.repetitions = repetitions;
+}
+
+CommandScheduler::Stats HeadlessConsole::schedule_stats() const
+{
+    return _scheduler ? _scheduler->stats() : CommandScheduler::Stats{};
+}
+
+void HeadlessConsole::set_duration(int milliseconds)
+{
+    _duration = milliseconds;
+}
+
+bool HeadlessConsole::open(const QString& port, int baud_rate, QSerialPort::FlowControl flow)
+{
+    _port.reset(new PortWorker(port));
+    if(!_port->open())
+    {
+        _error = QString("Could not open %1").arg(port);
+        _port.reset();
+        return false;
+    }
+    _port->set_baud_rate(baud_rate);
+    if(!_port->set_flow_control(flow))
+    {
+        _error = QString("Could not set flow control on %1").arg(port);
+        _port.reset();
+        return false;
+    }
+    connect(_port.get(), &PortWorker::received, this, &HeadlessConsole::drain);
+    connect(_port.get(), &PortWorker::closed, this, &HeadlessConsole::port_closed);
+    return true;
+}
+
+bool HeadlessConsole::start_capture(const QString& base, qint64 file_limit)
+{
+    return _port && _port->start_capture(base, file_limit, &_error);
+}
+
+void HeadlessConsole::start()
+{
+    if(_duration > 0)
+    {
+        QTimer::singleShot(_duration, this, &HeadlessConsole::stop);
+    }
+    // framed once, sending is a plain write
+    _frames.clear();
+    for(const QString& command : _commands)
+    {
+        _frames.push_back(_format.frame(command));
+    }
+
+    if(_scheduled && _port)
+    {
+        _schedule.frames = _frames;
+        _scheduler.reset(new CommandScheduler(_port.get()));
+        _scheduler->start(_schedule);
+    }
+    else if(!_commands.isEmpty())
+    {
+        send_next();
+        if(!_commands.isEmpty())
+        {
+            _command_timer.start();
+        }
+    }
+    // data may have arrived between open() and now
+    drain();
+}
+
+QString HeadlessConsole::error_string() const
+{
+    return _error;
+}
+
+void HeadlessConsole::drain()
+{
+    if(!_port)
+    {
+        return;
+    }
+
+    PortWorker::Chunk chunk;
+    Framer::Frame frame;
+    while(_port->pop(chunk))
+    {
+        if(!_framer.enabled())
+        {
+            // one line per read in hex
+            write(chunk.data.constData(), static_cast<std::size_t>(chunk.data.size()), _hex_mode);
+            continue;
+        }
+        _framer.push(chunk.data.constData(), static_cast<std::size_t>(chunk.data.size()));
+        while(_framer.next(frame))
+        {
+            write(frame.data, frame.size, true);
+        }
+    }
+    // one write per batch, but keep pipes live
+    _output.flush();
+}
+
+void HeadlessConsole::write(const char* data, std::size_t size, bool line)
+{
+    if(_hex_mode)
+    {
+        _hex_buffer.resize(HexFormatter::output_capacity(size) + 1);
+        std::size_t length = _hex.format(data, size, _hex_buffer.data());
+        _hex_buffer[length++] = '\n';
+        _output.write(_hex_buffer.data(), static_cast<qint64>(length));
+        return;
+    }
+    _output.write(data, static_cast<qint64>(size));
+    if(line)
+    {
+        _output.write("\n", 1);
+    }
+}
+
+void HeadlessConsole::send_next()
+{
+    if(!_port || _command_idx >= static_cast<int>(_frames.size()))
+    {
+        _command_timer.stop();
+        return;
+    }
+    // TX queue full, try the same command on the next tick
+    if(_port->write(_frames[static_cast<std::size_t>(_command_idx)]))
+    {
+        ++_command_idx;
+    }
+}
+
+void HeadlessConsole::port_closed()
+{
+    if(_port)
+    {
+        _error = QString("%1 closed").arg(_port->port_name());
+        stop();
+    }
+}
+
+void HeadlessConsole::stop()
+{
+    if(_scheduler)
+    {
+        _scheduler->stop();
+    }
+    drain();
+    _output.flush();
+    QCoreApplication::exit(_error.isEmpty() ? 0 : 1);
+}
@@ -0,0 +1,95 @@
+#ifndef HEADLESSCONSOLE_HPP
+#define HEADLESSCONSOLE_HPP
+
+/*
+Console without widgets. Received data goes straight from the port queue to
+a file or stdout, raw or as hex, optionally split into one frame per line.
+Commands are framed the same way the GUI frames them. Quits the application
+when the port goes away or the run time is over.
+*/
+
+#include <memory>
+#include <vector>
+
+#include <QObject>
+#include <QFile>
+#include <QStringList>
+#include <QTimer>
+
+#include "portworker.hpp"
+#include "hexformatter.hpp"
+#include "messageformat.hpp"
+#include "framer.hpp"
+#include "commandscheduler.hpp"
+
+class HeadlessConsole : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    explicit HeadlessConsole(QObject *parent = nullptr);
+    ~HeadlessConsole() override;
+
+    // "-" writes to stdout
+    bool set_output(const QString& path);
+
+    void set_hex_mode(bool hex);
+    void set_protect_alphanumeric(bool protect);
+    void set_protect_extended(bool protect);
+
+    void set_framing(const Framer::Settings& settings);
+    Framer::Stats framing_stats() const;
+
+    void set_format(const MessageFormat& format);
+
+    // commands are sent one after another, interval apart
+    void set_commands(const QStringList& commands, int interval);
+
+    // sends the commands from the scheduler thread instead, period in nanoseconds
+    void set_schedule(std::int64_t period, int burst, std::uint64_t repetitions);
+    CommandScheduler::Stats schedule_stats() const;
+
+    // 0 runs until the port closes or the process is interrupted
+    void set_duration(int milliseconds);
+
+    bool open(const QString& port, int baud_rate, QSerialPort::FlowControl flow);
+    bool start_capture(const QString& base, qint64 file_limit);
+
+    void start();
+    // drains what is left and quits the event loop
+    void stop();
+
+    QString error_string() const;
+
+private:
+
+    void drain();
+    // hex output always ends the line
+    void write(const char* data, std::size_t size, bool line);
+    void send_next();
+    void port_closed();
+
+    std::unique_ptr<PortWorker> _port;
+    QFile _output;
+    QString _error;
+
+    bool _hex_mode;
+    HexFormatter _hex;
+    std::vector<char> _hex_buffer;
+    Framer _framer;
+
+    MessageFormat _format;
+    QStringList _commands;
+    std::vector<QByteArray> _frames;
+    int _command_idx;
+    QTimer _command_timer;
+
+    bool _scheduled;
+    CommandScheduler::Settings _schedule;
+    std::unique_ptr<CommandScheduler> _scheduler;
+
+    int _duration;
+};
+
+#endif
@@ -0,0 +1,262 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QFileInfo>
+#include <QSerialPortInfo>
+#include <QSettings>
+#include <QTextStream>
+#include <QTimer>
+
+#include <csignal>
+#include <memory>
+
+#include "headlessconsole.hpp"
+#include "messageformat.hpp"
+#include "checksum.hpp"
+#include "commandjournal.hpp"
+
+#ifdef Q_OS_UNIX
+#include "capturereader.hpp"
+#include "replayengine.hpp"
+#endif
+
+namespace
+{
+
+volatile std::sig_atomic_t interrupted = 0;
+
+void interrupt(int)
+{
+    interrupted = 1;
+}
+
+QStringList load_commands(const QString& path, QString* error)
+{
+    if(!QFile::exists(path))
+    {
+        *error = QString("%1: no such file").arg(path);
+        return QStringList();
+    }
+    // same file and journal the GUI keeps its library in
+    QStringList commands = CommandJournal::load(path, error);
+    commands.removeAll(QString());
+    return commands;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCoreApplication::setOrganizationName("Vernocte laboratories");
+    QCoreApplication::setOrganizationDomain("vernocte.org");
+    QCoreApplication::setApplicationName("Serial Port Commander");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Serial Port Commander without GUI. Streams received data to stdout or a file.");
+    parser.addHelpOption();
+
+    const QCommandLineOption list_option("list", "List available ports and exit.");
+    const QCommandLineOption port_option({"p", "port"}, "Port name or device path.", "port");
+    const QCommandLineOption baud_option({"b", "baud"}, "Baud rate, 115200 by default.", "baud", "115200");
+    const QCommandLineOption flow_option("flow", "Flow control: none, hardware or software.", "flow", "none");
+    const QCommandLineOption send_option({"s", "send"}, "Send a command, may be repeated.", "command");
+    const QCommandLineOption commands_option({"c", "commands"}, "Send every line of a command file, \"saved\" uses the GUI command file.", "file");
+    const QCommandLineOption interval_option("interval", "Milliseconds between commands, 100 by default.", "ms", "100");
+    const QCommandLineOption period_option("period", "Send commands from a timing thread every this many microseconds, "
+                                           "cycling through them, instead of once each --interval apart.", "us");
+    const QCommandLineOption burst_option("burst", "Commands sent back to back every --period, 1 by default.", "count", "1");
+    const QCommandLineOption repeat_option("repeat", "Passes through the commands with --period, 0 repeats until stopped.", "count", "0");
+    const QCommandLineOption ending_option("line-ending", "Line ending appended to commands: none, n or rn.", "ending", "rn");
+    const QCommandLineOption crc_option("crc", "Append NMEA *xx checksum to commands, same as --checksum \"NMEA XOR\".");
+    const QCommandLineOption checksum_option("checksum", QString("Append checksum to commands: %1.").arg(Checksum::names().join(", ")), "type", "None");
+    const QCommandLineOption dollar_option("dollar", "Prefix commands with $.");
+    const QCommandLineOption hex_option("hex", "Write received data as hex, one line per read or frame.");
+    const QCommandLineOption framing_option("framing", "Split received data into frames, one per line, e.g. \"delimiter \\r\\n\", "
+                                            "\"nmea\", \"length 1 2 be 2 CRC-16/Modbus\", \"slip\", \"cobs CRC-32\".", "spec", "none");
+    const QCommandLineOption alnum_option("protect-alphanumeric", "Keep letters and digits as text in hex output.");
+    const QCommandLineOption extended_option("protect-extended", "Keep printable ASCII as text in hex output.");
+    const QCommandLineOption output_option({"o", "output"}, "Append received data to file, - for stdout.", "file", "-");
+    const QCommandLineOption capture_option("capture", "Capture all traffic, files are named <base>-NNNN.spcap.", "base");
+    const QCommandLineOption capture_limit_option("capture-limit", "Capture file size in MB, 1024 by default.", "mb", "1024");
+    const QCommandLineOption duration_option({"d", "duration"}, "Quit after this many seconds, runs until interrupted by default.", "seconds", "0");
+#ifdef Q_OS_UNIX
+    const QCommandLineOption replay_option("replay", "Open a pty replaying the capture instead of a port.", "file");
+    const QCommandLineOption speed_option("replay-speed", "Replay speed multiplier, 0 is as fast as possible.", "speed", "1");
+#endif
+
+    parser.addOptions({list_option, port_option, baud_option, flow_option, send_option, commands_option,
+                       interval_option, period_option, burst_option, repeat_option,
+                       ending_option, crc_option, checksum_option, dollar_option, hex_option,
+                       framing_option, alnum_option, extended_option, output_option, capture_option,
+                       capture_limit_option, duration_option});
+#ifdef Q_OS_UNIX
+    parser.addOptions({replay_option, speed_option});
+#endif
+    parser.process(a);
+
+    QTextStream err(stderr);
+
+    if(parser.isSet(list_option))
+    {
+        QTextStream out(stdout);
+        for(const QSerialPortInfo& info : QSerialPortInfo::availablePorts())
+        {
+            out << info.portName() << "\t" << info.description() << "\n";
+        }
+        return 0;
+    }
+
+    QString port = parser.value(port_option);
+
+#ifdef Q_OS_UNIX
+    std::unique_ptr<ReplayEngine> replay;
+    if(parser.isSet(replay_option))
+    {
+        replay.reset(new ReplayEngine(CaptureReader::session_files(parser.value(replay_option)),
+                                      parser.value(speed_option).toDouble()));
+        if(!replay->open())
+        {
+            err << replay->error_string() << "\n";
+            return 1;
+        }
+        port = replay->port_name();
+    }
+#endif
+
+    if(port.isEmpty())
+    {
+        err << "No port given, see --help\n";
+        return 1;
+    }
+
+    QSerialPort::FlowControl flow = QSerialPort::NoFlowControl;
+    if(parser.value(flow_option) == "hardware")
+    {
+        flow = QSerialPort::HardwareControl;
+    }
+    else if(parser.value(flow_option) == "software")
+    {
+        flow = QSerialPort::SoftwareControl;
+    }
+
+    MessageFormat format;
+    bool known = false;
+    format.set_checksum(Checksum::from_name(parser.value(checksum_option), &known));
+    if(!known)
+    {
+        err << "Unknown checksum " << parser.value(checksum_option) << "\n";
+        return 1;
+    }
+    if(parser.isSet(crc_option))
+    {
+        format.set_checksum(Checksum::TYPE::NMEA_XOR);
+    }
+    format.set_dollar(parser.isSet(dollar_option));
+    if(parser.value(ending_option) == "none")
+    {
+        format.set_line_ending(MessageFormat::LINE_ENDING::NONE);
+    }
+    else if(parser.value(ending_option) == "n")
+    {
+        format.set_line_ending(MessageFormat::LINE_ENDING::N);
+    }
+
+    QStringList commands = parser.values(send_option);
+    if(parser.isSet(commands_option))
+    {
+        QString path = parser.value(commands_option);
+        if(path == "saved")
+        {
+            QSettings settings;
+            path = settings.value("messagespath").toString();
+        }
+        QString error;
+        commands.append(load_commands(path, &error));
+        if(!error.isEmpty())
+        {
+            err << error << "\n";
+            return 1;
+        }
+    }
+
+    Framer::Settings framing;
+    QString framing_error;
+    if(!Framer::Settings::from_string(parser.value(framing_option), framing, &framing_error))
+    {
+        err << framing_error << "\n";
+        return 1;
+    }
+
+    HeadlessConsole console;
+    console.set_framing(framing);
+    console.set_hex_mode(parser.isSet(hex_option));
+    console.set_protect_alphanumeric(parser.isSet(alnum_option));
+    console.set_protect_extended(parser.isSet(extended_option));
+    console.set_format(format);
+    console.set_commands(commands, parser.value(interval_option).toInt());
+    if(parser.isSet(period_option))
+    {
+        const double period = parser.value(period_option).toDouble();
+        const int burst = parser.value(burst_option).toInt();
+        if(period <= 0 || burst <= 0)
+        {
+            err << "--period and --burst have to be positive\n";
+            return 1;
+        }
+        console.set_schedule(static_cast<std::int64_t>(period * 1000.0), burst, parser.value(repeat_option).toULongLong());
+    }
+    console.set_duration(static_cast<int>(parser.value(duration_option).toDouble() * 1000));
+
+    if(!console.set_output(parser.value(output_option)) ||
+       !console.open(port, parser.value(baud_option).toInt(), flow))
+    {
+        err << console.error_string() << "\n";
+        return 1;
+    }
+    if(parser.isSet(capture_option) &&
+       !console.start_capture(parser.value(capture_option), parser.value(capture_limit_option).toLongLong() * 1024 * 1024))
+    {
+        err << console.error_string() << "\n";
+        return 1;
+    }
+
+#ifdef Q_OS_UNIX
+    if(replay)
+    {
+        replay->start();
+    }
+#endif
+
+    // exit() is not safe inside a signal handler, poll the flag instead
+    std::signal(SIGINT, interrupt);
+    std::signal(SIGTERM, interrupt);
+    QTimer interrupt_timer;
+    QObject::connect(&interrupt_timer, &QTimer::timeout, [&console]()
+    {
+        if(interrupted)
+        {
+            console.stop();
+        }
+    });
+    interrupt_timer.start(100);
+
+    console.start();
+    const int result = a.exec();
+    if(framing.mode != Framer::MODE::NONE)
+    {
+        const Framer::Stats stats = console.framing_stats();
+        err << stats.frames << " frames, " << stats.bad_checksum << " bad checksum, "
+            << stats.malformed << " malformed, " << stats.skipped_bytes << " bytes skipped\n";
+    }
+    if(parser.isSet(period_option))
+    {
+        err << console.schedule_stats().text() << "\n";
+    }
+    if(!console.error_string().isEmpty())
+    {
+        err << console.error_string() << "\n";
+    }
+    return result;
+}